@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// --- Монте-Карло оценка площади пересечения трёх кругов (нативная версия experiment.py) ---
+
+/**
+ * @brief Круг: центр и квадрат радиуса.
+ */
+struct Circle {
+    double x;
+    double y;
+    double rSq;
+};
+
+/**
+ * @brief Прямоугольник, в котором генерируются точки.
+ */
+struct BoundingBox {
+    string name;
+    double xMin;
+    double xMax;
+    double yMin;
+    double yMax;
+
+    double area() const {
+        return (xMax - xMin) * (yMax - yMin);
+    }
+};
+
+const double S_EXACT = 0.25 * acos(-1.0) + 1.25 * asin(0.8) - 1;
+
+const vector<Circle> CIRCLES = {
+    {1.0, 1.0, 1.0},
+    {1.5, 2.0, 1.25},
+    {2.0, 1.5, 1.25}
+};
+
+const vector<BoundingBox> BOUNDING_BOXES = {
+    {"wide", 0.0, 1.5 + sqrt(5.0) / 2, 0.0, 2.0 + sqrt(5.0) / 2},
+    {"narrow", 2.0 - sqrt(5.0) / 2, 2.0, 2.0 - sqrt(5.0) / 2, 2.0}
+};
+
+// --- Счётный генератор случайных чисел ---
+//
+// Случайное число — функция ключа потока и номера: counterRandom(key, i).
+// Поэтому любой поток может сгенерировать любой участок выборки без общего
+// состояния, и результат не зависит от числа потоков. Точка с номером p
+// берёт числа 2p и 2p+1; 32-битный счётчик покрывает блок из 2^31 точек, у
+// каждого блока свой ключ.
+
+const uint64_t POINTS_PER_KEY = uint64_t(1) << 31;
+
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Финализатор MurmurHash3 — биекция 32-битных слов с полным лавинным эффектом.
+ */
+inline uint32_t mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+inline uint32_t counterRandom(uint32_t key, uint32_t counter) {
+    return mix32(counter * 0x9E3779B9u + key);
+}
+
+/**
+ * @brief Ключ блока block выборки размера n (у каждого N своя выборка, как
+ * у np.random.seed(seed) в experiment.py).
+ */
+inline uint32_t streamKey(uint64_t seed, uint64_t n, uint64_t block) {
+    return static_cast<uint32_t>(splitMix64(seed ^ splitMix64(n ^ splitMix64(block))));
+}
+
+// Случайное слово h переводится в координату как base + scale * int32(h ^ 2^31):
+// это равномерная сетка из 2^32 точек внутри [min, max), одна и та же в
+// скалярной и AVX2-версиях.
+struct AxisMap {
+    double base;
+    double scale;
+
+    AxisMap(double lo, double hi)
+        : base(lo + (hi - lo) * (2147483648.0 + 0.5) / 4294967296.0), scale((hi - lo) / 4294967296.0) {}
+};
+
+/**
+ * @brief Движок: делит выборки на куски, раздаёт их потокам и суммирует
+ * попадания из счётчиков каждого потока.
+ */
+class MonteCarloEngine {
+private:
+    // Кусок выборки, который поток обрабатывает целиком; кратен блоку ключа.
+    static const uint64_t CHUNK_POINTS = uint64_t(1) << 20;
+    // Столько областей AVX2-версия считает за один проход; при большем числе — скаляр.
+    static const size_t MAX_SIMD_BOXES = 8;
+
+    struct Chunk {
+        size_t job;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    vector<Circle> circles;
+    vector<BoundingBox> boxes;
+    vector<AxisMap> xMaps;
+    vector<AxisMap> yMaps;
+    uint64_t seed;
+    unsigned threads;
+    bool useSimd;
+
+    /**
+     * @brief Считает попадания точек [begin, end) одного ключа во все области.
+     * Точки одного номера в разных областях получаются из одних и тех же
+     * случайных чисел, как в experiment.py.
+     */
+    void countScalar(uint32_t key, uint32_t begin, uint32_t end, uint64_t* hits) const {
+        for (size_t b = 0; b < boxes.size(); ++b) {
+            uint64_t count = 0;
+            for (uint32_t i = begin; i < end; ++i) {
+                double u = static_cast<int32_t>(counterRandom(key, 2 * i) ^ 0x80000000u);
+                double v = static_cast<int32_t>(counterRandom(key, 2 * i + 1) ^ 0x80000000u);
+                double x = xMaps[b].base + xMaps[b].scale * u;
+                double y = yMaps[b].base + yMaps[b].scale * v;
+                bool inside = true;
+                for (const Circle& c : circles) {
+                    double dx = x - c.x;
+                    double dy = y - c.y;
+                    inside &= dx * dx + dy * dy <= c.rSq;
+                }
+                count += inside;
+            }
+            hits[b] += count;
+        }
+    }
+
+#if defined(__AVX2__)
+    /**
+     * @brief То же по 4 точки: восемь 32-битных слов дают x и y четырёх точек,
+     * попадания копятся в 64-битных дорожках без выхода из векторов.
+     */
+    void countAvx2(uint32_t key, uint32_t begin, uint32_t end, uint64_t* hits) const {
+        uint32_t i = begin;
+        const uint32_t vectorEnd = begin + (end - begin) / 4 * 4;
+        if (i < vectorEnd) {
+            const __m256i weyl = _mm256_set1_epi32(static_cast<int>(0x9E3779B9u));
+            const __m256i keys = _mm256_set1_epi32(static_cast<int>(key));
+            const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+            const __m256i m1 = _mm256_set1_epi32(static_cast<int>(0x85EBCA6Bu));
+            const __m256i m2 = _mm256_set1_epi32(static_cast<int>(0xC2B2AE35u));
+            // Дорожки 0..3 — счётчики x (2i, 2i+2, ...), 4..7 — счётчики y.
+            __m256i counter = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(2 * i)),
+                                               _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+            const __m256i step = _mm256_set1_epi32(8);
+
+            const size_t nb = boxes.size();
+            const size_t nc = circles.size();
+            __m256i acc[MAX_SIMD_BOXES];
+            for (size_t b = 0; b < nb; ++b) acc[b] = _mm256_setzero_si256();
+            for (; i < vectorEnd; i += 4) {
+                __m256i h = _mm256_add_epi32(_mm256_mullo_epi32(counter, weyl), keys);
+                h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+                h = _mm256_mullo_epi32(h, m1);
+                h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+                h = _mm256_mullo_epi32(h, m2);
+                h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+                h = _mm256_xor_si256(h, sign);
+                counter = _mm256_add_epi32(counter, step);
+
+                __m256d u = _mm256_cvtepi32_pd(_mm256_castsi256_si128(h));
+                __m256d v = _mm256_cvtepi32_pd(_mm256_extracti128_si256(h, 1));
+                for (size_t b = 0; b < nb; ++b) {
+                    __m256d x = _mm256_add_pd(_mm256_set1_pd(xMaps[b].base),
+                                              _mm256_mul_pd(_mm256_set1_pd(xMaps[b].scale), u));
+                    __m256d y = _mm256_add_pd(_mm256_set1_pd(yMaps[b].base),
+                                              _mm256_mul_pd(_mm256_set1_pd(yMaps[b].scale), v));
+                    __m256d inside = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+                    for (size_t c = 0; c < nc; ++c) {
+                        __m256d dx = _mm256_sub_pd(x, _mm256_set1_pd(circles[c].x));
+                        __m256d dy = _mm256_sub_pd(y, _mm256_set1_pd(circles[c].y));
+                        __m256d d = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+                        inside = _mm256_and_pd(inside, _mm256_cmp_pd(d, _mm256_set1_pd(circles[c].rSq), _CMP_LE_OQ));
+                    }
+                    // Маска попадания — это -1 в дорожке, вычитание прибавляет единицу.
+                    acc[b] = _mm256_sub_epi64(acc[b], _mm256_castpd_si256(inside));
+                }
+            }
+            for (size_t b = 0; b < nb; ++b) {
+                alignas(32) uint64_t lanes[4];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc[b]);
+                hits[b] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            }
+        }
+        countScalar(key, i, end, hits);
+    }
+#endif
+
+    void countRange(size_t n, uint64_t begin, uint64_t end, uint64_t* hits) const {
+        while (begin < end) {
+            uint64_t block = begin / POINTS_PER_KEY;
+            uint64_t blockEnd = min(end, (block + 1) * POINTS_PER_KEY);
+            uint32_t key = streamKey(seed, n, block);
+            uint32_t lo = static_cast<uint32_t>(begin - block * POINTS_PER_KEY);
+            uint32_t hi = static_cast<uint32_t>(blockEnd - block * POINTS_PER_KEY);
+#if defined(__AVX2__)
+            if (useSimd && boxes.size() <= MAX_SIMD_BOXES) {
+                countAvx2(key, lo, hi, hits);
+            } else {
+                countScalar(key, lo, hi, hits);
+            }
+#else
+            countScalar(key, lo, hi, hits);
+#endif
+            begin = blockEnd;
+        }
+    }
+
+public:
+    /**
+     * @param threadCount Число потоков; 0 — по числу ядер.
+     * @param simd Использовать AVX2, если программа собрана с ним.
+     */
+    MonteCarloEngine(const vector<Circle>& circleList, const vector<BoundingBox>& boxList,
+                     uint64_t seedValue, unsigned threadCount = 0, bool simd = true)
+        : circles(circleList), boxes(boxList), seed(seedValue),
+          threads(threadCount != 0 ? threadCount : max(1u, thread::hardware_concurrency())), useSimd(simd) {
+        for (const BoundingBox& box : boxes) {
+            xMaps.emplace_back(box.xMin, box.xMax);
+            yMaps.emplace_back(box.yMin, box.yMax);
+        }
+    }
+
+    static bool simdAvailable() {
+#if defined(__AVX2__)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    unsigned threadCount() const {
+        return threads;
+    }
+
+    /**
+     * @brief Проводит по эксперименту на каждое N из sampleSizes.
+     * @return hits[j][b] — число из sampleSizes[j] точек, попавших в
+     * пересечение кругов при генерации в области b.
+     */
+    vector<vector<uint64_t>> countHits(const vector<uint64_t>& sampleSizes) const {
+        vector<Chunk> chunks;
+        for (size_t j = 0; j < sampleSizes.size(); ++j) {
+            for (uint64_t begin = 0; begin < sampleSizes[j]; begin += CHUNK_POINTS) {
+                chunks.push_back({j, begin, min(sampleSizes[j], begin + CHUNK_POINTS)});
+            }
+        }
+
+        // Счётчики каждого потока — отдельный массив: потоки не пишут в общие
+        // строки кэша, суммирование — после join.
+        const size_t nb = boxes.size();
+        vector<vector<uint64_t>> perThread(threads, vector<uint64_t>(sampleSizes.size() * nb, 0));
+        atomic<size_t> next(0);
+        auto work = [&](unsigned t) {
+            uint64_t* hits = perThread[t].data();
+            for (size_t c = next.fetch_add(1); c < chunks.size(); c = next.fetch_add(1)) {
+                const Chunk& chunk = chunks[c];
+                countRange(sampleSizes[chunk.job], chunk.begin, chunk.end, hits + chunk.job * nb);
+            }
+        };
+        vector<thread> workers;
+        for (unsigned t = 1; t < threads; ++t) workers.emplace_back(work, t);
+        work(0);
+        for (thread& worker : workers) worker.join();
+
+        vector<vector<uint64_t>> total(sampleSizes.size(), vector<uint64_t>(nb, 0));
+        for (const vector<uint64_t>& hits : perThread) {
+            for (size_t j = 0; j < sampleSizes.size(); ++j) {
+                for (size_t b = 0; b < nb; ++b) total[j][b] += hits[j * nb + b];
+            }
+        }
+        return total;
+    }
+};
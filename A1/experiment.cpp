@@ -0,0 +1,105 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "MonteCarloEngine.h"
+
+using namespace std;
+
+// Нативная версия conduct_experiment() из experiment.py: те же N (от 100 до
+// maxN с шагом step), те же области и те же столбцы A1_raw_data.csv, так что
+// графики строятся командой python experiment.py --plot A1_raw_data.csv.
+//
+// Запуск: ./experiment [maxN] [step] [threads] [--scalar]
+// По умолчанию maxN = 100000, step = 500, потоков — по числу ядер.
+
+const uint64_t MIN_N = 100;
+const uint64_t SEED = 42;
+
+/**
+ * @brief Основная функция для проведения эксперимента.
+ */
+int runExperiment(uint64_t maxN, uint64_t step, unsigned threads, bool simd) {
+    vector<uint64_t> sampleSizes;
+    for (uint64_t n = MIN_N; n < maxN + step; n += step) sampleSizes.push_back(n);
+
+    MonteCarloEngine engine(CIRCLES, BOUNDING_BOXES, SEED, threads, simd);
+    uint64_t totalPoints = 0;
+    for (uint64_t n : sampleSizes) totalPoints += n;
+
+    cout << "Running " << sampleSizes.size() << " experiments (N = " << MIN_N << ".." << sampleSizes.back()
+         << ", " << totalPoints << " points) on " << engine.threadCount() << " threads, "
+         << (simd && MonteCarloEngine::simdAvailable() ? "AVX2" : "scalar") << "..." << endl;
+
+    auto start = chrono::steady_clock::now();
+    vector<vector<uint64_t>> hits = engine.countHits(sampleSizes);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ofstream outfile("A1_raw_data.csv");
+    if (!outfile.is_open()) {
+        cerr << "Error: Could not open A1_raw_data.csv for writing." << endl;
+        return 1;
+    }
+    outfile << "N,Box_Type,S_rec,M,S_estimate,S_exact,Relative_Error\n";
+    outfile << setprecision(17);
+    for (size_t j = 0; j < sampleSizes.size(); ++j) {
+        for (size_t b = 0; b < BOUNDING_BOXES.size(); ++b) {
+            double sRec = BOUNDING_BOXES[b].area();
+            double estimate = static_cast<double>(hits[j][b]) / sampleSizes[j] * sRec;
+            outfile << sampleSizes[j] << "," << BOUNDING_BOXES[b].name << "," << sRec << "," << hits[j][b] << ","
+                    << estimate << "," << S_EXACT << "," << abs(estimate - S_EXACT) / S_EXACT << "\n";
+        }
+    }
+    outfile.close();
+
+    // Каждая точка проверяется в обеих областях
+    double pointsPerSecond = totalPoints * BOUNDING_BOXES.size() / seconds;
+    cout << "Sampling took " << fixed << setprecision(3) << seconds << " s ("
+         << setprecision(1) << pointsPerSecond / 1e6 << " M points/s)" << endl;
+    for (size_t b = 0; b < BOUNDING_BOXES.size(); ++b) {
+        double estimate = static_cast<double>(hits.back()[b]) / sampleSizes.back() * BOUNDING_BOXES[b].area();
+        cout << "  " << BOUNDING_BOXES[b].name << ": S_estimate = " << setprecision(8) << estimate
+             << ", relative error = " << setprecision(4) << abs(estimate - S_EXACT) / S_EXACT * 100 << "%" << endl;
+    }
+    cout << "Experiment finished. Results saved to A1_raw_data.csv" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Ускорение ввода/вывода
+    ios_base::sync_with_stdio(false);
+    cin.tie(NULL);
+
+    uint64_t maxN = 100000;
+    uint64_t step = 500;
+    unsigned threads = 0;
+    bool simd = true;
+    vector<uint64_t> numbers;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--scalar") == 0) {
+            simd = false;
+            continue;
+        }
+        char* end = nullptr;
+        unsigned long long value = strtoull(argv[i], &end, 10);
+        if (end == argv[i] || *end != '\0') {
+            cerr << "Usage: " << argv[0] << " [maxN] [step] [threads] [--scalar]" << endl;
+            return 1;
+        }
+        numbers.push_back(value);
+    }
+    if (numbers.size() > 0) maxN = numbers[0];
+    if (numbers.size() > 1) step = numbers[1];
+    if (numbers.size() > 2) threads = static_cast<unsigned>(numbers[2]);
+    if (numbers.size() > 3 || step == 0 || maxN < MIN_N) {
+        cerr << "Usage: " << argv[0] << " [maxN >= " << MIN_N << "] [step > 0] [threads] [--scalar]" << endl;
+        return 1;
+    }
+
+    return runExperiment(maxN, step, threads, simd);
+}
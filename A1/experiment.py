@@ -3,6 +3,7 @@ import pandas as pd
 import matplotlib.pyplot as plt
 import os
 import math
+import sys
 from tqdm import tqdm
 
 S_EXACT = 0.25 * math.pi + 1.25 * math.asin(0.8) - 1
@@ -111,6 +112,12 @@ def plot_results(df):
     plt.close()
 
 if __name__ == "__main__":
+    # python experiment.py --plot A1_raw_data.csv — только графики по готовым
+    # данным (например, от нативной версии experiment.cpp)
+    if len(sys.argv) == 3 and sys.argv[1] == '--plot':
+        plot_results(pd.read_csv(sys.argv[2]))
+        print("графики построены, картинки сохранены")
+        sys.exit(0)
     df_results = conduct_experiment()
     data_file_path = 'A1_raw_data.csv'
     df_results.to_csv(data_file_path, index=False)
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// --- Телеметрия сортировок слиянием ---
+//
+// Включается флагом компиляции SORT_TELEMETRY. Без него таймеры и счётчики
+// глубины — пустые объекты, и сортировки компилируются ровно как раньше.
+// Каждый поток пишет в свой слот размером в строку кэша; снимок суммирует
+// слоты всех потоков (для максимумов берётся максимум).
+
+#ifdef SORT_TELEMETRY
+constexpr bool SORT_TELEMETRY_ENABLED = true;
+#else
+constexpr bool SORT_TELEMETRY_ENABLED = false;
+#endif
+
+/**
+ * @brief Счётчики телеметрии сортировок.
+ */
+enum SortCounter {
+    LEAF_NS,            // время в сортировке вставками (листья рекурсии), нс
+    LEAF_CALLS,         // число вызовов сортировки вставками
+    MERGE_NS,           // время в слияниях, нс
+    MERGE_CALLS,        // число слияний
+    MAX_DEPTH,          // наибольшая глубина рекурсии
+    SCRATCH_BYTES,      // всего выделено под временные массивы слияний, байт
+    MAX_SCRATCH_BYTES,  // наибольший временный буфер одного слияния, байт
+    SORT_COUNTER_COUNT
+};
+
+/**
+ * @brief Счётчики одного потока, выровненные по строке кэша.
+ */
+struct alignas(64) SortTelemetrySlot {
+    array<atomic<uint64_t>, SORT_COUNTER_COUNT> values{};
+
+    /**
+     * @brief Прибавляет n к счётчику. Пишет только поток-владелец, поэтому
+     * достаточно relaxed load + store без lock-префикса.
+     */
+    void add(SortCounter counter, uint64_t n) {
+        atomic<uint64_t>& value = values[counter];
+        value.store(value.load(memory_order_relaxed) + n, memory_order_relaxed);
+    }
+
+    /**
+     * @brief Поднимает счётчик-максимум до n.
+     */
+    void raise(SortCounter counter, uint64_t n) {
+        atomic<uint64_t>& value = values[counter];
+        if (n > value.load(memory_order_relaxed)) value.store(n, memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Снимок телеметрии: значения счётчиков по всем потокам на момент taken.
+ */
+struct SortTelemetrySnapshot {
+    chrono::steady_clock::time_point taken;
+    array<uint64_t, SORT_COUNTER_COUNT> values{};
+
+    uint64_t operator[](SortCounter counter) const {
+        return values[counter];
+    }
+
+    /**
+     * @brief Доля времени листьев в суммарном времени листьев и слияний.
+     */
+    double leafShare() const {
+        uint64_t total = values[LEAF_NS] + values[MERGE_NS];
+        return total == 0 ? 0.0 : static_cast<double>(values[LEAF_NS]) / total;
+    }
+};
+
+/**
+ * @brief Реестр слотов всех потоков. Слот завершившегося потока вместе с
+ * накопленными значениями переходит к следующему новому потоку.
+ */
+class SortTelemetryRegistry {
+private:
+    mutex lock;
+    vector<unique_ptr<SortTelemetrySlot>> slots;
+    vector<SortTelemetrySlot*> freeSlots;
+
+public:
+    static SortTelemetryRegistry& instance() {
+        static SortTelemetryRegistry registry;
+        return registry;
+    }
+
+    SortTelemetrySlot* acquire() {
+        lock_guard<mutex> guard(lock);
+        if (!freeSlots.empty()) {
+            SortTelemetrySlot* slot = freeSlots.back();
+            freeSlots.pop_back();
+            return slot;
+        }
+        slots.push_back(make_unique<SortTelemetrySlot>());
+        return slots.back().get();
+    }
+
+    void release(SortTelemetrySlot* slot) {
+        lock_guard<mutex> guard(lock);
+        freeSlots.push_back(slot);
+    }
+
+    SortTelemetrySnapshot snapshot() {
+        SortTelemetrySnapshot result;
+        lock_guard<mutex> guard(lock);
+        result.taken = chrono::steady_clock::now();
+        for (const auto& slot : slots) {
+            for (int k = 0; k < SORT_COUNTER_COUNT; ++k) {
+                uint64_t value = slot->values[k].load(memory_order_relaxed);
+                if (k == MAX_DEPTH || k == MAX_SCRATCH_BYTES) {
+                    result.values[k] = max(result.values[k], value);
+                } else {
+                    result.values[k] += value;
+                }
+            }
+        }
+        return result;
+    }
+};
+
+// Слот текущего потока: тривиальный указатель читается без проверки
+// инициализации, объект-владелец создаётся один раз в sortTelemetryAttach().
+inline thread_local SortTelemetrySlot* sortTelemetrySlotPtr = nullptr;
+inline thread_local int sortTelemetryDepth = 0;
+
+class SortTelemetryThread {
+private:
+    SortTelemetrySlot* slot;
+
+public:
+    SortTelemetryThread() : slot(SortTelemetryRegistry::instance().acquire()) {}
+    ~SortTelemetryThread() {
+        sortTelemetrySlotPtr = nullptr;
+        SortTelemetryRegistry::instance().release(slot);
+    }
+    SortTelemetryThread(const SortTelemetryThread&) = delete;
+    SortTelemetryThread& operator=(const SortTelemetryThread&) = delete;
+
+    SortTelemetrySlot* get() {
+        return slot;
+    }
+};
+
+inline SortTelemetrySlot* sortTelemetryAttach() {
+    thread_local SortTelemetryThread owner;
+    sortTelemetrySlotPtr = owner.get();
+    return sortTelemetrySlotPtr;
+}
+
+inline SortTelemetrySlot& sortTelemetrySlot() {
+    SortTelemetrySlot* slot = sortTelemetrySlotPtr;
+    if (slot == nullptr) [[unlikely]] slot = sortTelemetryAttach();
+    return *slot;
+}
+
+/**
+ * @brief Учитывает временный буфер слияния размером bytes.
+ */
+inline void sortTelemetryScratch(uint64_t bytes) {
+    if constexpr (SORT_TELEMETRY_ENABLED) {
+        SortTelemetrySlot& slot = sortTelemetrySlot();
+        slot.add(SCRATCH_BYTES, bytes);
+        slot.raise(MAX_SCRATCH_BYTES, bytes);
+    }
+}
+
+/**
+ * @brief Замеряет время своей области видимости и прибавляет его к счётчику
+ * timeCounter, а единицу — к callsCounter.
+ */
+class SortTelemetryTimer {
+private:
+    SortCounter timeCounter;
+    SortCounter callsCounter;
+    chrono::steady_clock::time_point start;
+
+public:
+    SortTelemetryTimer(SortCounter time, SortCounter calls) : timeCounter(time), callsCounter(calls) {
+        if constexpr (SORT_TELEMETRY_ENABLED) start = chrono::steady_clock::now();
+    }
+
+    ~SortTelemetryTimer() {
+        if constexpr (SORT_TELEMETRY_ENABLED) {
+            auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+            SortTelemetrySlot& slot = sortTelemetrySlot();
+            slot.add(timeCounter, elapsed.count());
+            slot.add(callsCounter, 1);
+        }
+    }
+
+    SortTelemetryTimer(const SortTelemetryTimer&) = delete;
+    SortTelemetryTimer& operator=(const SortTelemetryTimer&) = delete;
+};
+
+/**
+ * @brief Отмечает один уровень рекурсии на время своей области видимости.
+ */
+class SortDepthGuard {
+public:
+    SortDepthGuard() {
+        if constexpr (SORT_TELEMETRY_ENABLED) sortTelemetrySlot().raise(MAX_DEPTH, ++sortTelemetryDepth);
+    }
+
+    ~SortDepthGuard() {
+        if constexpr (SORT_TELEMETRY_ENABLED) --sortTelemetryDepth;
+    }
+
+    SortDepthGuard(const SortDepthGuard&) = delete;
+    SortDepthGuard& operator=(const SortDepthGuard&) = delete;
+};
+
+/**
+ * @brief Снимок телеметрии по всем потокам. Без SORT_TELEMETRY — нули.
+ */
+inline SortTelemetrySnapshot sortTelemetrySnapshot() {
+    if constexpr (SORT_TELEMETRY_ENABLED) return SortTelemetryRegistry::instance().snapshot();
+    return SortTelemetrySnapshot{chrono::steady_clock::now(), {}};
+}
+
+/**
+ * @brief Печатает одну строку отчёта: итоги с начала работы и число слияний
+ * в секунду за интервал от previous до current.
+ */
+inline void sortTelemetryPrint(ostream& out, const SortTelemetrySnapshot& previous,
+                               const SortTelemetrySnapshot& current) {
+    double seconds = chrono::duration<double>(current.taken - previous.taken).count();
+    double mergeRate = seconds > 0 ? (current[MERGE_CALLS] - previous[MERGE_CALLS]) / seconds : 0.0;
+    out << "sort leaf_calls=" << current[LEAF_CALLS]
+        << " leaf_ms=" << fixed << setprecision(1) << current[LEAF_NS] / 1e6
+        << " merge_calls=" << current[MERGE_CALLS]
+        << " merge_ms=" << current[MERGE_NS] / 1e6
+        << " leaf_share=" << setprecision(2) << current.leafShare() * 100 << "%"
+        << " max_depth=" << current[MAX_DEPTH]
+        << " scratch_mb=" << setprecision(1) << current[SCRATCH_BYTES] / 1048576.0
+        << " max_scratch_kb=" << current[MAX_SCRATCH_BYTES] / 1024.0
+        << " merges/s=" << setprecision(0) << mergeRate << "\n";
+}
+
+/**
+ * @brief Фоновый поток, раз в period печатающий строку sortTelemetryPrint в out
+ * (и последнюю — при остановке). Без SORT_TELEMETRY поток не запускается.
+ */
+class SortTelemetryReporter {
+private:
+    ostream& out;
+    chrono::milliseconds period;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+    thread worker;
+
+    void run() {
+        SortTelemetrySnapshot previous = sortTelemetrySnapshot();
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            bool last = wake.wait_for(guard, period, [this] { return stopping; });
+            SortTelemetrySnapshot current = sortTelemetrySnapshot();
+            sortTelemetryPrint(out, previous, current);
+            out.flush();
+            previous = current;
+            if (last) return;
+        }
+    }
+
+public:
+    SortTelemetryReporter(ostream& stream, chrono::milliseconds every) : out(stream), period(every) {
+        if constexpr (SORT_TELEMETRY_ENABLED) worker = thread([this] { run(); });
+    }
+
+    ~SortTelemetryReporter() {
+        stop();
+    }
+
+    void stop() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+};
@@ -7,6 +7,7 @@
 #include <cmath>
 #include <numeric>
 #include "ArrayGenerator.h"
+#include "SortTelemetry.h"
 
 using namespace std;
 
@@ -16,6 +17,7 @@ using namespace std;
  * @brief Сортировка вставками (Insertion Sort) для подмассива.
  */
 void insertionSort(vector<long long>& arr, int l, int r) {
+    SortTelemetryTimer timer(LEAF_NS, LEAF_CALLS);
     for (int i = l + 1; i <= r; i++) {
         long long key = arr[i];
         int j = i - 1;
@@ -31,12 +33,14 @@ void insertionSort(vector<long long>& arr, int l, int r) {
  * @brief Слияние двух отсортированных подмассивов.
  */
 void merge(vector<long long>& arr, int l, int m, int r) {
+    SortTelemetryTimer timer(MERGE_NS, MERGE_CALLS);
     int n1 = m - l + 1;
     int n2 = r - m;
 
     // Создание временных массивов
     vector<long long> L(n1);
     vector<long long> R(n2);
+    sortTelemetryScratch((n1 + n2) * sizeof(long long));
 
     // Копирование данных во временные массивы L[] и R[]
     for (int i = 0; i < n1; i++)
@@ -77,6 +81,7 @@ void merge(vector<long long>& arr, int l, int m, int r) {
  * @brief Стандартный алгоритм MERGE SORT.
  */
 void standardMergeSort(vector<long long>& arr, int l, int r) {
+    SortDepthGuard depth;
     if (l < r) {
         int m = l + (r - l) / 2;
         standardMergeSort(arr, l, m);
@@ -89,6 +94,7 @@ void standardMergeSort(vector<long long>& arr, int l, int r) {
  * @brief Гибридный алгоритм MERGE+INSERTION SORT.
  */
 void hybridMergeInsertionSort(vector<long long>& arr, int l, int r, int K) {
+    SortDepthGuard depth;
     if (l < r) {
         if (r - l + 1 <= K) {
             insertionSort(arr, l, r);
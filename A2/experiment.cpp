@@ -5,6 +5,7 @@
 #include <map>
 #include "ArrayGenerator.h"
 #include "SortTester.h"
+#include "SortTelemetry.h"
 
 using namespace std;
 
@@ -56,6 +57,12 @@ void runExperiment() {
     // Заголовок CSV файла
     outfile << "Size,ArrayType,Algorithm,K,Time_us\n";
 
+    // При сборке с -DSORT_TELEMETRY раз в секунду пишем строку телеметрии в лог
+#ifdef SORT_TELEMETRY
+    ofstream telemetryLog("sort_telemetry.log");
+    SortTelemetryReporter reporter(telemetryLog, chrono::seconds(1));
+#endif
+
     // Итерация по типам массивов
     for (const auto& pair : TYPE_NAMES) {
         ArrayGenerator::ArrayType type = pair.first;
@@ -76,6 +83,12 @@ void runExperiment() {
 
     outfile.close();
     cout << "Experiment finished. Results saved to experiment_results.csv" << endl;
+
+    if (SORT_TELEMETRY_ENABLED) {
+        SortTelemetrySnapshot total = sortTelemetrySnapshot();
+        cout << "Telemetry: ";
+        sortTelemetryPrint(cout, total, total);
+    }
 }
 
 int main() {
@@ -0,0 +1,590 @@
+#ifndef HLL_BIAS_TABLES_H
+#define HLL_BIAS_TABLES_H
+
+#include <cstdint>
+#include <span>
+
+// Сгенерировано main_bias_calibration.cpp, вручную не править.
+
+struct HllBiasPoint {
+    double raw_estimate;
+    double bias;
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B4[] = {
+    {11.24, 10.24}, {11.72, 9.72}, {12.22, 9.22},
+    {12.74, 8.74}, {13.27, 8.27}, {13.82, 7.82},
+    {14.38, 7.38}, {14.96, 6.96}, {15.56, 6.56},
+    {16.17, 6.17}, {16.79, 5.79}, {17.44, 5.44},
+    {18.09, 5.09}, {18.77, 4.77}, {19.45, 4.45},
+    {20.16, 4.16}, {20.87, 3.87}, {21.60, 3.60},
+    {22.35, 3.35}, {23.11, 3.11}, {23.88, 2.88},
+    {24.67, 2.67}, {25.47, 2.47}, {26.28, 2.28},
+    {26.28, 2.28}, {27.10, 2.10}, {27.93, 1.93},
+    {28.77, 1.77}, {29.63, 1.63}, {30.49, 1.49},
+    {31.37, 1.37}, {32.25, 1.25}, {33.14, 1.14},
+    {34.04, 1.04}, {34.95, 0.95}, {35.86, 0.86},
+    {36.78, 0.78}, {37.71, 0.71}, {38.64, 0.64},
+    {39.58, 0.58}, {40.53, 0.53}, {41.47, 0.47},
+    {42.43, 0.43}, {43.38, 0.38}, {44.34, 0.34},
+    {45.30, 0.30}, {46.27, 0.27}, {47.24, 0.24},
+    {48.22, 0.22}, {48.22, 0.22}, {49.19, 0.19},
+    {50.17, 0.17}, {51.15, 0.15}, {52.14, 0.14},
+    {53.12, 0.12}, {54.11, 0.11}, {55.09, 0.09},
+    {56.08, 0.08}, {57.07, 0.07}, {58.06, 0.06},
+    {59.05, 0.05}, {60.05, 0.05}, {61.04, 0.04},
+    {62.03, 0.03}, {63.03, 0.03}, {64.02, 0.02},
+    {65.01, 0.01}, {66.02, 0.02}, {67.01, 0.01},
+    {68.00, 0.00}, {69.00, 0.00}, {70.00, 0.00},
+    {71.00, -0.00}, {72.00, -0.00}, {72.00, -0.00},
+    {72.99, -0.01}, {73.99, -0.01}, {74.98, -0.02},
+    {75.98, -0.02}, {76.99, -0.01}, {77.98, -0.02},
+    {78.98, -0.02}, {79.98, -0.02}, {80.98, -0.02},
+    {81.97, -0.03}, {82.97, -0.03}, {83.97, -0.03},
+    {84.96, -0.04}, {85.96, -0.04}, {86.97, -0.03},
+    {87.96, -0.04}, {88.96, -0.04}, {89.96, -0.04},
+    {90.96, -0.04}, {91.96, -0.04}, {92.96, -0.04},
+    {93.95, -0.05}, {94.95, -0.05}, {95.95, -0.05},
+    {95.95, -0.05},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B5[] = {
+    {23.26, 21.26}, {24.25, 20.25}, {25.27, 19.27},
+    {26.31, 18.31}, {27.39, 17.39}, {28.50, 16.50},
+    {29.64, 15.64}, {30.81, 14.81}, {32.00, 14.00},
+    {33.23, 13.23}, {34.49, 12.49}, {35.77, 11.77},
+    {36.43, 11.43}, {37.76, 10.76}, {39.11, 10.11},
+    {40.50, 9.50}, {41.92, 8.92}, {43.36, 8.36},
+    {44.82, 7.82}, {46.32, 7.32}, {47.83, 6.83},
+    {49.37, 6.37}, {50.94, 5.94}, {52.53, 5.53},
+    {53.33, 5.33}, {54.96, 4.96}, {56.60, 4.60},
+    {58.26, 4.26}, {59.95, 3.95}, {61.65, 3.65},
+    {63.37, 3.37}, {65.11, 3.11}, {66.87, 2.87},
+    {68.65, 2.65}, {70.44, 2.44}, {72.25, 2.25},
+    {74.07, 2.07}, {74.98, 1.98}, {76.82, 1.82},
+    {78.67, 1.67}, {80.53, 1.53}, {82.40, 1.40},
+    {84.28, 1.28}, {86.16, 1.16}, {88.06, 1.06},
+    {89.95, 0.95}, {91.87, 0.87}, {93.79, 0.79},
+    {95.71, 0.71}, {96.67, 0.67}, {98.60, 0.60},
+    {100.55, 0.55}, {102.48, 0.48}, {104.44, 0.44},
+    {106.40, 0.40}, {108.37, 0.37}, {110.33, 0.33},
+    {112.31, 0.31}, {114.28, 0.28}, {116.26, 0.26},
+    {118.24, 0.24}, {120.22, 0.22}, {121.20, 0.20},
+    {123.19, 0.19}, {125.17, 0.17}, {127.15, 0.15},
+    {129.14, 0.14}, {131.13, 0.13}, {133.13, 0.13},
+    {135.12, 0.12}, {137.11, 0.11}, {139.11, 0.11},
+    {141.11, 0.11}, {143.10, 0.10}, {144.11, 0.11},
+    {146.10, 0.10}, {148.10, 0.10}, {150.09, 0.09},
+    {152.09, 0.09}, {154.09, 0.09}, {156.09, 0.09},
+    {158.09, 0.09}, {160.07, 0.07}, {162.07, 0.07},
+    {164.06, 0.06}, {166.06, 0.06}, {168.05, 0.05},
+    {169.05, 0.05}, {171.05, 0.05}, {173.05, 0.05},
+    {175.05, 0.05}, {177.06, 0.06}, {179.07, 0.07},
+    {181.07, 0.07}, {183.08, 0.08}, {185.07, 0.07},
+    {187.07, 0.07}, {189.06, 0.06}, {191.06, 0.06},
+    {192.07, 0.07},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B6[] = {
+    {47.31, 43.31}, {49.30, 41.30}, {51.35, 39.35},
+    {53.46, 37.46}, {55.63, 35.63}, {57.86, 33.86},
+    {59.57, 32.57}, {61.90, 30.90}, {64.29, 29.29},
+    {66.73, 27.73}, {69.24, 26.24}, {71.79, 24.79},
+    {73.75, 23.75}, {76.42, 22.42}, {79.13, 21.13},
+    {81.90, 19.90}, {84.72, 18.72}, {87.59, 17.59},
+    {89.78, 16.78}, {92.74, 15.74}, {95.76, 14.76},
+    {98.81, 13.81}, {101.92, 12.92}, {105.07, 12.07},
+    {107.47, 11.47}, {110.70, 10.70}, {113.98, 9.98},
+    {117.30, 9.30}, {120.65, 8.65}, {124.05, 8.05},
+    {127.47, 7.47}, {130.06, 7.06}, {133.55, 6.55},
+    {137.07, 6.07}, {140.61, 5.61}, {144.17, 5.17},
+    {147.77, 4.77}, {150.49, 4.49}, {154.13, 4.13},
+    {157.81, 3.81}, {161.50, 3.50}, {165.20, 3.20},
+    {168.94, 2.94}, {171.74, 2.74}, {175.50, 2.50},
+    {179.29, 2.29}, {183.10, 2.10}, {186.92, 1.92},
+    {190.76, 1.76}, {193.64, 1.64}, {197.50, 1.50},
+    {201.37, 1.37}, {205.26, 1.26}, {209.14, 1.14},
+    {213.04, 1.04}, {216.93, 0.93}, {219.87, 0.87},
+    {223.78, 0.78}, {227.71, 0.71}, {231.63, 0.63},
+    {235.55, 0.55}, {239.48, 0.48}, {242.45, 0.45},
+    {246.42, 0.42}, {250.36, 0.36}, {254.32, 0.32},
+    {258.29, 0.29}, {262.29, 0.29}, {265.26, 0.26},
+    {269.23, 0.23}, {273.18, 0.18}, {277.17, 0.17},
+    {281.14, 0.14}, {285.13, 0.13}, {288.14, 0.14},
+    {292.10, 0.10}, {296.07, 0.07}, {300.07, 0.07},
+    {304.06, 0.06}, {308.03, 0.03}, {312.04, 0.04},
+    {315.02, 0.02}, {318.99, -0.01}, {322.97, -0.03},
+    {326.97, -0.03}, {330.97, -0.03}, {334.97, -0.03},
+    {337.97, -0.03}, {341.96, -0.04}, {345.96, -0.04},
+    {349.96, -0.04}, {353.94, -0.06}, {357.94, -0.06},
+    {360.96, -0.04}, {364.96, -0.04}, {368.99, -0.01},
+    {373.01, 0.01}, {376.98, -0.02}, {380.99, -0.01},
+    {383.98, -0.02},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B7[] = {
+    {95.44, 87.44}, {99.45, 83.45}, {103.56, 79.56},
+    {107.26, 76.26}, {111.61, 72.61}, {116.06, 69.06},
+    {120.05, 66.05}, {124.73, 62.73}, {129.51, 59.51},
+    {133.79, 56.79}, {138.79, 53.79}, {143.91, 50.91},
+    {148.47, 48.47}, {153.79, 45.79}, {159.22, 43.22},
+    {164.06, 41.06}, {169.69, 38.69}, {175.43, 36.43},
+    {180.53, 34.53}, {186.45, 32.45}, {192.47, 30.47},
+    {197.81, 28.81}, {204.00, 27.00}, {210.29, 25.29},
+    {215.85, 23.85}, {222.29, 22.29}, {228.82, 20.82},
+    {235.44, 19.44}, {241.29, 18.29}, {248.02, 17.02},
+    {254.85, 15.85}, {260.87, 14.87}, {267.83, 13.83},
+    {274.86, 12.86}, {281.06, 12.06}, {288.19, 11.19},
+    {295.38, 10.38}, {301.72, 9.72}, {308.98, 8.98},
+    {316.30, 8.30}, {322.73, 7.73}, {330.13, 7.13},
+    {337.57, 6.57}, {344.14, 6.14}, {351.65, 5.65},
+    {359.19, 5.19}, {365.81, 4.81}, {373.39, 4.39},
+    {381.03, 4.03}, {387.73, 3.73}, {395.41, 3.41},
+    {403.12, 3.12}, {410.90, 2.90}, {417.69, 2.69},
+    {425.45, 2.45}, {433.27, 2.27}, {440.09, 2.09},
+    {447.93, 1.93}, {455.77, 1.77}, {462.66, 1.66},
+    {470.53, 1.53}, {478.38, 1.38}, {485.30, 1.30},
+    {493.17, 1.17}, {501.06, 1.06}, {507.99, 0.99},
+    {515.90, 0.90}, {523.83, 0.83}, {530.77, 0.77},
+    {538.71, 0.71}, {546.67, 0.67}, {553.66, 0.66},
+    {561.58, 0.58}, {569.50, 0.50}, {576.46, 0.46},
+    {584.38, 0.38}, {592.36, 0.36}, {600.35, 0.35},
+    {607.34, 0.34}, {615.31, 0.31}, {623.25, 0.25},
+    {630.25, 0.25}, {638.19, 0.19}, {646.15, 0.15},
+    {653.16, 0.16}, {661.16, 0.16}, {669.12, 0.12},
+    {676.13, 0.13}, {684.14, 0.14}, {692.13, 0.13},
+    {699.06, 0.06}, {707.00, -0.00}, {715.01, 0.01},
+    {722.02, 0.02}, {730.02, 0.02}, {737.97, -0.03},
+    {744.96, -0.04}, {752.92, -0.08}, {760.94, -0.06},
+    {767.88, -0.12},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B8[] = {
+    {191.67, 175.67}, {199.18, 168.18}, {207.43, 160.43},
+    {215.36, 153.36}, {223.50, 146.50}, {232.40, 139.40},
+    {240.95, 132.95}, {249.71, 126.71}, {259.27, 120.27},
+    {268.46, 114.46}, {277.84, 108.84}, {288.06, 103.06},
+    {297.85, 97.85}, {308.50, 92.50}, {318.68, 87.68},
+    {329.04, 83.04}, {340.30, 78.30}, {351.02, 74.02},
+    {361.97, 69.97}, {373.80, 65.80}, {385.08, 62.08},
+    {396.52, 58.52}, {408.89, 54.89}, {420.64, 51.64},
+    {432.56, 48.56}, {445.43, 45.43}, {457.65, 42.65},
+    {470.85, 39.85}, {483.35, 37.35}, {495.95, 34.95},
+    {509.58, 32.58}, {522.43, 30.43}, {535.42, 28.42},
+    {549.44, 26.44}, {562.64, 24.64}, {575.98, 22.98},
+    {590.31, 21.31}, {603.82, 19.82}, {618.32, 18.32},
+    {631.99, 16.99}, {645.76, 15.76}, {660.53, 14.53},
+    {674.47, 13.47}, {688.46, 12.46}, {703.53, 11.53},
+    {717.65, 10.65}, {731.85, 9.85}, {747.05, 9.05},
+    {761.34, 8.34}, {775.63, 7.63}, {790.98, 6.98},
+    {805.44, 6.44}, {820.88, 5.88}, {835.41, 5.41},
+    {849.98, 4.98}, {865.57, 4.57}, {880.18, 4.18},
+    {894.84, 3.84}, {910.56, 3.56}, {925.24, 3.24},
+    {939.95, 2.95}, {955.69, 2.69}, {970.43, 2.43},
+    {986.27, 2.27}, {1001.06, 2.06}, {1015.81, 1.81},
+    {1031.60, 1.60}, {1046.48, 1.48}, {1061.35, 1.35},
+    {1077.22, 1.22}, {1092.12, 1.12}, {1106.99, 0.99},
+    {1122.83, 0.83}, {1137.71, 0.71}, {1152.66, 0.66},
+    {1168.57, 0.57}, {1183.52, 0.52}, {1199.46, 0.46},
+    {1214.31, 0.31}, {1229.28, 0.28}, {1245.22, 0.22},
+    {1260.18, 0.18}, {1275.24, 0.24}, {1291.25, 0.25},
+    {1306.23, 0.23}, {1321.26, 0.26}, {1337.25, 0.25},
+    {1352.20, 0.20}, {1368.12, 0.12}, {1383.04, 0.04},
+    {1397.97, -0.03}, {1413.92, -0.08}, {1428.95, -0.05},
+    {1443.90, -0.10}, {1459.89, -0.11}, {1474.87, -0.13},
+    {1489.83, -0.17}, {1505.86, -0.14}, {1520.92, -0.08},
+    {1535.98, -0.02},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B9[] = {
+    {383.64, 352.64}, {399.17, 337.17}, {415.13, 322.13},
+    {431.00, 308.00}, {447.84, 293.84}, {465.12, 280.12},
+    {482.81, 266.81}, {500.32, 254.32}, {518.88, 241.88},
+    {537.84, 229.84}, {556.60, 218.60}, {576.41, 207.41},
+    {596.62, 196.62}, {617.26, 186.26}, {637.57, 176.57},
+    {658.99, 166.99}, {680.76, 157.76}, {702.23, 149.23},
+    {724.76, 140.76}, {747.68, 132.68}, {770.99, 124.99},
+    {793.90, 117.90}, {817.84, 110.84}, {842.09, 104.09},
+    {865.89, 97.89}, {890.82, 91.82}, {916.03, 86.03},
+    {941.62, 80.62}, {966.61, 75.61}, {992.63, 70.63},
+    {1019.02, 66.02}, {1045.65, 61.65}, {1071.60, 57.60},
+    {1098.69, 53.69}, {1125.94, 49.94}, {1152.52, 46.52},
+    {1180.08, 43.08}, {1208.08, 40.08}, {1236.08, 37.08},
+    {1263.40, 34.40}, {1291.79, 31.79}, {1320.37, 29.37},
+    {1348.21, 27.21}, {1377.13, 25.13}, {1406.16, 23.16},
+    {1435.31, 21.31}, {1463.79, 19.79}, {1493.19, 18.19},
+    {1522.69, 16.69}, {1551.29, 15.29}, {1581.01, 14.01},
+    {1610.74, 12.74}, {1640.74, 11.74}, {1669.73, 10.73},
+    {1699.74, 9.74}, {1729.80, 8.80}, {1759.88, 7.88},
+    {1789.20, 7.20}, {1819.53, 6.53}, {1850.03, 6.03},
+    {1879.44, 5.44}, {1909.91, 4.91}, {1940.36, 4.36},
+    {1970.86, 3.86}, {2000.51, 3.51}, {2031.01, 3.01},
+    {2061.60, 2.60}, {2091.51, 2.51}, {2122.14, 2.14},
+    {2152.75, 1.75}, {2183.50, 1.50}, {2213.27, 1.27},
+    {2244.04, 1.04}, {2274.93, 0.93}, {2304.78, 0.78},
+    {2335.64, 0.64}, {2366.63, 0.63}, {2397.56, 0.56},
+    {2427.50, 0.50}, {2458.38, 0.38}, {2489.16, 0.16},
+    {2520.01, 0.01}, {2549.94, -0.06}, {2580.80, -0.20},
+    {2611.78, -0.22}, {2641.80, -0.20}, {2672.72, -0.28},
+    {2703.58, -0.42}, {2734.45, -0.55}, {2764.43, -0.57},
+    {2795.37, -0.63}, {2826.27, -0.73}, {2856.22, -0.78},
+    {2887.00, -1.00}, {2918.04, -0.96}, {2949.02, -0.98},
+    {2978.99, -1.01}, {3010.08, -0.92}, {3041.20, -0.80},
+    {3070.94, -1.06},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B10[] = {
+    {768.06, 706.06}, {798.64, 675.64}, {830.58, 645.58},
+    {862.84, 616.84}, {896.51, 588.51}, {930.49, 561.49},
+    {965.87, 534.87}, {1001.52, 509.52}, {1037.95, 484.95},
+    {1075.88, 460.88}, {1114.02, 438.02}, {1153.59, 415.59},
+    {1193.38, 394.38}, {1234.61, 373.61}, {1275.87, 353.87},
+    {1318.69, 334.69}, {1361.51, 316.51}, {1405.07, 299.07},
+    {1450.14, 282.14}, {1495.26, 266.26}, {1541.75, 250.75},
+    {1588.17, 236.17}, {1635.89, 221.89}, {1683.77, 208.77},
+    {1732.25, 196.25}, {1782.18, 184.18}, {1831.80, 172.80},
+    {1882.87, 161.87}, {1933.47, 151.47}, {1985.75, 141.75},
+    {2037.59, 132.59}, {2090.87, 123.87}, {2143.64, 115.64},
+    {2196.92, 107.92}, {2251.31, 100.31}, {2305.49, 93.49},
+    {2360.96, 86.96}, {2416.01, 81.01}, {2472.21, 75.21},
+    {2527.82, 69.82}, {2584.81, 64.81}, {2641.20, 60.20},
+    {2697.77, 55.77}, {2755.61, 51.61}, {2812.71, 47.71},
+    {2871.21, 44.21}, {2928.75, 40.75}, {2987.71, 37.71},
+    {3045.93, 34.93}, {3104.11, 32.11}, {3163.55, 29.55},
+    {3222.19, 27.19}, {3281.79, 24.79}, {3340.70, 22.70},
+    {3400.84, 20.84}, {3460.05, 19.05}, {3520.70, 17.70},
+    {3580.12, 16.12}, {3640.04, 15.04}, {3700.91, 13.91},
+    {3760.91, 12.91}, {3821.90, 11.90}, {3881.93, 10.93},
+    {3942.86, 9.86}, {4003.01, 9.01}, {4064.06, 8.06},
+    {4124.57, 7.57}, {4184.80, 6.80}, {4245.94, 5.94},
+    {4306.51, 5.51}, {4367.97, 4.97}, {4428.52, 4.52},
+    {4490.60, 4.60}, {4551.34, 4.34}, {4611.77, 3.77},
+    {4673.36, 3.36}, {4734.05, 3.05}, {4796.07, 3.07},
+    {4857.15, 3.15}, {4919.04, 3.04}, {4979.75, 2.75},
+    {5041.61, 2.61}, {5102.17, 2.17}, {5163.20, 2.20},
+    {5225.17, 2.17}, {5286.46, 2.46}, {5348.37, 2.37},
+    {5409.15, 2.15}, {5471.14, 2.14}, {5532.25, 2.25},
+    {5594.08, 2.08}, {5655.04, 2.04}, {5715.91, 1.91},
+    {5778.05, 2.05}, {5839.24, 2.24}, {5901.15, 2.15},
+    {5962.14, 2.14}, {6024.58, 2.58}, {6085.50, 2.50},
+    {6146.79, 2.79},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B11[] = {
+    {1536.42, 1413.42}, {1598.07, 1352.07}, {1661.49, 1292.49},
+    {1726.58, 1234.58}, {1793.39, 1178.39}, {1861.93, 1123.93},
+    {1932.12, 1071.12}, {2004.00, 1020.00}, {2076.91, 970.91},
+    {2152.08, 923.08}, {2229.11, 877.11}, {2307.68, 832.68},
+    {2387.88, 789.88}, {2469.77, 748.77}, {2553.17, 709.17},
+    {2638.00, 671.00}, {2723.81, 634.81}, {2811.88, 599.88},
+    {2901.35, 566.35}, {2992.21, 534.21}, {3084.29, 503.29},
+    {3177.95, 473.95}, {3273.09, 446.09}, {3369.43, 419.43},
+    {3466.27, 394.27}, {3565.05, 370.05}, {3665.02, 347.02},
+    {3766.08, 325.08}, {3868.11, 304.11}, {3971.27, 284.27},
+    {4075.48, 265.48}, {4180.96, 247.96}, {4287.04, 231.04},
+    {4393.62, 215.62}, {4501.90, 200.90}, {4611.12, 187.12},
+    {4721.23, 174.23}, {4831.95, 161.95}, {4943.81, 150.81},
+    {5056.12, 140.12}, {5169.05, 130.05}, {5282.02, 121.02},
+    {5396.77, 112.77}, {5511.21, 104.21}, {5626.26, 96.26},
+    {5742.15, 89.15}, {5858.40, 82.40}, {5975.31, 76.31},
+    {6092.45, 70.45}, {6209.12, 65.12}, {6327.08, 60.08},
+    {6445.24, 55.24}, {6564.30, 51.30}, {6683.32, 47.32},
+    {6802.02, 43.02}, {6921.73, 39.73}, {7041.63, 36.63},
+    {7161.70, 33.70}, {7280.52, 30.52}, {7400.12, 27.12},
+    {7521.31, 25.31}, {7642.22, 23.22}, {7762.57, 20.57},
+    {7883.58, 18.58}, {8005.09, 17.09}, {8126.95, 15.95},
+    {8247.34, 14.34}, {8369.49, 13.49}, {8491.84, 12.84},
+    {8613.88, 11.88}, {8735.73, 10.73}, {8857.96, 9.96},
+    {8979.81, 8.81}, {9102.08, 8.08}, {9223.70, 7.70},
+    {9346.26, 7.26}, {9469.35, 7.35}, {9592.04, 7.04},
+    {9714.11, 6.11}, {9836.76, 5.76}, {9958.87, 4.87},
+    {10081.44, 4.44}, {10204.59, 4.59}, {10326.20, 4.20},
+    {10448.30, 3.30}, {10570.35, 2.35}, {10693.37, 2.37},
+    {10816.19, 2.19}, {10939.05, 2.05}, {11061.87, 1.87},
+    {11184.73, 1.73}, {11305.61, 0.61}, {11428.02, 0.02},
+    {11551.14, 0.14}, {11673.54, -0.46}, {11796.78, -0.22},
+    {11919.44, -0.56}, {12042.53, -0.47}, {12165.38, -0.62},
+    {12287.28, -0.72},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B12[] = {
+    {3073.64, 2827.64}, {3197.03, 2705.03}, {3323.82, 2585.82},
+    {3454.11, 2470.11}, {3587.26, 2358.26}, {3724.19, 2249.19},
+    {3864.61, 2143.61}, {4008.46, 2041.46}, {4154.96, 1942.96},
+    {4305.53, 1847.53}, {4459.44, 1755.44}, {4616.43, 1666.43},
+    {4776.21, 1581.21}, {4939.57, 1498.57}, {5106.47, 1419.47},
+    {5276.42, 1343.42}, {5448.87, 1270.87}, {5624.43, 1200.43},
+    {5803.41, 1133.41}, {5985.03, 1069.03}, {6168.55, 1007.55},
+    {6355.48, 948.48}, {6545.16, 892.16}, {6737.82, 838.82},
+    {6931.94, 787.94}, {7129.75, 739.75}, {7329.92, 693.92},
+    {7532.39, 650.39}, {7736.85, 608.85}, {7942.55, 569.55},
+    {8151.03, 532.03}, {8361.66, 496.66}, {8575.18, 464.18},
+    {8789.42, 433.42}, {9005.77, 403.77}, {9223.85, 375.85},
+    {9443.50, 349.50}, {9664.14, 325.14}, {9886.24, 301.24},
+    {10110.82, 279.82}, {10336.14, 259.14}, {10561.63, 239.63},
+    {10790.32, 222.32}, {11020.92, 206.92}, {11251.36, 191.36},
+    {11481.48, 176.48}, {11713.70, 162.70}, {11946.49, 149.49},
+    {12180.73, 137.73}, {12414.55, 126.55}, {12650.10, 116.10},
+    {12886.55, 106.55}, {13124.02, 98.02}, {13360.98, 88.98},
+    {13598.23, 81.23}, {13835.74, 72.74}, {14075.10, 66.10},
+    {14314.87, 59.87}, {14554.93, 54.93}, {14795.83, 49.83},
+    {15037.57, 45.57}, {15278.55, 40.55}, {15519.53, 36.53},
+    {15761.81, 32.81}, {16003.50, 28.50}, {16246.76, 25.76},
+    {16488.75, 22.75}, {16732.11, 20.11}, {16976.45, 18.45},
+    {17220.13, 16.13}, {17464.89, 15.89}, {17710.93, 15.93},
+    {17955.48, 14.48}, {18198.61, 11.61}, {18441.99, 9.99},
+    {18685.80, 7.80}, {18931.80, 7.80}, {19176.59, 6.59},
+    {19421.60, 5.60}, {19666.59, 5.59}, {19912.35, 5.35},
+    {20158.55, 5.55}, {20404.15, 5.15}, {20649.02, 5.02},
+    {20894.79, 4.79}, {21140.60, 4.60}, {21386.35, 4.35},
+    {21632.25, 5.25}, {21878.09, 5.09}, {22123.95, 4.95},
+    {22370.38, 5.38}, {22615.45, 5.45}, {22862.15, 6.15},
+    {23106.70, 4.70}, {23352.82, 4.82}, {23597.35, 4.35},
+    {23842.84, 3.84}, {24088.66, 3.66}, {24334.23, 3.23},
+    {24579.58, 3.58},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B13[] = {
+    {6148.05, 5656.05}, {6394.70, 5410.70}, {6647.87, 5172.87},
+    {6908.26, 4941.26}, {7175.36, 4717.36}, {7449.16, 4499.16},
+    {7729.08, 4288.08}, {8016.71, 4083.71}, {8310.65, 3886.65},
+    {8611.78, 3695.78}, {8918.93, 3511.93}, {9233.35, 3334.35},
+    {9552.71, 3162.71}, {9879.46, 2997.46}, {10212.50, 2839.50},
+    {10552.19, 2687.19}, {10898.28, 2542.28}, {11250.88, 2402.88},
+    {11607.95, 2268.95}, {11971.27, 2140.27}, {12340.10, 2018.10},
+    {12714.91, 1900.91}, {13094.19, 1789.19}, {13479.42, 1682.42},
+    {13869.24, 1581.24}, {14264.71, 1484.71}, {14664.81, 1392.81},
+    {15068.64, 1305.64}, {15478.91, 1223.91}, {15892.34, 1146.34},
+    {16310.71, 1072.71}, {16730.84, 1001.84}, {17156.49, 935.49},
+    {17584.40, 872.40}, {18017.93, 813.93}, {18454.01, 759.01},
+    {18893.94, 706.94}, {19334.95, 656.95}, {19780.57, 610.57},
+    {20228.65, 567.65}, {20679.97, 526.97}, {21132.34, 488.34},
+    {21588.90, 452.90}, {22047.48, 420.48}, {22508.86, 389.86},
+    {22969.86, 359.86}, {23436.23, 334.23}, {23903.19, 310.19},
+    {24371.71, 286.71}, {24838.84, 262.84}, {25311.17, 243.17},
+    {25783.22, 223.22}, {26258.89, 207.89}, {26735.29, 192.29},
+    {27211.73, 177.73}, {27690.00, 164.00}, {28169.35, 152.35},
+    {28650.03, 141.03}, {29131.19, 131.19}, {29612.07, 120.07},
+    {30094.99, 111.99}, {30578.03, 103.03}, {31060.63, 94.63},
+    {31546.71, 88.71}, {32031.33, 82.33}, {32518.71, 77.71},
+    {33004.82, 72.82}, {33492.65, 68.65}, {33978.49, 63.49},
+    {34467.10, 60.10}, {34955.15, 57.15}, {35443.30, 53.30},
+    {35929.72, 48.72}, {36420.05, 47.05}, {36904.35, 40.35},
+    {37391.92, 35.92}, {37880.20, 32.20}, {38371.12, 32.12},
+    {38860.83, 29.83}, {39350.57, 28.57}, {39839.03, 25.03},
+    {40329.23, 24.23}, {40819.56, 22.56}, {41312.86, 24.86},
+    {41805.64, 25.64}, {42295.40, 24.40}, {42791.60, 28.60},
+    {43283.76, 29.76}, {43775.45, 29.45}, {44263.63, 26.63},
+    {44753.66, 24.66}, {45243.65, 23.65}, {45738.55, 26.55},
+    {46229.86, 26.86}, {46720.17, 25.17}, {47207.82, 21.82},
+    {47697.37, 19.37}, {48187.66, 18.66}, {48679.20, 18.20},
+    {49167.97, 15.97},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B14[] = {
+    {12296.85, 11312.85}, {12789.78, 10822.78}, {13296.11, 10346.11},
+    {13816.25, 9883.25}, {14349.86, 9433.86}, {14896.81, 8997.81},
+    {15458.19, 8576.19}, {16032.79, 8167.79}, {16620.84, 7772.84},
+    {17222.42, 7391.42}, {17837.22, 7023.22}, {18465.18, 6668.18},
+    {19105.00, 6325.00}, {19757.55, 5994.55}, {20423.35, 5677.35},
+    {21102.75, 5373.75}, {21793.27, 5081.27}, {22495.22, 4800.22},
+    {23209.88, 4531.88}, {23933.88, 4272.88}, {24671.29, 4027.29},
+    {25419.66, 3792.66}, {26177.95, 3567.95}, {26947.42, 3354.42},
+    {27725.75, 3149.75}, {28517.80, 2957.80}, {29316.95, 2773.95},
+    {30123.68, 2597.68}, {30940.60, 2431.60}, {31766.95, 2274.95},
+    {32601.42, 2126.42}, {33445.74, 1987.74}, {34296.54, 1855.54},
+    {35154.76, 1730.76}, {36020.16, 1613.16}, {36893.52, 1503.52},
+    {37767.67, 1394.67}, {38651.95, 1295.95}, {39541.99, 1202.99},
+    {40437.99, 1115.99}, {41339.66, 1034.66}, {42246.43, 958.43},
+    {43159.27, 888.27}, {44078.33, 824.33}, {44999.16, 762.16},
+    {45924.91, 704.91}, {46851.27, 648.27}, {47784.41, 598.41},
+    {48721.47, 552.47}, {49659.24, 507.24}, {50604.71, 468.71},
+    {51550.14, 431.14}, {52496.03, 394.03}, {53447.97, 362.97},
+    {54399.93, 331.93}, {55356.80, 305.80}, {56314.58, 280.58},
+    {57275.46, 258.46}, {58233.28, 233.28}, {59196.90, 213.90},
+    {60160.01, 194.01}, {61129.42, 180.42}, {62095.94, 163.94},
+    {63067.72, 152.72}, {64042.70, 144.70}, {65010.21, 129.21},
+    {65979.29, 115.29}, {66952.87, 105.87}, {67928.11, 98.11},
+    {68902.49, 89.49}, {69878.65, 82.65}, {70854.87, 75.87},
+    {71829.71, 67.71}, {72806.87, 61.87}, {73783.33, 55.33},
+    {74760.90, 48.90}, {75737.75, 42.75}, {76719.91, 41.91},
+    {77702.47, 41.47}, {78684.05, 40.05}, {79662.39, 35.39},
+    {80643.84, 33.84}, {81624.45, 31.45}, {82604.76, 28.76},
+    {83588.81, 29.81}, {84571.90, 29.90}, {85555.84, 30.84},
+    {86536.86, 28.86}, {87520.47, 29.47}, {88501.72, 27.72},
+    {89485.66, 28.66}, {90468.18, 28.18}, {91447.67, 24.67},
+    {92429.75, 23.75}, {93402.02, 13.02}, {94389.00, 17.00},
+    {95362.37, 7.37}, {96346.77, 8.77}, {97326.38, 5.38},
+    {98307.00, 3.00},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B15[] = {
+    {24594.03, 22627.03}, {25580.51, 21647.51}, {26592.99, 20693.99},
+    {27633.40, 19768.40}, {28701.74, 18870.74}, {29797.14, 18000.14},
+    {30921.11, 17158.11}, {32069.72, 16340.72}, {33246.91, 15551.91},
+    {34449.31, 14788.31}, {35677.81, 14050.81}, {36931.16, 13338.16},
+    {38212.57, 12652.57}, {39520.25, 11994.25}, {40854.93, 11362.93},
+    {42212.45, 10754.45}, {43595.24, 10171.24}, {45000.27, 9610.27},
+    {46432.07, 9076.07}, {47884.36, 8562.36}, {49361.37, 8073.37},
+    {50858.82, 7604.82}, {52376.31, 7156.31}, {53915.43, 6729.43},
+    {55476.05, 6324.05}, {57055.73, 5936.73}, {58652.97, 5567.97},
+    {60268.27, 5217.27}, {61904.41, 4887.41}, {63561.21, 4578.21},
+    {65230.40, 4281.40}, {66914.35, 3999.35}, {68619.88, 3738.88},
+    {70332.85, 3485.85}, {72061.76, 3248.76}, {73806.98, 3027.98},
+    {75569.38, 2824.38}, {77337.83, 2625.83}, {79113.35, 2435.35},
+    {80902.88, 2258.88}, {82711.73, 2101.73}, {84518.44, 1942.44},
+    {86345.67, 1803.67}, {88180.20, 1672.20}, {90019.59, 1545.59},
+    {91872.50, 1432.50}, {93731.13, 1325.13}, {95592.77, 1220.77},
+    {97470.12, 1132.12}, {99354.88, 1050.88}, {101244.44, 973.44},
+    {103130.57, 893.57}, {105019.43, 816.43}, {106924.24, 755.24},
+    {108837.61, 702.61}, {110747.52, 646.52}, {112660.39, 593.39},
+    {114576.79, 543.79}, {116502.76, 503.76}, {118420.08, 455.08},
+    {120346.97, 415.97}, {122281.86, 384.86}, {124217.03, 353.03},
+    {126147.43, 317.43}, {128084.82, 288.82}, {130027.39, 265.39},
+    {131965.09, 237.09}, {133910.35, 216.35}, {135850.85, 190.85},
+    {137800.00, 174.00}, {139735.84, 143.84}, {141689.47, 131.47},
+    {143646.26, 122.26}, {145596.22, 106.22}, {147540.80, 84.80},
+    {149493.23, 70.23}, {151449.25, 60.25}, {153411.49, 56.49},
+    {155361.42, 40.42}, {157314.00, 27.00}, {159268.90, 15.90},
+    {161231.19, 12.19}, {163199.75, 14.75}, {165161.99, 10.99},
+    {167119.82, 2.82}, {169081.58, -1.42}, {171035.47, -13.53},
+    {173000.09, -15.91}, {174972.46, -9.54}, {176929.80, -18.20},
+    {178888.72, -25.28}, {180850.34, -29.66}, {182818.05, -27.95},
+    {184788.90, -23.10}, {186749.91, -28.09}, {188709.58, -34.42},
+    {190688.45, -21.55}, {192643.81, -32.19}, {194608.27, -33.73},
+    {196575.21, -32.79},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B16[] = {
+    {49188.03, 45255.03}, {51159.14, 43294.14}, {53185.39, 41388.39},
+    {55265.01, 39536.01}, {57401.10, 37740.10}, {59589.06, 35996.06},
+    {61831.09, 34305.09}, {64128.75, 32670.75}, {66480.09, 31090.09},
+    {68880.90, 29558.90}, {71338.64, 28084.64}, {73848.37, 26662.37},
+    {76407.25, 25288.25}, {79016.43, 23965.43}, {81681.87, 22698.87},
+    {84394.67, 21479.67}, {87159.46, 20312.46}, {89968.32, 19189.32},
+    {92830.85, 18118.85}, {95732.52, 17088.52}, {98681.10, 16105.10},
+    {101680.10, 15172.10}, {104718.34, 14278.34}, {107796.55, 13424.55},
+    {110911.38, 12607.38}, {114068.38, 11831.38}, {117256.42, 11087.42},
+    {120487.76, 10386.76}, {123755.88, 9722.88}, {127071.65, 9106.65},
+    {130416.26, 8519.26}, {133786.57, 7956.57}, {137188.41, 7426.41},
+    {140616.16, 6922.16}, {144081.50, 6455.50}, {147563.79, 6005.79},
+    {151080.66, 5590.66}, {154625.71, 5202.71}, {158186.26, 4831.26},
+    {161764.31, 4477.31}, {165364.76, 4145.76}, {169000.04, 3849.04},
+    {172633.52, 3550.52}, {176302.65, 3286.65}, {179983.90, 3035.90},
+    {183684.52, 2804.52}, {187383.66, 2571.66}, {191111.90, 2367.90},
+    {194860.44, 2184.44}, {198606.71, 1998.71}, {202374.21, 1833.21},
+    {206151.99, 1678.99}, {209939.13, 1534.13}, {213749.32, 1412.32},
+    {217546.79, 1277.79}, {221358.88, 1157.88}, {225190.43, 1056.43},
+    {229026.74, 960.74}, {232872.01, 874.01}, {236729.73, 799.73},
+    {240598.51, 736.51}, {244451.10, 657.10}, {248306.45, 579.45},
+    {252192.40, 533.40}, {256083.76, 492.76}, {259956.87, 433.87},
+    {263840.15, 385.15}, {267725.54, 338.54}, {271638.03, 318.03},
+    {275527.31, 275.31}, {279424.22, 240.22}, {283316.82, 200.82},
+    {287224.32, 176.32}, {291127.69, 147.69}, {295070.61, 158.61},
+    {298989.37, 144.37}, {302892.39, 115.39}, {306786.52, 77.52},
+    {310683.99, 42.99}, {314594.83, 21.83}, {318521.08, 16.08},
+    {322418.21, -19.79}, {326321.28, -48.72}, {330255.65, -46.35},
+    {334173.48, -60.52}, {338088.05, -77.95}, {342019.11, -78.89},
+    {345942.60, -88.40}, {349876.40, -86.60}, {353797.03, -97.97},
+    {357714.97, -112.03}, {361628.89, -130.11}, {365537.06, -153.94},
+    {369473.22, -150.78}, {373408.46, -147.54}, {377319.07, -168.93},
+    {381246.20, -173.80}, {385165.97, -186.03}, {389093.89, -190.11},
+    {393022.17, -193.83},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B17[] = {
+    {98376.86, 90511.86}, {102317.91, 86588.91}, {106371.97, 82778.97},
+    {110534.96, 79076.96}, {114802.05, 75480.05}, {119180.15, 71994.15},
+    {123662.33, 68611.33}, {128261.23, 65346.23}, {132970.30, 62191.30},
+    {137773.00, 59129.00}, {142692.68, 56184.68}, {147715.87, 53343.87},
+    {152841.76, 50604.76}, {158069.51, 47968.51}, {163387.68, 45422.68},
+    {168811.96, 42981.96}, {174330.74, 40636.74}, {179951.28, 38393.28},
+    {185673.40, 36250.40}, {191472.13, 34185.13}, {197373.65, 32222.65},
+    {203375.60, 30359.60}, {209437.40, 28557.40}, {215595.62, 26851.62},
+    {221810.75, 25202.75}, {228119.38, 23646.38}, {234503.95, 22166.95},
+    {240965.28, 20764.28}, {247510.56, 19444.56}, {254137.39, 18207.39},
+    {260797.19, 17003.19}, {267535.33, 15876.33}, {274344.70, 14821.70},
+    {281215.69, 13828.69}, {288148.56, 12896.56}, {295128.42, 12012.42},
+    {302168.93, 11188.93}, {309251.33, 10406.33}, {316376.23, 9667.23},
+    {323533.30, 8960.30}, {330765.44, 8327.44}, {338015.04, 7713.04},
+    {345317.44, 7151.44}, {352673.87, 6642.87}, {360055.26, 6160.26},
+    {367419.11, 5660.11}, {374812.34, 5188.34}, {382282.98, 4794.98},
+    {389767.89, 4415.89}, {397297.94, 4081.94}, {404861.52, 3780.52},
+    {412463.75, 3518.75}, {420033.13, 3224.13}, {427642.14, 2968.14},
+    {435260.16, 2722.16}, {442934.70, 2532.70}, {450591.38, 2324.38},
+    {458264.39, 2133.39}, {465964.92, 1969.92}, {473693.33, 1833.33},
+    {481418.37, 1694.37}, {489112.85, 1524.85}, {496828.84, 1375.84},
+    {504552.06, 1235.06}, {512310.41, 1129.41}, {520094.27, 1048.27},
+    {527849.99, 939.99}, {535580.64, 806.64}, {543356.58, 717.58},
+    {551118.69, 615.69}, {558931.30, 564.30}, {566758.59, 526.59},
+    {574593.76, 497.76}, {582387.42, 427.42}, {590180.53, 356.53},
+    {598057.76, 368.76}, {605876.49, 323.49}, {613688.04, 271.04},
+    {621576.28, 294.28}, {629444.52, 298.52}, {637345.43, 335.43},
+    {645205.07, 330.07}, {653046.36, 307.36}, {660900.00, 297.00},
+    {668747.00, 279.00}, {676615.18, 283.18}, {684419.44, 223.44},
+    {692279.29, 218.29}, {700110.68, 185.68}, {707952.04, 163.04},
+    {715744.76, 90.76}, {723586.24, 68.24}, {731440.21, 58.21},
+    {739317.32, 70.32}, {747139.92, 28.92}, {755013.39, 38.39},
+    {762860.98, 20.98}, {770696.84, -7.16}, {778522.05, -45.95},
+    {786391.78, -40.22},
+};
+
+inline constexpr HllBiasPoint HLL_BIAS_B18[] = {
+    {196756.82, 181027.82}, {204645.68, 173187.68}, {212754.35, 165568.35},
+    {221075.65, 158160.65}, {229617.12, 150973.12}, {238380.26, 144008.26},
+    {247352.74, 137251.74}, {256539.67, 130709.67}, {265938.85, 124380.85},
+    {275557.07, 118270.07}, {285376.60, 112360.60}, {295406.83, 106662.83},
+    {305660.74, 101187.74}, {316111.61, 95910.61}, {326784.83, 90854.83},
+    {337639.88, 85980.88}, {348703.50, 81316.50}, {359952.49, 76836.49},
+    {371371.31, 72526.31}, {382999.17, 68426.17}, {394808.68, 64506.68},
+    {406752.79, 60721.79}, {418865.55, 57106.55}, {431188.74, 53700.74},
+    {443657.83, 50441.83}, {456302.43, 47357.43}, {469075.54, 44401.54},
+    {481992.09, 41590.09}, {495042.50, 38911.50}, {508273.40, 36413.40},
+    {521636.70, 34048.70}, {535146.40, 31829.40}, {548764.97, 29718.97},
+    {562460.06, 27686.06}, {576278.24, 25775.24}, {590207.40, 23975.40},
+    {604263.43, 22303.43}, {618389.19, 20700.19}, {632662.22, 19245.22},
+    {646998.95, 17852.95}, {661434.21, 16559.21}, {675928.19, 15325.19},
+    {690490.25, 14158.25}, {705123.04, 13062.04}, {719866.14, 12077.14},
+    {734696.47, 11178.47}, {749561.08, 10314.08}, {764449.87, 9474.87},
+    {779380.68, 8676.68}, {794436.01, 8004.01}, {809534.36, 7373.36},
+    {824655.46, 6765.46}, {839838.33, 6220.33}, {855008.11, 5661.11},
+    {870291.50, 5215.50}, {885535.54, 4731.54}, {900847.09, 4314.09},
+    {916205.03, 3943.03}, {931570.96, 3580.96}, {946929.32, 3210.32},
+    {962328.67, 2880.67}, {977768.99, 2592.99}, {993331.25, 2426.25},
+    {1008817.00, 2184.00}, {1024312.92, 1950.92}, {1039915.63, 1824.63},
+    {1055504.93, 1685.93}, {1071082.86, 1534.86}, {1086752.60, 1475.60},
+    {1102268.64, 1263.64}, {1117996.97, 1262.97}, {1133666.50, 1203.50},
+    {1149310.54, 1119.54}, {1164930.48, 1010.48}, {1180517.66, 869.66},
+    {1196179.47, 802.47}, {1211852.19, 746.19}, {1227482.25, 648.25},
+    {1243012.25, 449.25}, {1258697.64, 405.64}, {1274410.80, 390.80},
+    {1290054.16, 305.16}, {1305758.66, 280.66}, {1321425.87, 219.87},
+    {1337141.08, 206.08}, {1352752.27, 88.27}, {1368389.13, -2.87},
+    {1384094.11, -26.89}, {1399809.80, -39.20}, {1415529.92, -48.08},
+    {1431184.26, -122.74}, {1446832.99, -202.01}, {1462454.33, -309.67},
+    {1478290.27, -202.73}, {1493913.16, -307.84}, {1509571.68, -378.32},
+    {1525336.93, -342.07}, {1541013.03, -393.97}, {1556749.66, -386.34},
+    {1572565.77, -298.23},
+};
+
+inline std::span<const HllBiasPoint> hllBiasTable(uint32_t b) {
+    switch (b) {
+        case 4: return HLL_BIAS_B4;
+        case 5: return HLL_BIAS_B5;
+        case 6: return HLL_BIAS_B6;
+        case 7: return HLL_BIAS_B7;
+        case 8: return HLL_BIAS_B8;
+        case 9: return HLL_BIAS_B9;
+        case 10: return HLL_BIAS_B10;
+        case 11: return HLL_BIAS_B11;
+        case 12: return HLL_BIAS_B12;
+        case 13: return HLL_BIAS_B13;
+        case 14: return HLL_BIAS_B14;
+        case 15: return HLL_BIAS_B15;
+        case 16: return HLL_BIAS_B16;
+        case 17: return HLL_BIAS_B17;
+        case 18: return HLL_BIAS_B18;
+        default: return {};
+    }
+}
+
+#endif
@@ -0,0 +1,463 @@
+#ifndef HLL_CHECKPOINT_H
+#define HLL_CHECKPOINT_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+#include "hash_function.h"
+#include "hll_format.h"
+#include "hll_packing.h"
+
+// Контрольные точки скетча для репликации. В отличие от записи hll_format.h,
+// которая читается прямо из файла, здесь регистры сжаты энтропийным кодером:
+// значения регистров сильно скошены (почти все лежат в нескольких соседних
+// значениях), и rANS со статической таблицей частот тратит на регистр около
+// 3 бит вместо 8 (или 6 у HyperLogLogCompact).
+//
+// Полная точка кодирует сами значения. Дельта кодирует разности с base —
+// прежним снимком того же скетча: регистры только растут, разности
+// неотрицательны и почти все нулевые, так что дельта после нескольких
+// изменений занимает десятки байт. В заголовке дельты лежит отпечаток
+// регистров base; применить её можно только к скетчу с теми же регистрами.
+// Если сжатие не выигрывает (маленький b, base не предшествует скетчу),
+// пишется полная точка с регистрами как есть.
+//
+// Формат: 24-байтный заголовок, затем для rANS — маска встречающихся значений
+// (uint64), их частоты (uint16, в сумме HLL_RANS_SCALE) и поток rANS; для
+// Raw — регистры в том же виде, что и в записи hll_format.h.
+constexpr uint32_t HLL_CHECKPOINT_MAGIC = 0x434C4C48;  // "HLLC"
+constexpr uint16_t HLL_CHECKPOINT_VERSION = 1;
+constexpr uint32_t HLL_RANS_SYMBOLS = 64;
+constexpr uint32_t HLL_RANS_SCALE_BITS = 12;
+constexpr uint32_t HLL_RANS_SCALE = 1u << HLL_RANS_SCALE_BITS;
+constexpr uint32_t HLL_RANS_LOW = 1u << 15;
+constexpr uint32_t HLL_RANS_LANES = 4;
+constexpr uint32_t HLL_CHECKPOINT_BLOCK = 256;
+
+enum class HllCheckpointType : uint8_t {
+    Full = 1,
+    Delta = 2
+};
+
+enum class HllCheckpointCoding : uint8_t {
+    Raw = 1,
+    Rans = 2
+};
+
+struct HllCheckpointHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t kind;
+    uint8_t b;
+    uint8_t type;
+    uint8_t coding;
+    uint16_t reserved;
+    uint32_t payload_bytes;
+    uint64_t base_digest;
+};
+
+static_assert(sizeof(HllCheckpointHeader) == 24, "HllCheckpointHeader must stay 24 bytes");
+
+// Отпечаток регистров в виде записи: четыре независимые полосы по 8 байт,
+// чтобы умножения splitmix64 шли параллельно.
+inline uint64_t hllRegisterDigest(const uint8_t* data, size_t bytes) {
+    uint64_t lanes[4] = {1, 2, 3, 4};
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        for (size_t k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, data + i + 8 * k, sizeof(word));
+            lanes[k] = splitmix64(lanes[k] ^ word);
+        }
+    }
+    for (size_t k = 0; i < bytes; i += 8, ++k) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, std::min<size_t>(8, bytes - i));
+        lanes[k] = splitmix64(lanes[k] ^ word);
+    }
+    return splitmix64(lanes[0] ^ splitmix64(lanes[1] ^ splitmix64(lanes[2] ^ splitmix64(lanes[3] ^ bytes))));
+}
+
+// Частоты, приведённые к сумме HLL_RANS_SCALE; каждое встретившееся значение
+// получает не меньше 1. Расхождение после округления снимается с самой
+// частой ячейки (или добавляется к ней).
+inline std::array<uint32_t, HLL_RANS_SYMBOLS> hllRansNormalize(const std::array<uint32_t, HLL_RANS_SYMBOLS>& counts,
+                                                               uint32_t total) {
+    std::array<uint32_t, HLL_RANS_SYMBOLS> freq{};
+    uint32_t sum = 0;
+    for (uint32_t s = 0; s < HLL_RANS_SYMBOLS; ++s) {
+        if (counts[s] == 0) continue;
+        uint64_t scaled = (static_cast<uint64_t>(counts[s]) * HLL_RANS_SCALE + total / 2) / total;
+        freq[s] = std::max<uint32_t>(1, static_cast<uint32_t>(scaled));
+        sum += freq[s];
+    }
+    while (sum != HLL_RANS_SCALE) {
+        uint32_t top = 0;
+        for (uint32_t s = 1; s < HLL_RANS_SYMBOLS; ++s) {
+            if (freq[s] > freq[top]) top = s;
+        }
+        if (sum > HLL_RANS_SCALE) {
+            uint32_t cut = std::min(sum - HLL_RANS_SCALE, freq[top] - 1);
+            freq[top] -= cut;
+            sum -= cut;
+        } else {
+            freq[top] += HLL_RANS_SCALE - sum;
+            sum = HLL_RANS_SCALE;
+        }
+    }
+    return freq;
+}
+
+// rANS с 16-битным вводом-выводом и HLL_RANS_LANES чередующимися
+// состояниями (символ i — в состоянии i mod HLL_RANS_LANES). Декодер упирается
+// не в ветвления, а в цепочку «таблица — умножение — подкачка» каждого
+// состояния; четыре независимые цепочки идут параллельно, а 16-битная
+// подкачка нужна не чаще раза на символ. Состояние лежит в [2^15, 2^31), так
+// что деление кодера заменяется умножением на заранее посчитанное обратное,
+// как в rans_byte.h Ф. Гизена.
+class HllRansEncoder {
+private:
+    struct Symbol {
+        uint32_t x_max;
+        uint32_t rcp_freq;
+        uint32_t bias;
+        uint32_t cmpl_freq;
+        uint32_t rcp_shift;
+    };
+
+    std::array<Symbol, HLL_RANS_SYMBOLS> symbols{};
+
+public:
+    explicit HllRansEncoder(const std::array<uint32_t, HLL_RANS_SYMBOLS>& freq) {
+        uint32_t start = 0;
+        for (uint32_t s = 0; s < HLL_RANS_SYMBOLS; ++s) {
+            Symbol& sym = symbols[s];
+            uint32_t f = freq[s];
+            if (f == 0) continue;
+            sym.x_max = ((HLL_RANS_LOW >> HLL_RANS_SCALE_BITS) << 16) * f;
+            sym.cmpl_freq = HLL_RANS_SCALE - f;
+            if (f < 2) {
+                sym.rcp_freq = ~0u;
+                sym.rcp_shift = 0;
+                sym.bias = start + HLL_RANS_SCALE - 1;
+            } else {
+                uint32_t shift = 0;
+                while (f > (1u << shift)) ++shift;
+                sym.rcp_freq = static_cast<uint32_t>(((1ull << (shift + 31)) + f - 1) / f);
+                sym.rcp_shift = shift - 1;
+                sym.bias = start;
+            }
+            start += f;
+        }
+    }
+
+    // Поток для декодера, читающего его с начала: символы кодируются с конца,
+    // слова выталкиваются в обратном порядке и в конце разворачиваются.
+    // count кратно HLL_RANS_LANES.
+    std::vector<uint8_t> encode(const uint8_t* data, uint32_t count) const {
+        std::vector<uint16_t> words;
+        words.reserve(count / 4 + 2 * HLL_RANS_LANES);
+        uint32_t state[HLL_RANS_LANES];
+        std::fill(state, state + HLL_RANS_LANES, HLL_RANS_LOW);
+        for (uint32_t i = count; i-- > 0;) {
+            uint32_t& x = state[i % HLL_RANS_LANES];
+            const Symbol& sym = symbols[data[i]];
+            if (x >= sym.x_max) {
+                words.push_back(static_cast<uint16_t>(x));
+                x >>= 16;
+            }
+            uint32_t q = static_cast<uint32_t>((static_cast<uint64_t>(x) * sym.rcp_freq) >> 32) >> sym.rcp_shift;
+            x = x + sym.bias + q * sym.cmpl_freq;
+        }
+        for (uint32_t k = HLL_RANS_LANES; k-- > 0;) {
+            words.push_back(static_cast<uint16_t>(state[k] >> 16));
+            words.push_back(static_cast<uint16_t>(state[k]));
+        }
+        std::reverse(words.begin(), words.end());
+        std::vector<uint8_t> out(words.size() * sizeof(uint16_t));
+        std::memcpy(out.data(), words.data(), out.size());
+        return out;
+    }
+};
+
+// Таблица декодера: на каждый из HLL_RANS_SCALE слотов одно слово —
+// значение (6 бит), частота (13 бит) и смещение слота от начала значения.
+class HllRansDecoder {
+private:
+    std::array<uint32_t, HLL_RANS_SCALE> slots;
+    uint32_t x[HLL_RANS_LANES] = {};
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+
+    template <bool CHECKED>
+    static bool step(const uint32_t* table, uint32_t& state, const uint8_t*& q, const uint8_t* stop,
+                     uint8_t& symbol) {
+        uint32_t e = table[state & (HLL_RANS_SCALE - 1)];
+        symbol = static_cast<uint8_t>(e >> 25);
+        state = ((e >> 12) & 0x1FFF) * (state >> HLL_RANS_SCALE_BITS) + (e & 0xFFF);
+        if (state < HLL_RANS_LOW) {
+            if (CHECKED && stop - q < 2) return false;
+            uint16_t word;
+            std::memcpy(&word, q, sizeof(word));
+            state = (state << 16) | word;
+            q += sizeof(word);
+        }
+        return true;
+    }
+
+public:
+    // Разбирает таблицу частот и начальные состояния; false для
+    // повреждённых данных.
+    bool init(std::span<const uint8_t> payload) {
+        if (payload.size() < sizeof(uint64_t)) return false;
+        uint64_t present;
+        std::memcpy(&present, payload.data(), sizeof(present));
+        const uint8_t* q = payload.data() + sizeof(present);
+        const uint8_t* stop = payload.data() + payload.size();
+        uint32_t start = 0;
+        for (uint32_t s = 0; s < HLL_RANS_SYMBOLS; ++s) {
+            if (!(present >> s & 1)) continue;
+            if (stop - q < 2) return false;
+            uint16_t f;
+            std::memcpy(&f, q, sizeof(f));
+            q += sizeof(f);
+            if (f == 0 || start + f > HLL_RANS_SCALE) return false;
+            for (uint32_t slot = 0; slot < f; ++slot) slots[start + slot] = (s << 25) | (f << 12) | slot;
+            start += f;
+        }
+        if (start != HLL_RANS_SCALE || static_cast<size_t>(stop - q) < sizeof(x)) return false;
+        bool valid = true;
+        for (uint32_t k = 0; k < HLL_RANS_LANES; ++k) {
+            uint16_t low, high;
+            std::memcpy(&low, q + 4 * k, sizeof(low));
+            std::memcpy(&high, q + 4 * k + 2, sizeof(high));
+            x[k] = low | (static_cast<uint32_t>(high) << 16);
+            valid &= x[k] >= HLL_RANS_LOW && x[k] < (HLL_RANS_LOW << 16);
+        }
+        p = q + sizeof(x);
+        end = stop;
+        return valid;
+    }
+
+    // n кратно HLL_RANS_LANES. Символ читает не больше двух байт, поэтому,
+    // пока их хватает на весь блок, проверки границ не нужны. Состояния на
+    // время блока живут в локальных переменных: иначе каждая запись через
+    // uint8_t* out заставляет перечитывать поля.
+    bool decode(uint8_t* out, uint32_t n) {
+        const uint32_t* table = slots.data();
+        uint32_t s0 = x[0], s1 = x[1], s2 = x[2], s3 = x[3];
+        const uint8_t* q = p;
+        bool ok = true;
+        if (static_cast<size_t>(end - q) >= 2 * static_cast<size_t>(n)) {
+            for (uint32_t i = 0; i < n; i += HLL_RANS_LANES) {
+                step<false>(table, s0, q, end, out[i]);
+                step<false>(table, s1, q, end, out[i + 1]);
+                step<false>(table, s2, q, end, out[i + 2]);
+                step<false>(table, s3, q, end, out[i + 3]);
+            }
+        } else {
+            for (uint32_t i = 0; ok && i < n; i += HLL_RANS_LANES) {
+                ok = step<true>(table, s0, q, end, out[i]) && step<true>(table, s1, q, end, out[i + 1]) &&
+                     step<true>(table, s2, q, end, out[i + 2]) && step<true>(table, s3, q, end, out[i + 3]);
+            }
+        }
+        x[0] = s0;
+        x[1] = s1;
+        x[2] = s2;
+        x[3] = s3;
+        p = q;
+        return ok;
+    }
+
+    // Кодер начинает с состояний HLL_RANS_LOW; декодер, прочитавший весь
+    // поток, должен прийти к ним же.
+    bool finished() const {
+        bool at_start = true;
+        for (uint32_t state : x) at_start &= state == HLL_RANS_LOW;
+        return p == end && at_start;
+    }
+};
+
+// Неизменяемый взгляд на контрольную точку.
+struct HllCheckpointView {
+    HllSketchKind kind;
+    uint32_t b;
+    HllCheckpointType type;
+    HllCheckpointCoding coding;
+    uint64_t base_digest;
+    std::span<const uint8_t> payload;
+
+    uint32_t registerCount() const {
+        return 1u << b;
+    }
+
+    static std::optional<HllCheckpointView> parse(std::span<const uint8_t> bytes) {
+        HllCheckpointHeader header;
+        if (bytes.size() < sizeof(header)) return std::nullopt;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != HLL_CHECKPOINT_MAGIC || header.version != HLL_CHECKPOINT_VERSION) return std::nullopt;
+        if (header.kind < static_cast<uint8_t>(HllSketchKind::HyperLogLog) ||
+            header.kind > static_cast<uint8_t>(HllSketchKind::HyperLogLogCompact)) return std::nullopt;
+        if (header.b < HLL_FORMAT_MIN_B || header.b > HLL_FORMAT_MAX_B) return std::nullopt;
+        if (header.type < static_cast<uint8_t>(HllCheckpointType::Full) ||
+            header.type > static_cast<uint8_t>(HllCheckpointType::Delta)) return std::nullopt;
+        if (header.coding < static_cast<uint8_t>(HllCheckpointCoding::Raw) ||
+            header.coding > static_cast<uint8_t>(HllCheckpointCoding::Rans)) return std::nullopt;
+        if (bytes.size() < sizeof(header) + header.payload_bytes) return std::nullopt;
+
+        HllCheckpointView view{static_cast<HllSketchKind>(header.kind), header.b,
+                               static_cast<HllCheckpointType>(header.type),
+                               static_cast<HllCheckpointCoding>(header.coding), header.base_digest,
+                               bytes.subspan(sizeof(header), header.payload_bytes)};
+        if (view.coding == HllCheckpointCoding::Raw &&
+            (view.type != HllCheckpointType::Full || view.payload.size() != hllPayloadBytes(view.kind, view.b))) {
+            return std::nullopt;
+        }
+        return view;
+    }
+};
+
+inline bool hllBitstreamKind(HllSketchKind kind) {
+    return kind == HllSketchKind::HyperLogLogCompact;
+}
+
+inline std::vector<uint8_t> hllCheckpointBytes(const HllRecordView& record, HllCheckpointType type,
+                                               HllCheckpointCoding coding, uint64_t base_digest,
+                                               std::span<const uint8_t> payload) {
+    HllCheckpointHeader header{};
+    header.magic = HLL_CHECKPOINT_MAGIC;
+    header.version = HLL_CHECKPOINT_VERSION;
+    header.kind = static_cast<uint8_t>(record.kind);
+    header.b = static_cast<uint8_t>(record.b);
+    header.type = static_cast<uint8_t>(type);
+    header.coding = static_cast<uint8_t>(coding);
+    header.payload_bytes = static_cast<uint32_t>(payload.size());
+    header.base_digest = base_digest;
+
+    std::vector<uint8_t> bytes(sizeof(header) + payload.size());
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), payload.data(), payload.size());
+    return bytes;
+}
+
+// Контрольная точка записи record (результат serialize() скетча). С base —
+// записью прежнего снимка того же скетча — получается дельта; если base
+// другой точности или раскладки либо какой-то регистр в нём больше, чем в
+// record, пишется полная точка.
+inline std::vector<uint8_t> hllEncodeCheckpoint(const HllRecordView& record, const HllRecordView* base = nullptr) {
+    const uint32_t m = record.registerCount();
+    const bool bitstream = hllBitstreamKind(record.kind);
+    std::vector<uint8_t> symbols(m);
+    if (bitstream) {
+        hllUnpackBitstream6(record.bitstream(), symbols.data(), m);
+    } else {
+        std::memcpy(symbols.data(), record.registers(), m);
+    }
+
+    HllCheckpointType type = HllCheckpointType::Full;
+    uint64_t base_digest = 0;
+    if (base && base->b == record.b && hllBitstreamKind(base->kind) == bitstream) {
+        std::vector<uint8_t> previous(m);
+        if (bitstream) {
+            hllUnpackBitstream6(base->bitstream(), previous.data(), m);
+        } else {
+            std::memcpy(previous.data(), base->registers(), m);
+        }
+        bool grows = true;
+        for (uint32_t i = 0; i < m; ++i) grows &= previous[i] <= symbols[i];
+        if (grows) {
+            for (uint32_t i = 0; i < m; ++i) symbols[i] -= previous[i];
+            type = HllCheckpointType::Delta;
+            base_digest = hllRegisterDigest(base->payload.data(), base->payload.size());
+        }
+    }
+
+    std::array<uint32_t, HLL_RANS_SYMBOLS> counts{};
+    bool in_range = true;
+    for (uint32_t i = 0; i < m; ++i) {
+        in_range &= symbols[i] < HLL_RANS_SYMBOLS;
+        ++counts[symbols[i] & (HLL_RANS_SYMBOLS - 1)];
+    }
+    if (in_range) {
+        std::array<uint32_t, HLL_RANS_SYMBOLS> freq = hllRansNormalize(counts, m);
+        std::vector<uint8_t> stream = HllRansEncoder(freq).encode(symbols.data(), m);
+
+        std::vector<uint8_t> payload(sizeof(uint64_t));
+        uint64_t present = 0;
+        for (uint32_t s = 0; s < HLL_RANS_SYMBOLS; ++s) {
+            if (freq[s] == 0) continue;
+            present |= 1ull << s;
+            uint16_t f = static_cast<uint16_t>(freq[s]);
+            payload.insert(payload.end(), reinterpret_cast<const uint8_t*>(&f), reinterpret_cast<const uint8_t*>(&f) + 2);
+        }
+        std::memcpy(payload.data(), &present, sizeof(present));
+        payload.insert(payload.end(), stream.begin(), stream.end());
+        if (payload.size() < record.payload.size()) {
+            return hllCheckpointBytes(record, type, HllCheckpointCoding::Rans, base_digest, payload);
+        }
+    }
+    return hllCheckpointBytes(record, HllCheckpointType::Full, HllCheckpointCoding::Raw, 0, record.payload);
+}
+
+// Декодирует точку прямо в регистры в раскладке записи: байт на регистр для
+// HyperLogLog и HyperLogLogImproved, поток шестибитных регистров для
+// HyperLogLogCompact (hllPayloadBytes(kind, b) байт). Для дельты в registers
+// должны лежать регистры base. false — точка повреждена (в том числе значение
+// регистра выше hllMaxRegisterValue(b), как и в HllRecordView::parse) или
+// base не тот; содержимое registers тогда не определено, так что декодировать
+// стоит в копию регистров.
+inline bool hllDecodeCheckpoint(const HllCheckpointView& view, uint8_t* registers) {
+    const uint32_t m = view.registerCount();
+    const size_t payload_bytes = hllPayloadBytes(view.kind, view.b);
+    const bool bitstream = hllBitstreamKind(view.kind);
+    const bool delta = view.type == HllCheckpointType::Delta;
+    const uint8_t max_value = hllMaxRegisterValue(view.b);
+    if (view.coding == HllCheckpointCoding::Raw) {
+        if (hllPayloadMaxRegister(view.kind, view.b, view.payload.data()) > max_value) return false;
+        std::memcpy(registers, view.payload.data(), payload_bytes);
+        return true;
+    }
+    if (delta && hllRegisterDigest(registers, payload_bytes) != view.base_digest) return false;
+
+    HllRansDecoder decoder;
+    if (!decoder.init(view.payload)) return false;
+    uint8_t block[HLL_CHECKPOINT_BLOCK];
+    uint8_t previous[HLL_CHECKPOINT_BLOCK];
+    for (uint32_t i = 0; i < m; i += HLL_CHECKPOINT_BLOCK) {
+        const uint32_t n = std::min(HLL_CHECKPOINT_BLOCK, m - i);
+        if (!bitstream && !delta) {
+            if (!decoder.decode(registers + i, n)) return false;
+            uint8_t top = 0;
+            for (uint32_t k = 0; k < n; ++k) top = std::max(top, registers[i + k]);
+            if (top > max_value) return false;
+            continue;
+        }
+        if (!decoder.decode(block, n)) return false;
+        if (!bitstream) {
+            uint8_t top = 0;
+            for (uint32_t k = 0; k < n; ++k) {
+                registers[i + k] += block[k];
+                top = std::max(top, registers[i + k]);
+            }
+            if (top > max_value) return false;
+            continue;
+        }
+        uint8_t* packed = registers + i / 4 * 3;
+        if (delta) {
+            hllUnpackBitstream6(packed, previous, n);
+            for (uint32_t k = 0; k < n; ++k) block[k] += previous[k];
+        }
+        uint8_t top = 0;
+        for (uint32_t k = 0; k < n; ++k) top = std::max(top, block[k]);
+        if (top > max_value) return false;
+        hllPackBitstream6(block, packed, n);
+    }
+    return decoder.finished();
+}
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef HLL_CONCURRENT_H
+#define HLL_CONCURRENT_H
+
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include "hll_batch.h"
+#include "hll_estimators.h"
+#include "hll_histogram.h"
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+
+// Скетчи, в которые add() одновременно вызывают много потоков. Регистр только
+// растёт, поэтому достаточно атомарного fetch-max с relaxed-порядком: итоговые
+// регистры совпадают с однопоточными при любом чередовании. Большинство вставок
+// не меняет регистр и обходится одной загрузкой без записи в строку кэша.
+// Гистограмма здесь не ведётся (её счётчики стали бы общей горячей точкой),
+// и estimate() читает регистры за O(m); его можно вызывать параллельно с add().
+
+// Возвращает true, если регистр увеличен.
+inline bool hllAtomicMax(uint8_t& reg, uint8_t value) {
+    std::atomic_ref<uint8_t> ref(reg);
+    uint8_t current = ref.load(std::memory_order_relaxed);
+    while (value > current) {
+        if (ref.compare_exchange_weak(current, value, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+// То же для 6-битного поля внутри упакованного слова: CAS заменяет всё слово,
+// так что соседние регистры, записанные другими потоками, не теряются.
+inline bool hllAtomicMaxPacked6(uint32_t& word, uint32_t bit_offset, uint8_t value) {
+    std::atomic_ref<uint32_t> ref(word);
+    const uint32_t mask = 0x3Fu << bit_offset;
+    uint32_t current = ref.load(std::memory_order_relaxed);
+    while (value > ((current & mask) >> bit_offset)) {
+        uint32_t desired = (current & ~mask) | (static_cast<uint32_t>(value) << bit_offset);
+        if (ref.compare_exchange_weak(current, desired, std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+class HyperLogLogConcurrent {
+private:
+    uint32_t b;
+    uint32_t m;
+    std::vector<uint8_t> M;
+    uint8_t rho(uint32_t w) const {
+        return hllRho(w, b);
+    }
+
+public:
+    HyperLogLogConcurrent(uint32_t b_bits) : b(b_bits), m(1u << b_bits) {
+        M.resize(m, 0);
+    }
+
+    void add(uint32_t hash) {
+        uint32_t j = hash >> (32 - b);
+        uint32_t w = hash << b;
+        hllAtomicMax(M[j], rho(w));
+    }
+
+    void addBatch(std::span<const uint32_t> hashes) {
+        const uint8_t* regs = M.data();
+        hllForEachBlock(hashes, b, M.size() >= HLL_PREFETCH_MIN_BYTES,
+            [regs](uint32_t j) { hllPrefetch(regs + j); },
+            [this](uint32_t j, uint8_t r) { hllAtomicMax(M[j], r); });
+    }
+
+    // Снимок читается без блокировок: каждый регистр — согласованное значение,
+    // которое было в нём во время чтения.
+    HllHistogram snapshotHistogram() const {
+        HllHistogram hist;
+        for (uint32_t i = 0; i < m; ++i) ++hist.counts[getRegister(i)];
+        return hist;
+    }
+
+    // Формула та же, что у HyperLogLog, по снимку регистров.
+    double estimate() const {
+        return HyperLogLog::estimateFromHistogram(snapshotHistogram(), b);
+    }
+
+    double estimate(HllEstimator method) const {
+        if (method == HllEstimator::Classic) return estimate();
+        return hllEstimateFromHistogram(method, snapshotHistogram(), b);
+    }
+
+    uint8_t getRegister(uint32_t index) const {
+        return std::atomic_ref<uint8_t>(const_cast<uint8_t&>(M[index])).load(std::memory_order_relaxed);
+    }
+
+    // Не потокобезопасно: вызывать, когда писателей нет.
+    void reset() {
+        std::fill(M.begin(), M.end(), 0);
+    }
+
+    size_t getMemoryUsage() const {
+        return M.size() * sizeof(uint8_t);
+    }
+};
+
+class HyperLogLogCompactConcurrent {
+private:
+    uint32_t b;
+    uint32_t m;
+    std::vector<uint32_t> M_packed;
+    static constexpr uint8_t BITS_PER_REGISTER = 6;
+    static constexpr uint8_t MAX_REGISTER_VALUE = (1 << BITS_PER_REGISTER) - 1;
+    uint8_t rho(uint32_t w) const {
+        return std::min(hllRho(w, b), MAX_REGISTER_VALUE);
+    }
+
+    void updateRegister(uint32_t index, uint8_t value) {
+        uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
+        uint32_t uint32_index = index / bits_per_uint32;
+        uint32_t bit_offset = (index % bits_per_uint32) * BITS_PER_REGISTER;
+        hllAtomicMaxPacked6(M_packed[uint32_index], bit_offset, std::min(value, MAX_REGISTER_VALUE));
+    }
+
+public:
+    HyperLogLogCompactConcurrent(uint32_t b_bits) : b(b_bits), m(1u << b_bits) {
+        uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
+        M_packed.resize((m + bits_per_uint32 - 1) / bits_per_uint32, 0);
+    }
+
+    void add(uint32_t hash) {
+        uint32_t j = hash >> (32 - b);
+        uint32_t w = hash << b;
+        updateRegister(j, rho(w));
+    }
+
+    void addBatch(std::span<const uint32_t> hashes) {
+        const uint32_t* words = M_packed.data();
+        hllForEachBlock(hashes, b, getMemoryUsage() >= HLL_PREFETCH_MIN_BYTES,
+            [words](uint32_t j) { hllPrefetch(words + j / (32 / BITS_PER_REGISTER)); },
+            [this](uint32_t j, uint8_t r) { updateRegister(j, r); });
+    }
+
+    HllHistogram snapshotHistogram() const {
+        const uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
+        HllHistogram hist;
+        uint32_t index = 0;
+        for (const uint32_t& packed : M_packed) {
+            uint32_t word = std::atomic_ref<uint32_t>(const_cast<uint32_t&>(packed)).load(std::memory_order_relaxed);
+            for (uint32_t k = 0; k < bits_per_uint32 && index < m; ++k, ++index) {
+                ++hist.counts[(word >> (k * BITS_PER_REGISTER)) & MAX_REGISTER_VALUE];
+            }
+        }
+        return hist;
+    }
+
+    double estimate() const {
+        return HyperLogLogCompact::estimateFromHistogram(snapshotHistogram(), b);
+    }
+
+    double estimate(HllEstimator method) const {
+        if (method == HllEstimator::Classic) return estimate();
+        return hllEstimateFromHistogram(method, snapshotHistogram(), b);
+    }
+
+    uint8_t getRegister(uint32_t index) const {
+        uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
+        uint32_t word = std::atomic_ref<uint32_t>(
+            const_cast<uint32_t&>(M_packed[index / bits_per_uint32])).load(std::memory_order_relaxed);
+        return (word >> ((index % bits_per_uint32) * BITS_PER_REGISTER)) & MAX_REGISTER_VALUE;
+    }
+
+    // Не потокобезопасно: вызывать, когда писателей нет.
+    void reset() {
+        std::fill(M_packed.begin(), M_packed.end(), 0);
+    }
+
+    size_t getMemoryUsage() const {
+        return M_packed.size() * sizeof(uint32_t);
+    }
+};
+
+#endif
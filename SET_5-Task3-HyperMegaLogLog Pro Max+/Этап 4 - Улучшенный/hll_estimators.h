@@ -0,0 +1,123 @@
+#ifndef HLL_ESTIMATORS_H
+#define HLL_ESTIMATORS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "hll_histogram.h"
+
+// Оценки Эртла (O. Ertl, "New cardinality estimation algorithms for
+// HyperLogLog sketches", 2017) по гистограмме значений регистров: O(q) вместо
+// O(m) и без подобранных вручную поправок, одинаково ведут себя при любом b и
+// на всём диапазоне мощностей. q = hash_bits - b — число бит хеша, по которым
+// считается rho, поэтому регистр принимает значения 0..q+1.
+enum class HllEstimator {
+    Classic,        // собственная формула скетча
+    Improved,       // улучшенная сырая оценка
+    MaxLikelihood   // оценка максимального правдоподобия
+};
+
+constexpr double HLL_ALPHA_INF = 0.72134752044448170368; // 1 / (2 ln 2)
+
+// sigma(x) = x + sum_{k>=1} x^(2^k) 2^(k-1): поправка на пустые регистры.
+inline double hllSigma(double x) {
+    if (x == 1.0) return std::numeric_limits<double>::infinity();
+    double y = 1.0;
+    double z = x;
+    double z_prev;
+    do {
+        x *= x;
+        z_prev = z;
+        z += x * y;
+        y += y;
+    } while (z != z_prev);
+    return z;
+}
+
+// tau(x) = (1 - x - sum_{k>=1} (1 - x^(2^-k))^2 2^-k) / 3: поправка на
+// регистры, дошедшие до q+1.
+inline double hllTau(double x) {
+    if (x == 0.0 || x == 1.0) return 0.0;
+    double y = 1.0;
+    double z = 1.0 - x;
+    double z_prev;
+    do {
+        x = std::sqrt(x);
+        z_prev = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != z_prev);
+    return z / 3;
+}
+
+inline double hllImprovedEstimate(const HllHistogram& hist, uint32_t b, uint32_t hash_bits = 32) {
+    const uint32_t q = hash_bits - b;
+    const double m = static_cast<double>(1u << b);
+    double z = m * hllTau(1.0 - hist.counts[q + 1] / m);
+    for (uint32_t k = q; k >= 1; --k) z = 0.5 * (z + hist.counts[k]);
+    z += m * hllSigma(hist.counts[0] / m);
+    return HLL_ALPHA_INF * m * m / z;
+}
+
+// Корень производной логарифма правдоподобия по мощности находится методом
+// секущих (алгоритм 8 статьи); итераций обычно 2-3, каждая O(q).
+inline double hllMaxLikelihoodEstimate(const HllHistogram& hist, uint32_t b, uint32_t hash_bits = 32) {
+    const int q = static_cast<int>(hash_bits - b);
+    const uint32_t m = 1u << b;
+    const auto& c = hist.counts;
+    if (c[q + 1] == m) return std::numeric_limits<double>::infinity();
+
+    int k_min = 0;
+    while (c[k_min] == 0) ++k_min;
+    int k_max = q + 1;
+    while (c[k_max] == 0) --k_max;
+    const int k_lo = std::max(k_min, 1);
+    const int k_hi = std::min(k_max, q);
+
+    double z = 0.0;
+    for (int k = k_hi; k >= k_lo; --k) z = 0.5 * z + c[k];
+    z = std::ldexp(z, -k_lo);
+    double c_top = c[q + 1];
+    if (q >= 1) c_top += c[k_hi];
+
+    const double a = z + c[0];
+    const double b_sum = z + std::ldexp(static_cast<double>(c[q + 1]), -q);
+    const double m_used = static_cast<double>(m - c[0]);
+    double x = b_sum <= 1.5 * a ? m_used / (0.5 * b_sum + a) : m_used / b_sum * std::log1p(b_sum / a);
+
+    const double eps = 1e-2 / std::sqrt(static_cast<double>(m));
+    double dx = x;
+    double g_prev = 0.0;
+    while (dx > x * eps) {
+        int kappa = 2 + std::ilogb(x);
+        double x1 = std::ldexp(x, -std::max(k_hi, kappa) - 1);
+        double x2 = x1 * x1;
+        double h = x1 - x2 / 3 + (x2 * x2) * (1.0 / 45 - x2 / 472.5);
+        for (int k = kappa - 1; k >= k_hi; --k) {
+            h = (x1 + h * (1.0 - h)) / (x1 + (1.0 - h));
+            x1 += x1;
+        }
+        double g = c_top * h;
+        for (int k = k_hi - 1; k >= k_lo; --k) {
+            h = (x1 + h * (1.0 - h)) / (x1 + (1.0 - h));
+            g += c[k] * h;
+            x1 += x1;
+        }
+        g += x * a;
+        dx = g > g_prev && m_used >= g ? dx * (m_used - g) / (g - g_prev) : 0.0;
+        x += dx;
+        g_prev = g;
+    }
+    return m * x;
+}
+
+// Improved или MaxLikelihood; Classic здесь не определён и даёт Improved —
+// собственную формулу скетч применяет сам.
+inline double hllEstimateFromHistogram(HllEstimator method, const HllHistogram& hist,
+                                       uint32_t b, uint32_t hash_bits = 32) {
+    if (method == HllEstimator::MaxLikelihood) return hllMaxLikelihoodEstimate(hist, b, hash_bits);
+    return hllImprovedEstimate(hist, b, hash_bits);
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef HLL_EXPERIMENT_H
+#define HLL_EXPERIMENT_H
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "hash_function.h"
+
+// Среднее и дисперсия по Уэлфорду: значение учитывается за O(1) по мере
+// поступления, выборка не хранится, и нет потери точности, как у формулы
+// через сумму квадратов.
+struct HllWelford {
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    void add(double x) {
+        ++count;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+    }
+
+    // Объединение двух независимо набранных выборок (Chan, Golub, LeVeque).
+    void merge(const HllWelford& other) {
+        if (other.count == 0) return;
+        uint64_t total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * (static_cast<double>(count) * other.count / total);
+        count = total;
+    }
+
+    // Дисперсия с делением на n, как σ считалась в сравнении раньше.
+    double variance() const {
+        return count ? m2 / count : 0.0;
+    }
+
+    double stddev() const {
+        return std::sqrt(variance());
+    }
+
+    // Корень из среднего квадрата значений: для относительных ошибок — RMSE.
+    double rms() const {
+        return std::sqrt(variance() + mean * mean);
+    }
+};
+
+// Зерно эксперимента зависит только от базового зерна и номера эксперимента,
+// а не от потока, который его выполнил.
+inline uint64_t hllExperimentSeed(uint64_t base_seed, uint64_t index) {
+    return splitmix64(base_seed + splitmix64(index));
+}
+
+// Выполняет run(i) для i из [0, count) на threads потоках и передаёт
+// результаты в fold(i, result) строго по возрастанию i, по одному за раз.
+// Пришедшие раньше очереди результаты ждут в буфере, а поток, ушедший вперёд
+// свёртки больше чем на window экспериментов, ждёт её, поэтому в памяти
+// одновременно не больше window результатов. Порядок свёртки фиксирован, и
+// итог бит в бит не зависит от числа потоков. fold вызывается под блокировкой
+// и должен быть дешёвым по сравнению с run.
+template <class Run, class Fold>
+void hllRunExperiments(size_t count, unsigned threads, Run&& run, Fold&& fold) {
+    using Result = std::invoke_result_t<Run&, size_t>;
+    if (count == 0) return;
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, count)));
+    const size_t window = static_cast<size_t>(threads) * 4;
+
+    std::mutex mutex;
+    std::condition_variable can_start;
+    std::map<size_t, Result> pending;
+    size_t next_task = 0;
+    size_t next_fold = 0;
+
+    auto worker = [&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            can_start.wait(lock, [&] { return next_task >= count || next_task < next_fold + window; });
+            if (next_task >= count) return;
+            size_t index = next_task++;
+            lock.unlock();
+            Result result = run(index);
+            lock.lock();
+
+            pending.emplace(index, std::move(result));
+            bool folded = false;
+            for (auto it = pending.begin(); it != pending.end() && it->first == next_fold;
+                 it = pending.erase(it)) {
+                fold(next_fold++, std::move(it->second));
+                folded = true;
+            }
+            if (folded) can_start.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) thread.join();
+}
+
+#endif
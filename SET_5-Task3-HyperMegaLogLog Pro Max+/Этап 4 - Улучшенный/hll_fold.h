@@ -0,0 +1,58 @@
+#ifndef HLL_FOLD_H
+#define HLL_FOLD_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// Свёртка точности: скетч с b битами индекса превращается в скетч с
+// target_b = b - k битами, в точности равный построенному с target_b на тех
+// же хешах. Младшие k бит индекса j становятся старшими битами остатка хеша,
+// поэтому регистр j со значением r > 0 даёт регистру j >> k значение
+//   k - bit_width(j mod 2^k) + 1, если младшие k бит j не все нули
+//     (rho определяется уже ими, и r не нужно);
+//   r + k, если все нули (k нулей, затем прежний остаток).
+// Верхняя граница r + k совпадает с границей rho при target_b; шестибитные
+// регистры дополнительно ограничиваются max_value, как при вставке.
+constexpr uint32_t HLL_FOLD_MIN_B = 4;
+
+inline uint8_t hllFoldValue(uint32_t low_bits, uint8_t r, uint32_t k, uint8_t max_value) {
+    if (r == 0) return 0;
+    uint32_t value = low_bits != 0 ? k - static_cast<uint32_t>(std::bit_width(low_bits)) + 1 : r + k;
+    return static_cast<uint8_t>(std::min<uint32_t>(value, max_value));
+}
+
+// regs — 2^b регистров по байту, out — 2^target_b.
+inline void hllFoldRegisters(const uint8_t* regs, uint32_t b, uint32_t target_b, uint8_t* out,
+                             uint8_t max_value = std::numeric_limits<uint8_t>::max()) {
+    const uint32_t k = b - target_b;
+    const uint32_t target_m = 1u << target_b;
+    if (k == 0) {
+        std::memcpy(out, regs, target_m);
+        return;
+    }
+    const uint32_t group = 1u << k;
+    for (uint32_t t = 0; t < target_m; ++t) {
+        const uint8_t* src = regs + (static_cast<size_t>(t) << k);
+        uint8_t best = hllFoldValue(0, src[0], k, max_value);
+        for (uint32_t low = 1; low < group; ++low) {
+            best = std::max(best, hllFoldValue(low, src[low], k, max_value));
+        }
+        out[t] = best;
+    }
+}
+
+// Объединение скетчей разной точности: результат имеет меньшую из двух, более
+// точный скетч сворачивается. Sketch — класс с getB() и merge(), принимающим
+// более точный скетч (сворачивает его сам через fold).
+template <class Sketch>
+Sketch hllUnion(const Sketch& a, const Sketch& b) {
+    const bool a_coarser = a.getB() <= b.getB();
+    Sketch result = a_coarser ? a : b;
+    result.merge(a_coarser ? b : a);
+    return result;
+}
+
+#endif
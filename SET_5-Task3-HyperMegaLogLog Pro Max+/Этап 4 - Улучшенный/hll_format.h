@@ -0,0 +1,130 @@
+#ifndef HLL_FORMAT_H
+#define HLL_FORMAT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <vector>
+#include "hll_packing.h"
+
+// Двоичный формат скетча: 16-байтный заголовок и сразу за ним регистры в том
+// же виде, что и в памяти (байт на регистр или поток шестибитных регистров,
+// без байта запаса). Числа записываются в порядке байт машины (little-endian
+// на всех поддерживаемых платформах), поэтому регистры читаются прямо из
+// отображённого файла без разбора. Версия 1 хранила HyperLogLogCompact
+// словами по 5 регистров и больше не читается.
+constexpr uint32_t HLL_FORMAT_MAGIC = 0x524C4C48;  // "HLLR"
+constexpr uint16_t HLL_FORMAT_VERSION = 2;
+constexpr uint32_t HLL_FORMAT_MIN_B = 4;
+constexpr uint32_t HLL_FORMAT_MAX_B = 25;
+
+enum class HllSketchKind : uint8_t {
+    HyperLogLog = 1,
+    HyperLogLogImproved = 2,
+    HyperLogLogCompact = 3
+};
+
+struct HllRecordHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t kind;
+    uint8_t b;
+    uint32_t payload_bytes;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(HllRecordHeader) == 16, "HllRecordHeader must stay 16 bytes");
+
+// Размер регистров в байтах для данного вида скетча.
+inline size_t hllPayloadBytes(HllSketchKind kind, uint32_t b) {
+    uint32_t m = 1u << b;
+    return kind == HllSketchKind::HyperLogLogCompact ? hllBitstreamBytes(m) : m;
+}
+
+// Наибольшее значение регистра: rho 32-битного хеша после b бит индекса не
+// больше 33 - b. Больший байт в записи — порча, и он вышел бы за гистограмму
+// и таблицу HLL_INV_POW2.
+inline uint8_t hllMaxRegisterValue(uint32_t b) {
+    return static_cast<uint8_t>(33 - b);
+}
+
+// Наибольший регистр в регистрах записи.
+inline uint8_t hllPayloadMaxRegister(HllSketchKind kind, uint32_t b, const uint8_t* payload) {
+    uint32_t m = 1u << b;
+    uint8_t top = 0;
+    if (kind != HllSketchKind::HyperLogLogCompact) {
+        for (uint32_t i = 0; i < m; ++i) top = std::max(top, payload[i]);
+        return top;
+    }
+    const uint32_t BLOCK = 256;
+    uint8_t regs[BLOCK];
+    for (uint32_t i = 0; i < m; i += BLOCK) {
+        uint32_t n = std::min(BLOCK, m - i);
+        hllUnpackBitstream6(payload + i / 4 * 3, regs, n);
+        for (uint32_t k = 0; k < n; ++k) top = std::max(top, regs[k]);
+    }
+    return top;
+}
+
+inline std::vector<uint8_t> hllEncodeRecord(HllSketchKind kind, uint32_t b, const void* payload) {
+    HllRecordHeader header{};
+    header.magic = HLL_FORMAT_MAGIC;
+    header.version = HLL_FORMAT_VERSION;
+    header.kind = static_cast<uint8_t>(kind);
+    header.b = static_cast<uint8_t>(b);
+    header.payload_bytes = static_cast<uint32_t>(hllPayloadBytes(kind, b));
+
+    std::vector<uint8_t> bytes(sizeof(header) + header.payload_bytes);
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), payload, header.payload_bytes);
+    return bytes;
+}
+
+// Неизменяемый взгляд на запись, например внутри отображённого файла.
+// Ничего не копирует; данные должны жить дольше взгляда.
+struct HllRecordView {
+    HllSketchKind kind;
+    uint32_t b;
+    std::span<const uint8_t> payload;
+
+    uint32_t registerCount() const {
+        return 1u << b;
+    }
+
+    // Для HyperLogLog и HyperLogLogImproved: байт на регистр.
+    const uint8_t* registers() const {
+        return payload.data();
+    }
+
+    // Для HyperLogLogCompact: поток шестибитных регистров.
+    const uint8_t* bitstream() const {
+        return payload.data();
+    }
+
+    // Проверяет заголовок, размер и значения регистров; nullopt для чужих,
+    // усечённых или повреждённых данных и для неизвестной версии.
+    static std::optional<HllRecordView> parse(std::span<const uint8_t> bytes) {
+        HllRecordHeader header;
+        if (bytes.size() < sizeof(header)) return std::nullopt;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != HLL_FORMAT_MAGIC || header.version != HLL_FORMAT_VERSION) return std::nullopt;
+        if (header.kind < static_cast<uint8_t>(HllSketchKind::HyperLogLog) ||
+            header.kind > static_cast<uint8_t>(HllSketchKind::HyperLogLogCompact)) return std::nullopt;
+        if (header.b < HLL_FORMAT_MIN_B || header.b > HLL_FORMAT_MAX_B) return std::nullopt;
+
+        HllSketchKind kind = static_cast<HllSketchKind>(header.kind);
+        if (header.payload_bytes != hllPayloadBytes(kind, header.b) ||
+            bytes.size() < sizeof(header) + header.payload_bytes) return std::nullopt;
+
+        std::span<const uint8_t> payload = bytes.subspan(sizeof(header), header.payload_bytes);
+        if (hllPayloadMaxRegister(kind, header.b, payload.data()) > hllMaxRegisterValue(header.b)) {
+            return std::nullopt;
+        }
+        return HllRecordView{kind, header.b, payload};
+    }
+};
+
+#endif
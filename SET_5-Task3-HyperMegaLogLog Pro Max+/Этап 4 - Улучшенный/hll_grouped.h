@@ -0,0 +1,371 @@
+#ifndef HLL_GROUPED_H
+#define HLL_GROUPED_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+#include "hash_function.h"
+#include "hll_batch.h"
+#include "hll_histogram.h"
+#include "hll_merge.h"
+#include "hll_sparse.h"
+#include "hyperloglog_improved.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Число различных элементов по группам (GROUP BY ключ группы) для миллионов
+// групп одной точности b. Вместо отдельного скетча с std::vector на группу
+// регистры всех групп лежат в общих слабах по HLL_GROUP_SLAB_WORDS слов, а
+// группа хранит только смещение блока:
+//   разреженная — неотсортированный список (j << HLL_SPARSE_RHO_BITS) | rho
+//                 с точностью b, ёмкость 4, 8, ... до HLL_GROUP_SPARSE_MAX;
+//   плотная     — по 5 шестибитных регистров в 32-битном слове, как у
+//                 HllPacked5Registers (hll_packing.h).
+// Освобождённые при росте и переходе в плотный режим блоки идут в списки
+// свободных блоков своего размера и отдаются следующим группам. Ключ группы
+// переводится в номер группы плоской таблицей с открытой адресацией.
+// Регистры те же, что у HyperLogLogCompact(b) без разреженного режима, и
+// оценка каждой группы совпадает с его оценкой бит в бит.
+constexpr uint32_t HLL_GROUP_SPARSE_MAX = 256;
+constexpr uint32_t HLL_GROUP_SLAB_WORDS = 1u << 20;
+
+class HllGroupTable {
+private:
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t MIN_SPARSE = 4;
+    static constexpr uint8_t DENSE_CLASS = 0xFF;
+    static constexpr uint32_t RHO_MASK = (1u << HLL_SPARSE_RHO_BITS) - 1;
+    static constexpr size_t BATCH_CHUNK = 64;
+    static constexpr size_t PREFETCH_DISTANCE = 8;
+
+    struct Group {
+        uint64_t key;
+        uint32_t offset;
+        // Записей разреженного списка.
+        uint32_t count;
+        // Ёмкость списка MIN_SPARSE << size_class; DENSE_CLASS — плотная.
+        uint8_t size_class;
+    };
+
+    struct MapSlot {
+        uint64_t key;
+        uint32_t group;
+    };
+
+    uint32_t b;
+    uint32_t m;
+    uint32_t dense_words;
+    uint32_t sparse_max;
+    uint32_t sparse_classes;
+    std::vector<Group> groups;
+    std::vector<MapSlot> map;
+    size_t map_mask;
+    std::vector<std::unique_ptr<uint32_t[]>> slabs;
+    uint32_t slab_used = HLL_GROUP_SLAB_WORDS;
+    // По классу размера; последний список — плотные блоки.
+    std::vector<std::vector<uint32_t>> free_blocks;
+
+    uint32_t blockWords(uint32_t size_class) const {
+        return size_class == sparse_classes ? dense_words : MIN_SPARSE << size_class;
+    }
+
+    uint32_t* block(uint32_t offset) {
+        return slabs[offset / HLL_GROUP_SLAB_WORDS].get() + offset % HLL_GROUP_SLAB_WORDS;
+    }
+
+    const uint32_t* block(uint32_t offset) const {
+        return slabs[offset / HLL_GROUP_SLAB_WORDS].get() + offset % HLL_GROUP_SLAB_WORDS;
+    }
+
+    // Блок не пересекает границу слаба: хвост слаба, в который блок не влез,
+    // пропускается.
+    uint32_t allocate(uint32_t size_class) {
+        std::vector<uint32_t>& free_list = free_blocks[size_class];
+        if (!free_list.empty()) {
+            uint32_t offset = free_list.back();
+            free_list.pop_back();
+            return offset;
+        }
+        uint32_t words = blockWords(size_class);
+        if (slab_used + words > HLL_GROUP_SLAB_WORDS) {
+            slabs.push_back(std::make_unique_for_overwrite<uint32_t[]>(HLL_GROUP_SLAB_WORDS));
+            slab_used = 0;
+        }
+        uint32_t offset = static_cast<uint32_t>(slabs.size() - 1) * HLL_GROUP_SLAB_WORDS + slab_used;
+        slab_used += words;
+        return offset;
+    }
+
+    void release(uint32_t offset, uint32_t size_class) {
+        free_blocks[size_class].push_back(offset);
+    }
+
+    size_t mapHome(uint64_t key) const {
+        return static_cast<size_t>(splitmix64(key)) & map_mask;
+    }
+
+    void growMap() {
+        std::vector<MapSlot> old(map.size() * 2, {0, EMPTY});
+        old.swap(map);
+        map_mask = map.size() - 1;
+        for (const MapSlot& slot : old) {
+            if (slot.group == EMPTY) continue;
+            size_t pos = mapHome(slot.key);
+            while (map[pos].group != EMPTY) pos = (pos + 1) & map_mask;
+            map[pos] = slot;
+        }
+    }
+
+    // Номер группы ключа; новая группа создаётся пустой разреженной.
+    uint32_t groupIndex(uint64_t key) {
+        if ((groups.size() + 1) * 8 > map.size() * 7) growMap();
+        size_t pos = mapHome(key);
+        while (map[pos].group != EMPTY) {
+            if (map[pos].key == key) return map[pos].group;
+            pos = (pos + 1) & map_mask;
+        }
+        uint32_t id = static_cast<uint32_t>(groups.size());
+        groups.push_back({key, allocate(0), 0, 0});
+        map[pos] = {key, id};
+        return id;
+    }
+
+    static int findSparse(const uint32_t* entries, uint32_t count, uint32_t j) {
+        uint32_t i = 0;
+#if defined(__AVX2__)
+        const __m256i target = _mm256_set1_epi32(static_cast<int>(j));
+        for (; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entries + i));
+            __m256i eq = _mm256_cmpeq_epi32(_mm256_srli_epi32(v, HLL_SPARSE_RHO_BITS), target);
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+            if (mask != 0) return static_cast<int>(i) + std::countr_zero(static_cast<unsigned>(mask));
+        }
+#endif
+        for (; i < count; ++i) {
+            if ((entries[i] >> HLL_SPARSE_RHO_BITS) == j) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    static void setDense(uint32_t* words, uint32_t j, uint8_t r) {
+        uint32_t& word = words[j / HLL_PACKED6_PER_WORD];
+        uint32_t shift = j % HLL_PACKED6_PER_WORD * 6;
+        if (((word >> shift) & HLL_PACKED6_MASK) < r) {
+            word = (word & ~(HLL_PACKED6_MASK << shift)) | (static_cast<uint32_t>(r) << shift);
+        }
+    }
+
+    void promote(Group& group) {
+        uint32_t offset = allocate(sparse_classes);
+        uint32_t* words = block(offset);
+        std::fill(words, words + dense_words, 0);
+        const uint32_t* entries = block(group.offset);
+        for (uint32_t i = 0; i < group.count; ++i) {
+            setDense(words, entries[i] >> HLL_SPARSE_RHO_BITS, static_cast<uint8_t>(entries[i] & RHO_MASK));
+        }
+        release(group.offset, group.size_class);
+        group.offset = offset;
+        group.count = 0;
+        group.size_class = DENSE_CLASS;
+    }
+
+    void update(Group& group, uint32_t j, uint8_t r) {
+        if (group.size_class == DENSE_CLASS) {
+            setDense(block(group.offset), j, r);
+            return;
+        }
+        uint32_t* entries = block(group.offset);
+        int pos = findSparse(entries, group.count, j);
+        if (pos >= 0) {
+            if ((entries[pos] & RHO_MASK) < r) entries[pos] = (j << HLL_SPARSE_RHO_BITS) | r;
+            return;
+        }
+        if (group.count == (MIN_SPARSE << group.size_class)) {
+            if (group.count >= sparse_max) {
+                promote(group);
+                setDense(block(group.offset), j, r);
+                return;
+            }
+            uint32_t offset = allocate(group.size_class + 1u);
+            std::memcpy(block(offset), entries, group.count * sizeof(uint32_t));
+            release(group.offset, group.size_class);
+            group.offset = offset;
+            ++group.size_class;
+            entries = block(offset);
+        }
+        entries[group.count++] = (j << HLL_SPARSE_RHO_BITS) | r;
+    }
+
+    void prefetchTarget(const Group& group, uint32_t hash) const {
+        const uint32_t* p = block(group.offset);
+        if (group.size_class == DENSE_CLASS) p += (hash >> (32 - b)) / HLL_PACKED6_PER_WORD;
+        hllPrefetch(p);
+    }
+
+    // Сумма 2^-M[i] и число нулей плотного блока. Слагаемые двоично-рациональны
+    // и сумма точна в double при любом порядке сложения (см. HllHistogram),
+    // поэтому совпадает с суммой по гистограмме.
+    void denseSums(const uint32_t* words, double& sum, uint32_t& zeros) const {
+        uint32_t w = 0;
+        sum = 0.0;
+        zeros = 0;
+#if defined(__AVX2__)
+        const __m256i field = _mm256_set1_epi32(HLL_PACKED6_MASK);
+        const __m256i exponent_bias = _mm256_set1_epi64x(1023);
+        const __m256i zero = _mm256_setzero_si256();
+        __m256d acc_lo = _mm256_setzero_pd();
+        __m256d acc_hi = _mm256_setzero_pd();
+        __m256i zero_count = zero;
+        for (; w + 8 <= dense_words; w += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + w));
+            for (uint32_t k = 0; k < HLL_PACKED6_PER_WORD; ++k) {
+                __m256i r = _mm256_and_si256(v, field);
+                v = _mm256_srli_epi32(v, 6);
+                zero_count = _mm256_sub_epi32(zero_count, _mm256_cmpeq_epi32(r, zero));
+                // 2^-r собирается прямо в показателе double.
+                __m256i r_lo = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(r));
+                __m256i r_hi = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(r, 1));
+                acc_lo = _mm256_add_pd(acc_lo, _mm256_castsi256_pd(
+                    _mm256_slli_epi64(_mm256_sub_epi64(exponent_bias, r_lo), 52)));
+                acc_hi = _mm256_add_pd(acc_hi, _mm256_castsi256_pd(
+                    _mm256_slli_epi64(_mm256_sub_epi64(exponent_bias, r_hi), 52)));
+            }
+        }
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, _mm256_add_pd(acc_lo, acc_hi));
+        sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        alignas(32) uint32_t counts[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(counts), zero_count);
+        for (uint32_t c : counts) zeros += c;
+#endif
+        for (; w < dense_words; ++w) {
+            for (uint32_t k = 0; k < HLL_PACKED6_PER_WORD; ++k) {
+                uint32_t r = (words[w] >> (k * 6)) & HLL_PACKED6_MASK;
+                sum += HLL_INV_POW2[r];
+                zeros += r == 0;
+            }
+        }
+        // Поля последнего слова за пределами m всегда нулевые.
+        uint32_t padding = dense_words * HLL_PACKED6_PER_WORD - m;
+        sum -= padding;
+        zeros -= padding;
+    }
+
+    double estimateGroup(const Group& group) const {
+        double sum;
+        uint32_t zeros;
+        if (group.size_class == DENSE_CLASS) {
+            denseSums(block(group.offset), sum, zeros);
+        } else {
+            const uint32_t* entries = block(group.offset);
+            zeros = m - group.count;
+            sum = zeros;
+            for (uint32_t i = 0; i < group.count; ++i) sum += HLL_INV_POW2[entries[i] & RHO_MASK];
+        }
+        return HyperLogLogCompact::estimateFromSum(sum, zeros, 0, b);
+    }
+
+public:
+    explicit HllGroupTable(uint32_t b_bits)
+        : b(b_bits), m(1u << b_bits),
+          dense_words((m + HLL_PACKED6_PER_WORD - 1) / HLL_PACKED6_PER_WORD),
+          sparse_max(std::min(HLL_GROUP_SPARSE_MAX, std::max(MIN_SPARSE, std::bit_floor(dense_words)))),
+          sparse_classes(static_cast<uint32_t>(std::countr_zero(sparse_max / MIN_SPARSE)) + 1),
+          map(64, {0, EMPTY}), map_mask(map.size() - 1), free_blocks(sparse_classes + 1) {}
+
+    void add(uint64_t key, uint32_t hash) {
+        update(groups[groupIndex(key)], hash >> (32 - b), hllRho(hash << b, b));
+    }
+
+    // Пары (keys[i], hashes[i]) кусками по BATCH_CHUNK: сначала ключи
+    // переводятся в номера групп, затем пары применяются, а блок регистров
+    // для пары на PREFETCH_DISTANCE позиций дальше уже запрошен.
+    void addBatch(std::span<const uint64_t> keys, std::span<const uint32_t> hashes) {
+        uint32_t ids[BATCH_CHUNK];
+        const size_t total = std::min(keys.size(), hashes.size());
+        for (size_t begin = 0; begin < total; begin += BATCH_CHUNK) {
+            const size_t n = std::min(BATCH_CHUNK, total - begin);
+            for (size_t i = 0; i < n; ++i) {
+                if (i + PREFETCH_DISTANCE < n) hllPrefetch(&map[mapHome(keys[begin + i + PREFETCH_DISTANCE])]);
+                ids[i] = groupIndex(keys[begin + i]);
+            }
+            for (size_t i = 0; i < std::min(n, PREFETCH_DISTANCE); ++i) {
+                prefetchTarget(groups[ids[i]], hashes[begin + i]);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                if (i + PREFETCH_DISTANCE < n) {
+                    prefetchTarget(groups[ids[i + PREFETCH_DISTANCE]], hashes[begin + i + PREFETCH_DISTANCE]);
+                }
+                uint32_t hash = hashes[begin + i];
+                update(groups[ids[i]], hash >> (32 - b), hllRho(hash << b, b));
+            }
+        }
+    }
+
+    uint32_t size() const {
+        return static_cast<uint32_t>(groups.size());
+    }
+
+    uint64_t keyAt(uint32_t group) const {
+        return groups[group].key;
+    }
+
+    bool isSparse(uint32_t group) const {
+        return groups[group].size_class != DENSE_CLASS;
+    }
+
+    std::optional<uint32_t> find(uint64_t key) const {
+        for (size_t pos = mapHome(key); map[pos].group != EMPTY; pos = (pos + 1) & map_mask) {
+            if (map[pos].key == key) return map[pos].group;
+        }
+        return std::nullopt;
+    }
+
+    double estimate(uint32_t group) const {
+        return estimateGroup(groups[group]);
+    }
+
+    // Оценки всех групп одним проходом по слабам, в порядке номеров групп.
+    void estimateAll(std::span<double> out) const {
+        const size_t n = std::min(out.size(), groups.size());
+        for (size_t i = 0; i < n; ++i) {
+            if (i + 1 < n) hllPrefetch(block(groups[i + 1].offset));
+            out[i] = estimateGroup(groups[i]);
+        }
+    }
+
+    std::vector<double> estimateAll() const {
+        std::vector<double> result(groups.size());
+        estimateAll(result);
+        return result;
+    }
+
+    void reset() {
+        groups.clear();
+        map.assign(64, {0, EMPTY});
+        map_mask = map.size() - 1;
+        slabs.clear();
+        slab_used = HLL_GROUP_SLAB_WORDS;
+        for (auto& free_list : free_blocks) free_list.clear();
+    }
+
+    uint32_t getB() const {
+        return b;
+    }
+
+    // Слабы целиком, таблица ключей и описания групп.
+    size_t getMemoryUsage() const {
+        return slabs.size() * HLL_GROUP_SLAB_WORDS * sizeof(uint32_t) +
+               map.size() * sizeof(MapSlot) + groups.capacity() * sizeof(Group);
+    }
+};
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef HLL_HISTOGRAM_H
+#define HLL_HISTOGRAM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+constexpr size_t HLL_HISTOGRAM_SIZE = 64;
+
+inline constexpr std::array<double, HLL_HISTOGRAM_SIZE> HLL_INV_POW2 = [] {
+    std::array<double, HLL_HISTOGRAM_SIZE> table{};
+    double value = 1.0;
+    for (size_t k = 0; k < table.size(); ++k) {
+        table[k] = value;
+        value /= 2;
+    }
+    return table;
+}();
+
+// Поправочный коэффициент alpha_m оценки HyperLogLog для m регистров.
+constexpr double hllAlphaM(uint32_t m) {
+    if (m == 16) return 0.673;
+    if (m == 32) return 0.697;
+    if (m == 64) return 0.709;
+    return 0.7213 / (1.0 + 1.079 / m);
+}
+
+// Гистограмма значений регистров: counts[k] — число регистров, равных k.
+// Поддерживается в add(), поэтому сумма 2^-M[i] и число нулей считаются за O(q).
+// Для 32-битного хеша слагаемые кратны 2^-(33-b), а сумма не больше m = 2^b, то есть
+// укладывается в 33 бита мантиссы: double считает её точно при любом порядке.
+struct HllHistogram {
+    std::array<uint32_t, HLL_HISTOGRAM_SIZE> counts{};
+
+    void reset(uint32_t m) {
+        counts.fill(0);
+        counts[0] = m;
+    }
+
+    void update(uint8_t old_val, uint8_t new_val) {
+        --counts[old_val];
+        ++counts[new_val];
+    }
+
+    uint32_t zeros() const {
+        return counts[0];
+    }
+
+    double harmonicSum() const {
+        double sum = 0.0;
+        for (size_t k = 0; k < HLL_HISTOGRAM_SIZE; ++k) {
+            sum += counts[k] * HLL_INV_POW2[k];
+        }
+        return sum;
+    }
+
+    bool operator==(const HllHistogram&) const = default;
+};
+
+inline HllHistogram hllHistogramOf(const uint8_t* regs, size_t m) {
+    uint32_t partial[4][HLL_HISTOGRAM_SIZE] = {};
+    size_t i = 0;
+    for (; i + 4 <= m; i += 4) {
+        ++partial[0][regs[i]];
+        ++partial[1][regs[i + 1]];
+        ++partial[2][regs[i + 2]];
+        ++partial[3][regs[i + 3]];
+    }
+    for (; i < m; ++i) ++partial[0][regs[i]];
+
+    HllHistogram hist;
+    for (size_t k = 0; k < HLL_HISTOGRAM_SIZE; ++k) {
+        hist.counts[k] = partial[0][k] + partial[1][k] + partial[2][k] + partial[3][k];
+    }
+    return hist;
+}
+
+// Полный пересчёт суммы 2^-M[i] по таблице, для сверки с гистограммой.
+inline double hllHarmonicSumOf(const uint8_t* regs, size_t m) {
+    const double* table = HLL_INV_POW2.data();
+    double sum = 0.0;
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d acc_lo = zero;
+    __m256d acc_hi = zero;
+    for (; i + 8 <= m; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(regs + i));
+        __m256i idx = _mm256_cvtepu8_epi32(bytes);
+        __m128i idx_lo = _mm256_castsi256_si128(idx);
+        __m128i idx_hi = _mm256_extracti128_si256(idx, 1);
+        acc_lo = _mm256_add_pd(acc_lo, _mm256_mask_i32gather_pd(zero, table, idx_lo, all, 8));
+        acc_hi = _mm256_add_pd(acc_hi, _mm256_mask_i32gather_pd(zero, table, idx_hi, all, 8));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(acc_lo, acc_hi));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < m; ++i) sum += table[regs[i]];
+    return sum;
+}
+
+#endif
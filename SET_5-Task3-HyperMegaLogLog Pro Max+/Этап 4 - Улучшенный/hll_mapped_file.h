@@ -0,0 +1,111 @@
+#ifndef HLL_MAPPED_FILE_H
+#define HLL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Файл, отображённый в память только для чтения (mmap или
+// CreateFileMapping/MapViewOfFile). Пустой файл не отображается.
+class HllMappedFile {
+private:
+    const uint8_t* data = nullptr;
+    size_t size_bytes = 0;
+#if defined(_WIN32)
+    HANDLE file_handle = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    HllMappedFile() = default;
+    HllMappedFile(const HllMappedFile&) = delete;
+    HllMappedFile& operator=(const HllMappedFile&) = delete;
+
+    ~HllMappedFile() {
+        close();
+    }
+
+    // sequential подсказывает ядру читать вперёд: для однократного прохода
+    // по большому файлу, а не для случайного доступа.
+    bool open(const std::string& path, bool sequential = false) {
+        close();
+#if defined(_WIN32)
+        (void)sequential;
+        file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            close();
+            return false;
+        }
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size_bytes = static_cast<size_t>(file_size.QuadPart);
+        if (!data) {
+            close();
+            return false;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        data = static_cast<const uint8_t*>(mapped);
+        size_bytes = static_cast<size_t>(st.st_size);
+        if (sequential) madvise(mapped, size_bytes, MADV_SEQUENTIAL);
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file_handle != INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+        mapping = nullptr;
+        file_handle = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), size_bytes);
+#endif
+        data = nullptr;
+        size_bytes = 0;
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    std::span<const uint8_t> bytes() const {
+        return std::span<const uint8_t>(data, size_bytes);
+    }
+
+    size_t size() const {
+        return size_bytes;
+    }
+};
+
+#endif
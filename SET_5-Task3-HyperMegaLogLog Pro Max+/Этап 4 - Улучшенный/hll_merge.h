@@ -0,0 +1,135 @@
+#ifndef HLL_MERGE_H
+#define HLL_MERGE_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "hll_histogram.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Объединение скетчей одной точности: регистр объединения равен максимуму
+// регистров, так что результат не зависит от того, как поток был разбит.
+inline void hllMergeMax(uint8_t* dst, const uint8_t* src, size_t m) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu8(a, b));
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 16 <= m; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_max_epu8(a, b));
+    }
+#endif
+    for (; i < m; ++i) dst[i] = std::max(dst[i], src[i]);
+}
+
+// Если объединение подняло больше чем m / HLL_MERGE_REBUILD_FRACTION
+// регистров, гистограмму дешевле пересчитать целиком, чем обновлять по одному.
+constexpr size_t HLL_MERGE_REBUILD_FRACTION = 64;
+
+// Тот же максимум, но гистограмма dst поправляется в том же проходе: маска
+// сравнения max == dst отмечает байты, которые подняло объединение, и только
+// они идут в hist.update(). Слияние почти совпадающих скетчей стоит почти
+// столько же, сколько сам максимум. Когда поднятых слишком много, остаток
+// сливается без маски и гистограмма пересчитывается по результату.
+inline void hllMergeMax(uint8_t* dst, const uint8_t* src, size_t m, HllHistogram& hist) {
+    size_t budget = m / HLL_MERGE_REBUILD_FRACTION;
+    auto rebuild = [&](size_t from) {
+        hllMergeMax(dst + from, src + from, m - from);
+        hist = hllHistogramOf(dst, m);
+    };
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i max = _mm256_max_epu8(a, b);
+        uint32_t raised = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(max, a)));
+        if (raised != 0) {
+            size_t count = static_cast<size_t>(std::popcount(raised));
+            if (count > budget) return rebuild(i);
+            budget -= count;
+            for (; raised != 0; raised &= raised - 1) {
+                size_t j = i + static_cast<size_t>(std::countr_zero(raised));
+                hist.update(dst[j], src[j]);
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), max);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 16 <= m; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i max = _mm_max_epu8(a, b);
+        uint32_t raised = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(max, a))) & 0xFFFF;
+        if (raised != 0) {
+            size_t count = static_cast<size_t>(std::popcount(raised));
+            if (count > budget) return rebuild(i);
+            budget -= count;
+            for (; raised != 0; raised &= raised - 1) {
+                size_t j = i + static_cast<size_t>(std::countr_zero(raised));
+                hist.update(dst[j], src[j]);
+            }
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), max);
+    }
+#endif
+    for (; i < m; ++i) {
+        if (src[i] > dst[i]) {
+            if (budget == 0) return rebuild(i);
+            --budget;
+            hist.update(dst[i], src[i]);
+            dst[i] = src[i];
+        }
+    }
+}
+
+// То же для упаковки HyperLogLogCompact: по 5 шестибитных регистров в слове
+// (биты 0..29), старшие 2 бита слова всегда нулевые. Каждое поле выделяется
+// сдвигом и маской и сравнивается как 32-битное число.
+constexpr uint32_t HLL_PACKED6_PER_WORD = 5;
+constexpr uint32_t HLL_PACKED6_MASK = 0x3F;
+
+inline uint32_t hllMergePacked6Word(uint32_t a, uint32_t b) {
+    uint32_t result = 0;
+    for (uint32_t k = 0; k < HLL_PACKED6_PER_WORD; ++k) {
+        uint32_t shift = k * 6;
+        uint32_t fa = (a >> shift) & HLL_PACKED6_MASK;
+        uint32_t fb = (b >> shift) & HLL_PACKED6_MASK;
+        result |= std::max(fa, fb) << shift;
+    }
+    return result;
+}
+
+inline void hllMergePacked6(uint32_t* dst, const uint32_t* src, size_t words) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i field = _mm256_set1_epi32(HLL_PACKED6_MASK);
+    for (; i + 8 <= words; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i result = _mm256_setzero_si256();
+        for (int k = 0; k < static_cast<int>(HLL_PACKED6_PER_WORD); ++k) {
+            __m128i shift = _mm_cvtsi32_si128(k * 6);
+            __m256i fa = _mm256_and_si256(_mm256_srl_epi32(a, shift), field);
+            __m256i fb = _mm256_and_si256(_mm256_srl_epi32(b, shift), field);
+            result = _mm256_or_si256(result, _mm256_sll_epi32(_mm256_max_epu32(fa, fb), shift));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), result);
+    }
+#endif
+    for (; i < words; ++i) dst[i] = hllMergePacked6Word(dst[i], src[i]);
+}
+
+#endif
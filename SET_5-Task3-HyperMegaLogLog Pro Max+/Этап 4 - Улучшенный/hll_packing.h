@@ -0,0 +1,513 @@
+#ifndef HLL_PACKING_H
+#define HLL_PACKING_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "hll_batch.h"
+#include "hll_histogram.h"
+#include "hll_merge.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Плотная упаковка шестибитных регистров подряд: регистр i занимает биты
+// [6i, 6i + 6) потока (младшие биты байта — первыми), то есть 4 регистра на
+// 3 байта без пропусков. Адрес — сдвиг и маска, без деления: байт 6i / 8 и
+// сдвиг 6i mod 8. Значение лежит не более чем в двух соседних байтах, поэтому
+// в памяти за потоком держится один байт запаса под 16-битное чтение.
+constexpr uint32_t HLL_BITSTREAM_BITS = 6;
+constexpr uint8_t HLL_BITSTREAM_MASK = 0x3F;
+constexpr size_t HLL_BITSTREAM_PADDING = 1;
+
+inline size_t hllBitstreamBytes(uint32_t m) {
+    return (static_cast<size_t>(m) * HLL_BITSTREAM_BITS + 7) / 8;
+}
+
+// Одно невыровненное 16-битное чтение (little-endian) вместо двух байтовых.
+inline uint8_t hllBitstreamGet(const uint8_t* stream, uint32_t index) {
+    uint32_t bit = index * HLL_BITSTREAM_BITS;
+    uint16_t pair;
+    std::memcpy(&pair, stream + (bit >> 3), sizeof(pair));
+    return static_cast<uint8_t>((pair >> (bit & 7)) & HLL_BITSTREAM_MASK);
+}
+
+inline void hllBitstreamSet(uint8_t* stream, uint32_t index, uint8_t value) {
+    uint32_t bit = index * HLL_BITSTREAM_BITS;
+    uint32_t shift = bit & 7;
+    uint16_t pair;
+    std::memcpy(&pair, stream + (bit >> 3), sizeof(pair));
+    pair = static_cast<uint16_t>((pair & ~(HLL_BITSTREAM_MASK << shift)) | (value << shift));
+    std::memcpy(stream + (bit >> 3), &pair, sizeof(pair));
+}
+
+#if defined(__AVX2__)
+// 24 байта потока -> 32 регистра по байту. Каждая тройка байт раздаётся в свою
+// 32-битную ячейку, после чего четыре поля сдвигаются на границы байт.
+inline __m256i hllUnpack32(const uint8_t* in) {
+    __m256i raw = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))),
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 16)), 1);
+    raw = _mm256_permutevar8x32_epi32(raw, _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0));
+    const __m256i spread = _mm256_setr_epi8(
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+        0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    __m256i v = _mm256_shuffle_epi8(raw, spread);
+    __m256i r0 = _mm256_and_si256(v, _mm256_set1_epi32(0x3F));
+    __m256i r1 = _mm256_and_si256(_mm256_slli_epi32(v, 2), _mm256_set1_epi32(0x3F00));
+    __m256i r2 = _mm256_and_si256(_mm256_slli_epi32(v, 4), _mm256_set1_epi32(0x3F0000));
+    __m256i r3 = _mm256_and_si256(_mm256_slli_epi32(v, 6), _mm256_set1_epi32(0x3F000000));
+    return _mm256_or_si256(_mm256_or_si256(r0, r1), _mm256_or_si256(r2, r3));
+}
+
+// 32 регистра -> 24 байта потока: пары и четвёрки регистров складываются
+// умножением со сложением (maddubs/madd), затем тройки байт сдвигаются вплотную.
+inline void hllPack32(__m256i regs, uint8_t* out) {
+    __m256i pairs = _mm256_maddubs_epi16(regs, _mm256_set1_epi16(0x4001));
+    __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x10000001));
+    const __m256i squeeze = _mm256_setr_epi8(
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    __m256i packed = _mm256_shuffle_epi8(quads, squeeze);
+    packed = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16), _mm256_extracti128_si256(packed, 1));
+}
+#endif
+
+// Распаковка и обратная упаковка целого потока. m кратно 4 (m = 2^b, b >= 2),
+// хвост обрабатывается тройками байт, так что за пределы потока чтения нет —
+// функции работают и с записью внутри отображённого файла.
+inline void hllUnpackBitstream6(const uint8_t* in, uint8_t* out, uint32_t m) {
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), hllUnpack32(in + i / 4 * 3));
+    }
+#endif
+    for (; i < m; i += 4) {
+        const uint8_t* p = in + i / 4 * 3;
+        uint32_t group = p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+        for (uint32_t k = 0; k < 4; ++k) {
+            out[i + k] = static_cast<uint8_t>((group >> (k * HLL_BITSTREAM_BITS)) & HLL_BITSTREAM_MASK);
+        }
+    }
+}
+
+inline void hllPackBitstream6(const uint8_t* regs, uint8_t* out, uint32_t m) {
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        hllPack32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(regs + i)), out + i / 4 * 3);
+    }
+#endif
+    for (; i < m; i += 4) {
+        uint32_t group = 0;
+        for (uint32_t k = 0; k < 4; ++k) {
+            group |= static_cast<uint32_t>(regs[i + k]) << (k * HLL_BITSTREAM_BITS);
+        }
+        uint8_t* p = out + i / 4 * 3;
+        p[0] = static_cast<uint8_t>(group);
+        p[1] = static_cast<uint8_t>(group >> 8);
+        p[2] = static_cast<uint8_t>(group >> 16);
+    }
+}
+
+// Поэлементный максимум двух потоков: 32 регистра распаковываются,
+// сравниваются одной max_epu8 и упаковываются обратно, не покидая регистров.
+inline void hllMergeBitstream6(uint8_t* dst, const uint8_t* src, uint32_t m) {
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        size_t offset = i / 4 * 3;
+        hllPack32(_mm256_max_epu8(hllUnpack32(dst + offset), hllUnpack32(src + offset)), dst + offset);
+    }
+#endif
+    uint8_t a[4], b[4];
+    for (; i < m; i += 4) {
+        size_t offset = i / 4 * 3;
+        hllUnpackBitstream6(dst + offset, a, 4);
+        hllUnpackBitstream6(src + offset, b, 4);
+        for (uint32_t k = 0; k < 4; ++k) a[k] = std::max(a[k], b[k]);
+        hllPackBitstream6(a, dst + offset, 4);
+    }
+}
+
+// Гистограмма прямо по потоку: распаковка блоками в буфер на стеке.
+inline HllHistogram hllBitstreamHistogram(const uint8_t* in, uint32_t m) {
+    const uint32_t BLOCK = 256;
+    uint8_t regs[BLOCK];
+    HllHistogram hist;
+    for (uint32_t i = 0; i < m; i += BLOCK) {
+        uint32_t n = std::min(BLOCK, m - i);
+        hllUnpackBitstream6(in + i / 4 * 3, regs, n);
+        HllHistogram part = hllHistogramOf(regs, n);
+        for (size_t k = 0; k < HLL_HISTOGRAM_SIZE; ++k) hist.counts[k] += part.counts[k];
+    }
+    return hist;
+}
+
+// То же с поправкой гистограммы dst по поднятым регистрам и с тем же
+// переходом к полному пересчёту, что у hllMergeMax с гистограммой (hll_merge.h).
+inline void hllMergeBitstream6(uint8_t* dst, const uint8_t* src, uint32_t m, HllHistogram& hist) {
+    uint32_t budget = m / HLL_MERGE_REBUILD_FRACTION;
+    auto rebuild = [&](uint32_t from) {
+        size_t offset = from / 4 * 3;
+        hllMergeBitstream6(dst + offset, src + offset, m - from);
+        hist = hllBitstreamHistogram(dst, m);
+    };
+    uint32_t i = 0;
+    uint8_t a[32], b[32];
+#if defined(__AVX2__)
+    for (; i + 32 <= m; i += 32) {
+        size_t offset = i / 4 * 3;
+        __m256i ua = hllUnpack32(dst + offset);
+        __m256i ub = hllUnpack32(src + offset);
+        __m256i max = _mm256_max_epu8(ua, ub);
+        uint32_t raised = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(max, ua)));
+        if (raised == 0) continue;
+        uint32_t count = static_cast<uint32_t>(std::popcount(raised));
+        if (count > budget) return rebuild(i);
+        budget -= count;
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(a), ua);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(b), ub);
+        for (; raised != 0; raised &= raised - 1) {
+            int k = std::countr_zero(raised);
+            hist.update(a[k], b[k]);
+        }
+        hllPack32(max, dst + offset);
+    }
+#endif
+    for (; i < m; i += 4) {
+        size_t offset = i / 4 * 3;
+        hllUnpackBitstream6(dst + offset, a, 4);
+        hllUnpackBitstream6(src + offset, b, 4);
+        for (uint32_t k = 0; k < 4; ++k) {
+            if (b[k] <= a[k]) continue;
+            if (budget == 0) return rebuild(i);
+            --budget;
+            hist.update(a[k], b[k]);
+            a[k] = b[k];
+        }
+        hllPackBitstream6(a, dst + offset, 4);
+    }
+}
+
+// Хранилища регистров с общим интерфейсом, для сравнения упаковок.
+// prefetch есть только там, где адрес регистра вычисляется без чтения.
+//
+// HllByteRegisters и HllBitstream6Registers — ещё и хранилища скетчей
+// (hll_register_sketch.h), поэтому у них есть и то, что нужно записи
+// hll_format.h: регистры лежат в её раскладке (data()), MAX_VALUE — верхняя
+// граница значения, payloadBytes(m) — размер регистров без запаса.
+
+// Байт на регистр, как у HyperLogLog.
+class HllByteRegisters {
+private:
+    std::vector<uint8_t> regs;
+
+public:
+    static constexpr uint8_t MAX_VALUE = 0xFF;
+
+    static size_t payloadBytes(uint32_t m) {
+        return m;
+    }
+
+    static HllHistogram histogramOf(const uint8_t* payload, uint32_t m) {
+        return hllHistogramOf(payload, m);
+    }
+
+    void reset(uint32_t m) {
+        regs.assign(m, 0);
+    }
+
+    // Освобождает память; до reset() регистров нет.
+    void release() {
+        regs.clear();
+        regs.shrink_to_fit();
+    }
+
+    const uint8_t* data() const {
+        return regs.data();
+    }
+
+    uint8_t* data() {
+        return regs.data();
+    }
+
+    uint8_t get(uint32_t index) const {
+        return regs[index];
+    }
+
+    void set(uint32_t index, uint8_t value) {
+        regs[index] = value;
+    }
+
+    void prefetch(uint32_t index) const {
+        hllPrefetch(regs.data() + index);
+    }
+
+    void unpack(uint8_t* out, uint32_t m) const {
+        std::memcpy(out, regs.data(), m);
+    }
+
+    // Регистры по байту, как в unpack().
+    void load(const uint8_t* values, uint32_t m) {
+        std::memcpy(regs.data(), values, m);
+    }
+
+    void merge(const HllByteRegisters& other, uint32_t m) {
+        hllMergeMax(regs.data(), other.regs.data(), m);
+    }
+
+    // Максимум с регистрами в раскладке data() с поправкой гистограммы.
+    void merge(const uint8_t* payload, uint32_t m, HllHistogram& hist) {
+        hllMergeMax(regs.data(), payload, m, hist);
+    }
+
+    size_t getMemoryUsage() const {
+        return regs.size();
+    }
+};
+
+// Прежняя упаковка HyperLogLogCompact: 5 регистров в uint32_t, 2 бита пропадают.
+class HllPacked5Registers {
+private:
+    std::vector<uint32_t> words;
+
+public:
+    void reset(uint32_t m) {
+        words.assign((m + HLL_PACKED6_PER_WORD - 1) / HLL_PACKED6_PER_WORD, 0);
+    }
+
+    uint8_t get(uint32_t index) const {
+        return (words[index / HLL_PACKED6_PER_WORD] >> (index % HLL_PACKED6_PER_WORD * 6)) & HLL_PACKED6_MASK;
+    }
+
+    void set(uint32_t index, uint8_t value) {
+        uint32_t shift = index % HLL_PACKED6_PER_WORD * 6;
+        uint32_t& word = words[index / HLL_PACKED6_PER_WORD];
+        word = (word & ~(HLL_PACKED6_MASK << shift)) | (static_cast<uint32_t>(value) << shift);
+    }
+
+    void unpack(uint8_t* out, uint32_t m) const {
+        for (uint32_t i = 0; i < m; ++i) out[i] = get(i);
+    }
+
+    void merge(const HllPacked5Registers& other, uint32_t) {
+        hllMergePacked6(words.data(), other.words.data(), words.size());
+    }
+
+    size_t getMemoryUsage() const {
+        return words.size() * sizeof(uint32_t);
+    }
+};
+
+class HllBitstream6Registers {
+private:
+    std::vector<uint8_t> stream;
+
+public:
+    static constexpr uint8_t MAX_VALUE = HLL_BITSTREAM_MASK;
+
+    static size_t payloadBytes(uint32_t m) {
+        return hllBitstreamBytes(m);
+    }
+
+    static HllHistogram histogramOf(const uint8_t* payload, uint32_t m) {
+        return hllBitstreamHistogram(payload, m);
+    }
+
+    void reset(uint32_t m) {
+        stream.assign(hllBitstreamBytes(m) + HLL_BITSTREAM_PADDING, 0);
+    }
+
+    void release() {
+        stream.clear();
+        stream.shrink_to_fit();
+    }
+
+    const uint8_t* data() const {
+        return stream.data();
+    }
+
+    uint8_t* data() {
+        return stream.data();
+    }
+
+    uint8_t get(uint32_t index) const {
+        return hllBitstreamGet(stream.data(), index);
+    }
+
+    void set(uint32_t index, uint8_t value) {
+        hllBitstreamSet(stream.data(), index, value);
+    }
+
+    void prefetch(uint32_t index) const {
+        hllPrefetch(stream.data() + (index * HLL_BITSTREAM_BITS >> 3));
+    }
+
+    void unpack(uint8_t* out, uint32_t m) const {
+        hllUnpackBitstream6(stream.data(), out, m);
+    }
+
+    void load(const uint8_t* values, uint32_t m) {
+        hllPackBitstream6(values, stream.data(), m);
+    }
+
+    void merge(const HllBitstream6Registers& other, uint32_t m) {
+        hllMergeBitstream6(stream.data(), other.stream.data(), m);
+    }
+
+    void merge(const uint8_t* payload, uint32_t m, HllHistogram& hist) {
+        hllMergeBitstream6(stream.data(), payload, m, hist);
+    }
+
+    size_t getMemoryUsage() const {
+        return stream.size();
+    }
+};
+
+// Четырёхбитные смещения от общей базы (в духе HLL-TailCut): регистр равен
+// base + offset. Смещение 15 означает, что точное значение лежит в списке
+// переполнений. Когда ни одного регистра не остаётся на базе, база растёт и
+// смещения уменьшаются; почти все регистры лежат в [base, base + 14], так что
+// список переполнений почти всегда пуст и представление остаётся точным.
+class HllTailCutRegisters {
+private:
+    static constexpr uint8_t OVERFLOW_OFFSET = 15;
+
+    std::vector<uint8_t> nibbles;
+    // Отсортированы по индексу: (index << 8) | value.
+    std::vector<uint32_t> overflow;
+    uint8_t base = 0;
+    uint32_t at_base = 0;
+    uint32_t m = 0;
+
+    uint8_t offset(uint32_t index) const {
+        return (nibbles[index >> 1] >> ((index & 1) * 4)) & 0x0F;
+    }
+
+    void setOffset(uint32_t index, uint8_t value) {
+        uint32_t shift = (index & 1) * 4;
+        uint8_t& byte = nibbles[index >> 1];
+        byte = static_cast<uint8_t>((byte & ~(0x0F << shift)) | (value << shift));
+    }
+
+    std::vector<uint32_t>::const_iterator findOverflow(uint32_t index) const {
+        return std::lower_bound(overflow.begin(), overflow.end(), index << 8);
+    }
+
+    void rebase() {
+        while (at_base == 0) {
+            ++base;
+            for (uint32_t i = 0; i < m; ++i) {
+                uint8_t off = offset(i);
+                if (off != OVERFLOW_OFFSET) {
+                    setOffset(i, off - 1);
+                    at_base += off == 1;
+                }
+            }
+            std::vector<uint32_t> kept;
+            for (uint32_t entry : overflow) {
+                uint8_t value = static_cast<uint8_t>(entry);
+                if (value - base < OVERFLOW_OFFSET) {
+                    setOffset(entry >> 8, static_cast<uint8_t>(value - base));
+                    at_base += value == base;
+                } else {
+                    kept.push_back(entry);
+                }
+            }
+            overflow.swap(kept);
+        }
+    }
+
+public:
+    void reset(uint32_t m_registers) {
+        m = m_registers;
+        nibbles.assign((m + 1) / 2, 0);
+        overflow.clear();
+        base = 0;
+        at_base = m;
+    }
+
+    uint8_t get(uint32_t index) const {
+        uint8_t off = offset(index);
+        if (off != OVERFLOW_OFFSET) return base + off;
+        return static_cast<uint8_t>(*findOverflow(index));
+    }
+
+    // Регистры только растут: value должно быть больше get(index).
+    void set(uint32_t index, uint8_t value) {
+        uint8_t old_off = offset(index);
+        if (value - base >= OVERFLOW_OFFSET) {
+            auto it = findOverflow(index);
+            if (old_off == OVERFLOW_OFFSET) {
+                overflow[it - overflow.begin()] = (index << 8) | value;
+            } else {
+                overflow.insert(it, (index << 8) | value);
+                setOffset(index, OVERFLOW_OFFSET);
+            }
+        } else {
+            setOffset(index, static_cast<uint8_t>(value - base));
+        }
+        if (old_off == 0 && --at_base == 0) rebase();
+    }
+
+    void unpack(uint8_t* out, uint32_t count) const {
+        uint32_t i = 0;
+#if defined(__SSE2__)
+        const __m128i low = _mm_set1_epi8(0x0F);
+        const __m128i add = _mm_set1_epi8(static_cast<char>(base));
+        for (; i + 32 <= count; i += 32) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.data() + i / 2));
+            __m128i lo = _mm_and_si128(v, low);
+            __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), low);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi8(_mm_unpacklo_epi8(lo, hi), add));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16), _mm_add_epi8(_mm_unpackhi_epi8(lo, hi), add));
+        }
+#endif
+        for (; i < count; ++i) out[i] = base + offset(i);
+        for (uint32_t entry : overflow) {
+            if ((entry >> 8) < count) out[entry >> 8] = static_cast<uint8_t>(entry);
+        }
+    }
+
+    // Перестраивает представление по распакованным регистрам.
+    void assign(const uint8_t* regs) {
+        base = *std::min_element(regs, regs + m);
+        at_base = 0;
+        overflow.clear();
+        for (uint32_t i = 0; i < m; ++i) {
+            uint8_t off = regs[i] - base;
+            if (off >= OVERFLOW_OFFSET) {
+                overflow.push_back((i << 8) | regs[i]);
+                off = OVERFLOW_OFFSET;
+            }
+            at_base += off == 0;
+            setOffset(i, off);
+        }
+    }
+
+    void merge(const HllTailCutRegisters& other, uint32_t) {
+        std::vector<uint8_t> a(m), b(m);
+        unpack(a.data(), m);
+        other.unpack(b.data(), m);
+        hllMergeMax(a.data(), b.data(), m);
+        assign(a.data());
+    }
+
+    size_t getOverflowCount() const {
+        return overflow.size();
+    }
+
+    size_t getMemoryUsage() const {
+        return nibbles.size() + overflow.size() * sizeof(uint32_t) + sizeof(base);
+    }
+};
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef HLL_PIPELINE_H
+#define HLL_PIPELINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+#include "hash_function.h"
+
+// Конвейер подсчёта различных строк файла: чтение -> хеширование -> скетч.
+// Стадии связаны очередями ограниченной длины, так что в памяти одновременно
+// не больше (глубина очередей) кусков входа, сколько бы гигабайт ни было в
+// файле. Строки не копируются в std::string: хешер режет кусок по '\n' и
+// хеширует байты прямо из отображения (или из буфера чтения для stdin).
+// Пустые строки пропускаются, завершающий '\r' отбрасывается.
+
+template <class T>
+class HllBoundedQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+public:
+    explicit HllBoundedQueue(size_t max_items) : capacity(std::max<size_t>(1, max_items)) {}
+
+    // Блокируется, пока очередь полна.
+    void push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return items.size() < capacity; });
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+    }
+
+    // nullopt — очередь закрыта и опустела.
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return !items.empty() || closed; });
+        if (items.empty()) return std::nullopt;
+        T item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return item;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+    }
+};
+
+// Кусок входа из целых строк. Для отображённого файла — взгляд без копии,
+// для потока — буфер чтения, которым кусок владеет.
+struct HllLineChunk {
+    const char* data = nullptr;
+    size_t size = 0;
+    std::vector<char> storage;
+};
+
+struct HllHashBatch {
+    std::vector<uint32_t> hashes;
+    size_t bytes = 0;
+};
+
+struct HllPipelineOptions {
+    size_t chunk_bytes = size_t(4) << 20;
+    size_t queue_depth = 8;
+    unsigned hasher_threads = 1;
+};
+
+struct HllPipelineStats {
+    uint64_t lines = 0;
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+
+    double linesPerSecond() const {
+        return seconds > 0 ? lines / seconds : 0.0;
+    }
+
+    double gigabytesPerSecond() const {
+        return seconds > 0 ? bytes / seconds / 1e9 : 0.0;
+    }
+};
+
+// Режет отображённый файл на куски примерно по chunk_bytes, продлевая каждый
+// до ближайшего '\n'.
+template <class Emit>
+void hllSplitMapped(std::span<const uint8_t> file, size_t chunk_bytes, Emit&& emit) {
+    const char* data = reinterpret_cast<const char*>(file.data());
+    size_t pos = 0;
+    while (pos < file.size()) {
+        size_t end = std::min(file.size(), pos + chunk_bytes);
+        if (end < file.size()) {
+            const void* newline = std::memchr(data + end, '\n', file.size() - end);
+            end = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) + 1 : file.size();
+        }
+        HllLineChunk chunk;
+        chunk.data = data + pos;
+        chunk.size = end - pos;
+        emit(std::move(chunk));
+        pos = end;
+    }
+}
+
+// Читает поток большими блоками; неполная последняя строка блока переносится
+// в начало следующего (строка длиннее блока копится, пока не встретится '\n').
+template <class Emit>
+void hllSplitStream(std::FILE* input, size_t chunk_bytes, Emit&& emit) {
+    std::vector<char> carry;
+    while (true) {
+        HllLineChunk chunk;
+        chunk.storage.resize(carry.size() + chunk_bytes);
+        std::memcpy(chunk.storage.data(), carry.data(), carry.size());
+        size_t got = std::fread(chunk.storage.data() + carry.size(), 1, chunk_bytes, input);
+        size_t filled = carry.size() + got;
+        carry.clear();
+        if (filled == 0) break;
+
+        size_t end = filled;
+        if (got != 0) {
+            const char* base = chunk.storage.data();
+            size_t last = filled;
+            while (last > 0 && base[last - 1] != '\n') --last;
+            carry.assign(base + last, base + filled);
+            if (last == 0) continue;
+            end = last;
+        }
+        chunk.storage.resize(end);
+        chunk.data = chunk.storage.data();
+        chunk.size = end;
+        emit(std::move(chunk));
+        if (got == 0) break;
+    }
+}
+
+template <class F>
+void hllForEachLine(const char* data, size_t size, F&& f) {
+    const char* end = data + size;
+    while (data < end) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        const char* line_end = newline ? newline : end;
+        size_t len = line_end - data;
+        if (len > 0 && data[len - 1] == '\r') --len;
+        if (len > 0) f(data, len);
+        data = newline ? newline + 1 : end;
+    }
+}
+
+// Запускает конвейер: read(emit) в отдельном потоке выдаёт куски, hasher_threads
+// потоков хешируют строки, вызывающий поток добавляет хеши в скетч.
+template <class Sketch, class Reader>
+HllPipelineStats hllRunLinePipeline(Reader&& read, const HashFuncGen& hash_gen, Sketch& sketch,
+                                    const HllPipelineOptions& options = {}) {
+    HllBoundedQueue<HllLineChunk> chunks(options.queue_depth);
+    HllBoundedQueue<HllHashBatch> batches(options.queue_depth);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::thread reader([&] {
+        read([&](HllLineChunk chunk) { chunks.push(std::move(chunk)); });
+        chunks.close();
+    });
+
+    unsigned hasher_count = std::max(1u, options.hasher_threads);
+    std::vector<std::thread> hashers;
+    std::mutex done_mutex;
+    unsigned running = hasher_count;
+    for (unsigned t = 0; t < hasher_count; ++t) {
+        hashers.emplace_back([&] {
+            while (std::optional<HllLineChunk> chunk = chunks.pop()) {
+                HllHashBatch batch;
+                batch.bytes = chunk->size;
+                hllForEachLine(chunk->data, chunk->size, [&](const char* line, size_t len) {
+                    batch.hashes.push_back(hash_gen.hash(line, len));
+                });
+                batches.push(std::move(batch));
+            }
+            std::lock_guard<std::mutex> lock(done_mutex);
+            if (--running == 0) batches.close();
+        });
+    }
+
+    HllPipelineStats stats;
+    while (std::optional<HllHashBatch> batch = batches.pop()) {
+        sketch.addBatch(batch->hashes);
+        stats.lines += batch->hashes.size();
+        stats.bytes += batch->bytes;
+    }
+
+    reader.join();
+    for (auto& h : hashers) h.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    stats.seconds = std::chrono::duration<double>(end - start).count();
+    return stats;
+}
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef HLL_REGISTER_SKETCH_H
+#define HLL_REGISTER_SKETCH_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <optional>
+#include "hll_batch.h"
+#include "hll_checkpoint.h"
+#include "hll_estimators.h"
+#include "hll_fold.h"
+#include "hll_format.h"
+#include "hll_histogram.h"
+#include "hll_packing.h"
+#include "hll_sparse.h"
+#include "hll_telemetry.h"
+
+// Общая часть скетчей HyperLogLog: регистры в хранилище Storage
+// (HllByteRegisters или HllBitstream6Registers из hll_packing.h), гистограмма
+// регистров, разреженный режим с переводом в плотный, слияние, свёртка и
+// запись. От наследника Derived нужны:
+//   estimateFromHistogram(hist, b) — формула оценки;
+//   HASH_BITS                       — ширина хеша для оценок Эртла, если не 32;
+//   KIND                            — вид записи (hll_format.h), если нужны
+//                                     serialize(), checkpoint() и restore();
+//   Derived(b, start_sparse)        — для fold() и merge() с более точным.
+// add() и addBatch() рассчитаны на 32-битный хеш; 64-битные скетчи
+// (hyperloglog64.h) вставляют сами через updateRegister() и promoteIfFull().
+template <class Derived, class Storage>
+class HllRegisterSketch {
+    template <class, class>
+    friend class HllRegisterSketch;
+
+protected:
+    uint32_t b;
+    uint32_t m;
+    Storage registers;
+    HllHistogram histogram;
+    bool sparse_enabled;
+    bool sparse_mode;
+    // estimate() вливает буфер вставок в список, не меняя сам набор элементов.
+    mutable HllSparseRegisters sparse;
+
+    HllRegisterSketch(uint32_t b_bits, bool start_sparse)
+        : b(b_bits), m(1u << b_bits),
+          sparse_enabled(start_sparse && b_bits <= HLL_SPARSE_PRECISION),
+          sparse_mode(sparse_enabled) {
+        if (!sparse_mode) registers.reset(m);
+        histogram.reset(m);
+    }
+
+public:
+    static constexpr uint32_t HASH_BITS = 32;
+
+    void add(uint32_t hash) {
+        if (sparse_mode) {
+            addSparse(hash);
+            return;
+        }
+        uint32_t j = hash >> (32 - b);
+        uint8_t r = clampRegister(hllRho(hash << b, b));
+        HLL_TELEMETRY_DENSE_ADD(r > registers.get(j), r, b);
+        updateRegister(j, r);
+    }
+
+    void addBatch(std::span<const uint32_t> hashes) {
+        size_t i = 0;
+        while (sparse_mode && i < hashes.size()) addSparse(hashes[i++]);
+        hashes = hashes.subspan(i);
+
+        HLL_TELEMETRY_BATCH(hashes.size());
+        hllForEachBlock(hashes, b, registers.getMemoryUsage() >= HLL_PREFETCH_MIN_BYTES,
+            [this](uint32_t j) { registers.prefetch(j); },
+            [this HLL_TELEMETRY_BATCH_CAPTURE](uint32_t j, uint8_t r) {
+                HLL_TELEMETRY_BATCH_UPDATE(clampRegister(r) > registers.get(j), r, b);
+                updateRegister(j, r);
+            });
+    }
+
+    double estimate() const {
+        if (sparse_mode) {
+            sparse.flush();
+            return sparse.estimate();
+        }
+        return Derived::estimateFromHistogram(histogram, b);
+    }
+
+    // Classic — формула наследника, Improved и MaxLikelihood — оценки Эртла по
+    // той же гистограмме. В разреженном режиме всегда линейный счёт по списку.
+    double estimate(HllEstimator method) const {
+        if (method == HllEstimator::Classic || sparse_mode) return estimate();
+        return hllEstimateFromHistogram(method, histogram, b, Derived::HASH_BITS);
+    }
+
+    // Объединяет с other той же или большей точности (более точный other
+    // сначала сворачивается до b); false, если other менее точен.
+    bool merge(const Derived& other) {
+        const HllRegisterSketch& source = other;
+        if (source.b < b) return false;
+        if (source.b > b) {
+            std::optional<Derived> folded = other.fold(b);
+            return folded && merge(*folded);
+        }
+        mergeSameB(source);
+        return true;
+    }
+
+    // Принимается запись с той же раскладкой регистров: HyperLogLog и
+    // HyperLogLogImproved читают записи друг друга.
+    bool merge(const HllRecordView& record) {
+        if (record.b != b || hllBitstreamKind(record.kind) != hllBitstreamKind(Derived::KIND)) return false;
+        mergeDense(record.payload.data());
+        return true;
+    }
+
+    // Оценка прямо по записи, без копирования регистров.
+    static double estimateRecord(const HllRecordView& record) {
+        return Derived::estimateFromHistogram(
+            Storage::histogramOf(record.payload.data(), record.registerCount()), record.b);
+    }
+
+    // Тот же скетч с точностью target_b из [HLL_FOLD_MIN_B, b] (hll_fold.h).
+    std::optional<Derived> fold(uint32_t target_b) const {
+        if (target_b > b || target_b < HLL_FOLD_MIN_B) return std::nullopt;
+        Derived result(target_b, sparse_enabled);
+        foldInto(result);
+        return result;
+    }
+
+    std::vector<uint8_t> serialize() const {
+        if (!sparse_mode) return hllEncodeRecord(Derived::KIND, b, registers.data());
+        sparse.flush();
+        std::vector<uint8_t> regs(m, 0);
+        sparse.forEachDense(b, [&regs](uint32_t j, uint8_t r) { regs[j] = std::max(regs[j], clampRegister(r)); });
+        Storage dense;
+        dense.reset(m);
+        dense.load(regs.data(), m);
+        return hllEncodeRecord(Derived::KIND, b, dense.data());
+    }
+
+    // Контрольная точка для репликации (hll_checkpoint.h): полная или дельта
+    // от base — прежнего снимка этого же скетча. Пустой вектор, если запись
+    // скетча не проходит HllRecordView::parse (b больше HLL_FORMAT_MAX_B);
+    // restore() такую точку отвергает.
+    std::vector<uint8_t> checkpoint() const {
+        std::vector<uint8_t> record = serialize();
+        std::optional<HllRecordView> view = HllRecordView::parse(record);
+        if (!view) return {};
+        return hllEncodeCheckpoint(*view);
+    }
+
+    // Если запись base не разбирается, получается полная точка.
+    std::vector<uint8_t> checkpoint(const Derived& base) const {
+        std::vector<uint8_t> record = serialize();
+        std::optional<HllRecordView> view = HllRecordView::parse(record);
+        if (!view) return {};
+        std::vector<uint8_t> base_record = base.serialize();
+        std::optional<HllRecordView> base_view = HllRecordView::parse(base_record);
+        return hllEncodeCheckpoint(*view, base_view ? &*base_view : nullptr);
+    }
+
+    // Применяет точку той же точности, дельту — только поверх тех регистров,
+    // с которых она снята. При false регистры не меняются.
+    bool restore(std::span<const uint8_t> bytes) {
+        std::optional<HllCheckpointView> view = HllCheckpointView::parse(bytes);
+        if (!view || view->b != b || hllBitstreamKind(view->kind) != hllBitstreamKind(Derived::KIND)) return false;
+        if (sparse_mode) promote();
+        Storage next;
+        if (view->type == HllCheckpointType::Delta) {
+            next = registers;
+        } else {
+            next.reset(m);
+        }
+        if (!hllDecodeCheckpoint(*view, next.data())) return false;
+        registers = std::move(next);
+        histogram = Storage::histogramOf(registers.data(), m);
+        return true;
+    }
+
+    static std::optional<Derived> deserialize(std::span<const uint8_t> bytes) {
+        std::optional<HllRecordView> record = HllRecordView::parse(bytes);
+        if (!record) return std::nullopt;
+        Derived sketch(record->b);
+        if (!sketch.merge(*record)) return std::nullopt;
+        return sketch;
+    }
+
+    void reset() {
+        if (sparse_enabled) {
+            registers.release();
+            sparse.clear();
+            sparse_mode = true;
+        } else {
+            registers.reset(m);
+        }
+        histogram.reset(m);
+    }
+
+    bool isSparse() const {
+        return sparse_mode;
+    }
+
+    uint32_t getB() const {
+        return b;
+    }
+
+    const HllHistogram& getHistogram() const {
+        return histogram;
+    }
+
+    size_t getMemoryUsage() const {
+        return sparse_mode ? sparse.getMemoryUsage() : registers.getMemoryUsage();
+    }
+
+    bool validateHistogram() const {
+        if (sparse_mode) return true;
+        std::vector<uint8_t> regs(m);
+        registers.unpack(regs.data(), m);
+        return hllHistogramOf(regs.data(), m) == histogram &&
+               hllHarmonicSumOf(regs.data(), m) == histogram.harmonicSum();
+    }
+
+protected:
+    static uint8_t clampRegister(uint8_t r) {
+        if constexpr (Storage::MAX_VALUE < 0xFF) return std::min(r, Storage::MAX_VALUE);
+        return r;
+    }
+
+    void addSparse(uint32_t hash) {
+        uint32_t index = hash >> (32 - HLL_SPARSE_PRECISION);
+        sparse.add(index, hllRho(hash << HLL_SPARSE_PRECISION, HLL_SPARSE_PRECISION));
+        HLL_TELEMETRY_ADD(HllCounter::SparseAdds);
+        promoteIfFull();
+    }
+
+    // Список пар (индекс, rho) не должен занимать больше плотных регистров.
+    void promoteIfFull() {
+        if (sparse.getMemoryUsage() >= Storage::payloadBytes(m)) promote();
+    }
+
+    void promote() {
+        sparse.flush();
+        registers.reset(m);
+        histogram.reset(m);
+        sparse.forEachDense(b, [this](uint32_t j, uint8_t r) { updateRegister(j, r); });
+        sparse.clear();
+        sparse_mode = false;
+        HLL_TELEMETRY_ADD(HllCounter::Promotions);
+    }
+
+    void updateRegister(uint32_t j, uint8_t r) {
+        r = clampRegister(r);
+        uint8_t old_val = registers.get(j);
+        if (r > old_val) {
+            histogram.update(old_val, r);
+            registers.set(j, r);
+        }
+    }
+
+    // Регистры в раскладке Storage::data(): сливаются блоками (hll_merge.h,
+    // hll_packing.h), гистограмма поправляется только по поднявшимся.
+    void mergeDense(const uint8_t* payload) {
+        if (sparse_mode) promote();
+        registers.merge(payload, m, histogram);
+    }
+
+    void mergeSameB(const HllRegisterSketch& other) {
+        if (other.sparse_mode) {
+            other.sparse.flush();
+            if (sparse_mode) {
+                sparse.merge(other.sparse);
+                promoteIfFull();
+            } else {
+                other.sparse.forEachDense(b, [this](uint32_t j, uint8_t r) { updateRegister(j, r); });
+            }
+            return;
+        }
+        mergeDense(other.registers.data());
+    }
+
+    // Сворачивает в result — свежий скетч меньшей точности. Разреженный список
+    // хранит индексы с точностью HLL_SPARSE_PRECISION и переносится как есть;
+    // плотные регистры распаковываются, сворачиваются с верхней границей
+    // Storage::MAX_VALUE и упаковываются обратно.
+    template <class Folded>
+    void foldInto(HllRegisterSketch<Folded, Storage>& result) const {
+        if (sparse_mode) {
+            sparse.flush();
+            result.sparse = sparse;
+            result.promoteIfFull();
+            return;
+        }
+        std::vector<uint8_t> regs(m);
+        std::vector<uint8_t> folded(result.m);
+        registers.unpack(regs.data(), m);
+        hllFoldRegisters(regs.data(), b, result.b, folded.data(), Storage::MAX_VALUE);
+        result.sparse_mode = false;
+        result.registers.reset(result.m);
+        result.registers.load(folded.data(), result.m);
+        result.histogram = hllHistogramOf(folded.data(), result.m);
+    }
+};
+
+#endif
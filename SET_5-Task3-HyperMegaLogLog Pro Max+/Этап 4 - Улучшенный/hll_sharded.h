@@ -0,0 +1,75 @@
+#ifndef HLL_SHARDED_H
+#define HLL_SHARDED_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "hash_function.h"
+
+// Размер порции, которую поток хеширует в локальный буфер перед addBatch():
+// буфер остаётся в L1, а пакетная вставка получает достаточно длинный отрезок.
+constexpr size_t HLL_SHARD_CHUNK = 4096;
+
+// Каждый поток пишет только в свой скетч. Выравнивание по строке кэша не даёт
+// соседним скетчам делить строку с их полями-счётчиками (гистограммой).
+template <class Sketch>
+struct alignas(64) HllShard {
+    Sketch sketch;
+
+    explicit HllShard(uint32_t b) : sketch(b) {}
+};
+
+// Делит [0, n) на num_threads почти равных отрезков, заполняет по скетчу на
+// отрезок (нулевой — в вызывающем потоке) и сливает их в один.
+// fill(sketch, begin, end) вызывается ровно один раз для каждого отрезка.
+template <class Sketch, class Fill>
+Sketch hllShardedBuild(size_t n, uint32_t b, size_t num_threads, Fill&& fill) {
+    num_threads = std::max<size_t>(1, std::min(num_threads, n));
+    std::vector<HllShard<Sketch>> shards;
+    shards.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) shards.emplace_back(b);
+
+    auto bounds = [n, num_threads](size_t t) { return n * t / num_threads; };
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; ++t) {
+        workers.emplace_back([&, t] { fill(shards[t].sketch, bounds(t), bounds(t + 1)); });
+    }
+    fill(shards[0].sketch, bounds(0), bounds(1));
+    for (auto& worker : workers) worker.join();
+
+    for (size_t t = 1; t < num_threads; ++t) shards[0].sketch.merge(shards[t].sketch);
+    return std::move(shards[0].sketch);
+}
+
+// Поток уже посчитанных хешей.
+template <class Sketch>
+Sketch hllShardedIngest(std::span<const uint32_t> hashes, uint32_t b, size_t num_threads) {
+    return hllShardedBuild<Sketch>(hashes.size(), b, num_threads,
+        [hashes](Sketch& sketch, size_t begin, size_t end) {
+            sketch.addBatch(hashes.subspan(begin, end - begin));
+        });
+}
+
+// Поток строк: хеширование тоже выполняется в потоках-обработчиках.
+template <class Sketch>
+Sketch hllShardedIngest(std::span<const std::string> stream, const HashFuncGen& hash_func,
+                        uint32_t b, size_t num_threads) {
+    return hllShardedBuild<Sketch>(stream.size(), b, num_threads,
+        [stream, &hash_func](Sketch& sketch, size_t begin, size_t end) {
+            std::vector<uint32_t> hashes(HLL_SHARD_CHUNK);
+            for (size_t chunk = begin; chunk < end; chunk += HLL_SHARD_CHUNK) {
+                size_t count = std::min(HLL_SHARD_CHUNK, end - chunk);
+                for (size_t i = 0; i < count; ++i) {
+                    hashes[i] = hash_func.hash(stream[chunk + i]);
+                }
+                sketch.addBatch(std::span<const uint32_t>(hashes.data(), count));
+            }
+        });
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef HLL_SPARSE_H
+#define HLL_SPARSE_H
+
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Разреженное представление HyperLogLog (как в HyperLogLog++). Пока элементов
+// мало, вместо m регистров хранятся пары (индекс, rho) с повышенной точностью
+// HLL_SPARSE_PRECISION: отсортированный список в виде varint-дельт и небольшой
+// неотсортированный буфер вставок, который вливается в список при заполнении.
+constexpr uint32_t HLL_SPARSE_PRECISION = 25;
+constexpr uint32_t HLL_SPARSE_RHO_BITS = 6;
+constexpr size_t HLL_SPARSE_MIN_LOG = 16;
+
+class HllSparseRegisters {
+private:
+    std::vector<uint8_t> encoded;
+    std::vector<uint32_t> log;
+    uint32_t count = 0;
+
+    static void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static uint32_t getVarint(const uint8_t*& p) {
+        uint32_t value = 0;
+        int shift = 0;
+        while (*p & 0x80) {
+            value |= static_cast<uint32_t>(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        value |= static_cast<uint32_t>(*p++) << shift;
+        return value;
+    }
+
+    size_t logLimit() const {
+        return std::max<size_t>(HLL_SPARSE_MIN_LOG, count / 4);
+    }
+
+    template <class F>
+    void forEachEncoded(F&& f) const {
+        const uint8_t* p = encoded.data();
+        const uint8_t* end = p + encoded.size();
+        uint32_t entry = 0;
+        while (p < end) {
+            entry += getVarint(p);
+            f(entry);
+        }
+    }
+
+public:
+    // Элемент списка: индекс из HLL_SPARSE_PRECISION старших бит хеша и rho
+    // оставшихся бит. Упорядочены по индексу, поэтому дельты положительны.
+    static uint32_t makeEntry(uint32_t index, uint8_t rho) {
+        return (index << HLL_SPARSE_RHO_BITS) | rho;
+    }
+
+    void add(uint32_t index, uint8_t rho) {
+        log.push_back(makeEntry(index, rho));
+        if (log.size() >= logLimit()) flush();
+    }
+
+    void flush() {
+        if (log.empty()) return;
+        std::sort(log.begin(), log.end());
+
+        std::vector<uint32_t> merged;
+        merged.reserve(count + log.size());
+        auto push = [&merged](uint32_t entry) {
+            if (!merged.empty() &&
+                (merged.back() >> HLL_SPARSE_RHO_BITS) == (entry >> HLL_SPARSE_RHO_BITS)) {
+                merged.back() = std::max(merged.back(), entry);
+            } else {
+                merged.push_back(entry);
+            }
+        };
+
+        size_t i = 0;
+        forEachEncoded([&](uint32_t entry) {
+            while (i < log.size() && log[i] < entry) push(log[i++]);
+            push(entry);
+        });
+        while (i < log.size()) push(log[i++]);
+
+        std::vector<uint8_t> reencoded;
+        reencoded.reserve(merged.size() * 2);
+        uint32_t prev = 0;
+        for (uint32_t entry : merged) {
+            putVarint(reencoded, entry - prev);
+            prev = entry;
+        }
+        encoded.swap(reencoded);
+        encoded.shrink_to_fit();
+        count = static_cast<uint32_t>(merged.size());
+        log.clear();
+    }
+
+    // Объединение: элементы other попадают в буфер вставок, а flush() оставляет
+    // для каждого индекса максимальный rho.
+    void merge(const HllSparseRegisters& other) {
+        if (&other == this) return;
+        log.reserve(log.size() + other.count + other.log.size());
+        other.forEachEncoded([this](uint32_t entry) { log.push_back(entry); });
+        log.insert(log.end(), other.log.begin(), other.log.end());
+        flush();
+    }
+
+    // Число различных индексов; вызывать после flush().
+    uint32_t size() const {
+        return count;
+    }
+
+    // Линейный счёт по 2^HLL_SPARSE_PRECISION виртуальных регистров.
+    double estimate() const {
+        double m_sparse = static_cast<double>(1ull << HLL_SPARSE_PRECISION);
+        return m_sparse * std::log(m_sparse / (m_sparse - count));
+    }
+
+    // Переводит элементы в регистры плотного скетча с b битами индекса:
+    // f(j, rho) вызывается для каждого элемента, rho совпадает с тем, что дал бы add().
+    template <class F>
+    void forEachDense(uint32_t b, F&& f) const {
+        const uint32_t shift = HLL_SPARSE_PRECISION - b;
+        const uint32_t mid_mask = (1u << shift) - 1;
+        forEachEncoded([&](uint32_t entry) {
+            uint32_t index = entry >> HLL_SPARSE_RHO_BITS;
+            uint8_t rho = static_cast<uint8_t>(entry & ((1u << HLL_SPARSE_RHO_BITS) - 1));
+            uint32_t mid = index & mid_mask;
+            uint8_t dense_rho = mid != 0
+                ? static_cast<uint8_t>(std::countl_zero(mid) - (32 - shift) + 1)
+                : static_cast<uint8_t>(shift + rho);
+            f(index >> shift, dense_rho);
+        });
+    }
+
+    void clear() {
+        encoded.clear();
+        encoded.shrink_to_fit();
+        log.clear();
+        log.shrink_to_fit();
+        count = 0;
+    }
+
+    size_t getMemoryUsage() const {
+        return encoded.capacity() + log.capacity() * sizeof(uint32_t);
+    }
+};
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef HLL_STORE_H
+#define HLL_STORE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "hll_format.h"
+#include "hll_mapped_file.h"
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+
+// Файл-хранилище многих скетчей с доступом по строковому ключу:
+//
+//   [HllStoreHeader][запись 0][запись 1]...[ключи подряд][индекс]
+//
+// Каждая запись (формат hll_format.h) начинается с границы HLL_STORE_ALIGN,
+// индекс отсортирован по ключу. После mmap поиск — двоичный поиск по индексу,
+// а оценка и слияние читают регистры прямо из отображения, так что загрузка
+// хранилища стоит ровно столько страниц, сколько скетчей реально тронуто.
+constexpr uint64_t HLL_STORE_MAGIC = 0x31524F54534C4C48ULL;  // "HLLSTOR1"
+constexpr uint32_t HLL_STORE_VERSION = 1;
+constexpr uint64_t HLL_STORE_ALIGN = 64;
+
+struct HllStoreHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint64_t keys_offset;
+    uint64_t index_offset;
+    uint64_t file_size;
+};
+
+struct HllStoreEntry {
+    uint64_t key_offset;
+    uint64_t record_offset;
+    uint32_t key_length;
+    uint32_t record_size;
+};
+
+static_assert(sizeof(HllStoreHeader) == 40 && sizeof(HllStoreEntry) == 24,
+              "store layout must not depend on the compiler");
+
+// Оценка записи любого вида: формула выбирается по виду скетча в заголовке.
+inline double hllEstimateRecord(const HllRecordView& record) {
+    switch (record.kind) {
+        case HllSketchKind::HyperLogLog:
+            return HyperLogLog::estimateRecord(record);
+        case HllSketchKind::HyperLogLogImproved:
+            return HyperLogLogImproved::estimateRecord(record);
+        case HllSketchKind::HyperLogLogCompact:
+            return HyperLogLogCompact::estimateRecord(record);
+    }
+    return 0.0;
+}
+
+class HllStoreWriter {
+private:
+    struct Item {
+        std::string key;
+        std::vector<uint8_t> record;
+    };
+    std::vector<Item> items;
+
+public:
+    // record — результат serialize() любого скетча. Ключи должны быть уникальны.
+    void add(std::string key, std::vector<uint8_t> record) {
+        items.push_back({std::move(key), std::move(record)});
+    }
+
+    size_t size() const {
+        return items.size();
+    }
+
+    bool write(const std::string& path) {
+        std::sort(items.begin(), items.end(),
+                  [](const Item& a, const Item& b) { return a.key < b.key; });
+
+        std::vector<uint8_t> out(sizeof(HllStoreHeader), 0);
+        std::vector<HllStoreEntry> index;
+        index.reserve(items.size());
+        auto align = [&out]() { out.resize((out.size() + HLL_STORE_ALIGN - 1) / HLL_STORE_ALIGN * HLL_STORE_ALIGN, 0); };
+
+        for (const Item& item : items) {
+            align();
+            HllStoreEntry entry{};
+            entry.record_offset = out.size();
+            entry.record_size = static_cast<uint32_t>(item.record.size());
+            entry.key_length = static_cast<uint32_t>(item.key.size());
+            index.push_back(entry);
+            out.insert(out.end(), item.record.begin(), item.record.end());
+        }
+
+        HllStoreHeader header{};
+        header.magic = HLL_STORE_MAGIC;
+        header.version = HLL_STORE_VERSION;
+        header.count = static_cast<uint32_t>(items.size());
+        header.keys_offset = out.size();
+        for (size_t i = 0; i < items.size(); ++i) {
+            index[i].key_offset = out.size();
+            out.insert(out.end(), items[i].key.begin(), items[i].key.end());
+        }
+        align();
+        header.index_offset = out.size();
+        const uint8_t* index_bytes = reinterpret_cast<const uint8_t*>(index.data());
+        out.insert(out.end(), index_bytes, index_bytes + index.size() * sizeof(HllStoreEntry));
+        header.file_size = out.size();
+        std::memcpy(out.data(), &header, sizeof(header));
+
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+        return std::fclose(file) == 0 && ok;
+    }
+};
+
+// Хранилище, отображённое в память только для чтения. Взгляды на записи
+// действительны, пока объект жив.
+class HllStore {
+private:
+    HllMappedFile file;
+    const uint8_t* data = nullptr;
+    size_t size_bytes = 0;
+    const HllStoreEntry* index = nullptr;
+    uint32_t count = 0;
+
+    std::string_view keyOf(const HllStoreEntry& entry) const {
+        return std::string_view(reinterpret_cast<const char*>(data + entry.key_offset), entry.key_length);
+    }
+
+    bool validate() {
+        HllStoreHeader header;
+        if (size_bytes < sizeof(header)) return false;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != HLL_STORE_MAGIC || header.version != HLL_STORE_VERSION) return false;
+        if (header.file_size != size_bytes || header.index_offset % alignof(HllStoreEntry) != 0) return false;
+        if (header.index_offset > size_bytes ||
+            (size_bytes - header.index_offset) / sizeof(HllStoreEntry) < header.count) return false;
+
+        index = reinterpret_cast<const HllStoreEntry*>(data + header.index_offset);
+        count = header.count;
+        for (uint32_t i = 0; i < count; ++i) {
+            const HllStoreEntry& entry = index[i];
+            if (entry.key_offset > size_bytes || entry.key_length > size_bytes - entry.key_offset ||
+                entry.record_offset > size_bytes || entry.record_size > size_bytes - entry.record_offset) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void unmap() {
+        file.close();
+        data = nullptr;
+        size_bytes = 0;
+        index = nullptr;
+        count = 0;
+    }
+
+public:
+    HllStore() = default;
+    HllStore(const HllStore&) = delete;
+    HllStore& operator=(const HllStore&) = delete;
+
+    // Отображает файл; false, если его нет или он не является хранилищем.
+    bool open(const std::string& path) {
+        unmap();
+        if (!file.open(path)) return false;
+        data = file.bytes().data();
+        size_bytes = file.size();
+        if (!validate()) {
+            unmap();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t size() const {
+        return count;
+    }
+
+    std::string_view keyAt(uint32_t i) const {
+        return keyOf(index[i]);
+    }
+
+    // Сырые байты записи — то, что принимают deserialize() скетчей.
+    std::span<const uint8_t> recordBytes(uint32_t i) const {
+        return std::span<const uint8_t>(data + index[i].record_offset, index[i].record_size);
+    }
+
+    std::optional<HllRecordView> recordAt(uint32_t i) const {
+        return HllRecordView::parse(recordBytes(i));
+    }
+
+    std::optional<HllRecordView> find(std::string_view key) const {
+        const HllStoreEntry* end = index + count;
+        const HllStoreEntry* it = std::lower_bound(index, end, key,
+            [this](const HllStoreEntry& entry, std::string_view k) { return keyOf(entry) < k; });
+        if (it == end || keyOf(*it) != key) return std::nullopt;
+        return recordAt(static_cast<uint32_t>(it - index));
+    }
+};
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef HLL_TELEMETRY_H
+#define HLL_TELEMETRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Телеметрия горячего пути скетчей. Включается флагом компиляции
+// HLL_TELEMETRY. Скетчи зовут её через макросы HLL_TELEMETRY_* (в конце
+// файла): без флага они раскрываются в ничто, так что горячий путь
+// остаётся тем же кодом, что и без телеметрии. Пустые
+// inline-функции для этого не годились: объект HllTelemetryBatch и захват его
+// в лямбду меняли решения компилятора об инлайнинге hllForEachBlock.
+//
+// Каждый поток пишет в свой слот — строку кэша со счётчиками, — поэтому
+// запись обходится обычным сложением без lock-префикса и без ложного
+// разделения. Чтение (снимок) суммирует все слоты под мьютексом реестра.
+// Слот завершившегося потока возвращается в реестр вместе с накопленными
+// значениями и достаётся следующему новому потоку, так что суммы не теряются,
+// а число слотов не превышает наибольшего числа одновременно живых потоков.
+#if defined(HLL_TELEMETRY)
+constexpr bool HLL_TELEMETRY_ENABLED = true;
+#else
+constexpr bool HLL_TELEMETRY_ENABLED = false;
+#endif
+
+constexpr size_t HLL_CACHE_LINE = 64;
+
+enum class HllCounter : uint32_t {
+    DenseAdds,           // вставки в плотные регистры
+    RegisterUpdates,     // из них увеличили регистр
+    SaturatedRegisters,  // регистр достиг 33 - b (хвост хеша из одних нулей)
+    SparseAdds,          // вставки в разреженный список
+    Promotions,          // переходы из разреженного режима в плотный
+    Count
+};
+
+constexpr size_t HLL_COUNTER_COUNT = static_cast<size_t>(HllCounter::Count);
+
+struct alignas(HLL_CACHE_LINE) HllTelemetrySlot {
+    std::array<std::atomic<uint64_t>, HLL_COUNTER_COUNT> values{};
+
+    // Пишет только поток-владелец; relaxed load + store вместо fetch_add.
+    void add(HllCounter counter, uint64_t n) {
+        std::atomic<uint64_t>& value = values[static_cast<size_t>(counter)];
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+static_assert(sizeof(HllTelemetrySlot) % HLL_CACHE_LINE == 0, "HllTelemetrySlot must fill whole cache lines");
+
+struct HllTelemetrySnapshot {
+    std::chrono::steady_clock::time_point taken;
+    std::array<uint64_t, HLL_COUNTER_COUNT> values{};
+
+    uint64_t operator[](HllCounter counter) const {
+        return values[static_cast<size_t>(counter)];
+    }
+
+    // Доля вставок в плотные регистры, не изменивших регистр.
+    double noOpFraction() const {
+        uint64_t adds = (*this)[HllCounter::DenseAdds];
+        return adds == 0 ? 0.0 : 1.0 - static_cast<double>((*this)[HllCounter::RegisterUpdates]) / adds;
+    }
+};
+
+class HllTelemetryRegistry {
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<HllTelemetrySlot>> slots;
+    std::vector<HllTelemetrySlot*> free_slots;
+
+public:
+    static HllTelemetryRegistry& instance() {
+        static HllTelemetryRegistry registry;
+        return registry;
+    }
+
+    HllTelemetrySlot* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_slots.empty()) {
+            HllTelemetrySlot* slot = free_slots.back();
+            free_slots.pop_back();
+            return slot;
+        }
+        slots.push_back(std::make_unique<HllTelemetrySlot>());
+        return slots.back().get();
+    }
+
+    void release(HllTelemetrySlot* slot) {
+        std::lock_guard<std::mutex> lock(mutex);
+        free_slots.push_back(slot);
+    }
+
+    HllTelemetrySnapshot snapshot() {
+        HllTelemetrySnapshot result;
+        std::lock_guard<std::mutex> lock(mutex);
+        result.taken = std::chrono::steady_clock::now();
+        for (const auto& slot : slots) {
+            for (size_t k = 0; k < HLL_COUNTER_COUNT; ++k) {
+                result.values[k] += slot->values[k].load(std::memory_order_relaxed);
+            }
+        }
+        return result;
+    }
+};
+
+// Слот текущего потока. Указатель — тривиальная thread_local-переменная,
+// поэтому быстрый путь обходится без проверки инициализации; объект,
+// возвращающий слот при завершении потока, создаётся один раз в
+// hllTelemetryAttach().
+inline thread_local HllTelemetrySlot* hll_telemetry_slot = nullptr;
+
+class HllTelemetryThread {
+private:
+    HllTelemetrySlot* slot;
+
+public:
+    HllTelemetryThread() : slot(HllTelemetryRegistry::instance().acquire()) {}
+    ~HllTelemetryThread() {
+        hll_telemetry_slot = nullptr;
+        HllTelemetryRegistry::instance().release(slot);
+    }
+    HllTelemetryThread(const HllTelemetryThread&) = delete;
+    HllTelemetryThread& operator=(const HllTelemetryThread&) = delete;
+
+    HllTelemetrySlot* get() {
+        return slot;
+    }
+};
+
+inline HllTelemetrySlot* hllTelemetryAttach() {
+    thread_local HllTelemetryThread thread_slot;
+    hll_telemetry_slot = thread_slot.get();
+    return hll_telemetry_slot;
+}
+
+inline HllTelemetrySlot& hllTelemetrySlot() {
+    HllTelemetrySlot* slot = hll_telemetry_slot;
+    if (slot == nullptr) [[unlikely]] slot = hllTelemetryAttach();
+    return *slot;
+}
+
+inline void hllTelemetryAdd(HllCounter counter, uint64_t n = 1) {
+    if constexpr (HLL_TELEMETRY_ENABLED) hllTelemetrySlot().add(counter, n);
+}
+
+// Одна вставка в плотные регистры: changed — регистр вырос до value.
+inline void hllTelemetryDenseAdd(bool changed, uint8_t value, uint32_t b) {
+    if constexpr (HLL_TELEMETRY_ENABLED) {
+        HllTelemetrySlot& slot = hllTelemetrySlot();
+        slot.add(HllCounter::DenseAdds, 1);
+        if (changed) {
+            slot.add(HllCounter::RegisterUpdates, 1);
+            if (value > 32 - b) slot.add(HllCounter::SaturatedRegisters, 1);
+        }
+    }
+}
+
+// Счётчики пакетной вставки: число вставок известно заранее, изменения
+// регистров (редкие в установившемся режиме) копятся в локальных переменных,
+// и всё попадает в слот потока один раз, в деструкторе.
+class HllTelemetryBatch {
+private:
+    uint64_t adds;
+    uint64_t updates = 0;
+    uint64_t saturated = 0;
+
+public:
+    explicit HllTelemetryBatch(size_t dense_adds) : adds(dense_adds) {}
+    HllTelemetryBatch(const HllTelemetryBatch&) = delete;
+    HllTelemetryBatch& operator=(const HllTelemetryBatch&) = delete;
+
+    void update(uint8_t value, uint32_t b) {
+        if constexpr (HLL_TELEMETRY_ENABLED) {
+            ++updates;
+            saturated += value > 32 - b;
+        }
+    }
+
+    ~HllTelemetryBatch() {
+        if constexpr (HLL_TELEMETRY_ENABLED) {
+            if (adds == 0) return;
+            HllTelemetrySlot& slot = hllTelemetrySlot();
+            slot.add(HllCounter::DenseAdds, adds);
+            slot.add(HllCounter::RegisterUpdates, updates);
+            slot.add(HllCounter::SaturatedRegisters, saturated);
+        }
+    }
+};
+
+// Точки сбора в скетчах. Без HLL_TELEMETRY макросы раскрываются в пустоту
+// вместе с аргументами, и код скетча совпадает с кодом без телеметрии.
+// changed проверяется до updateRegister: вырастет ли регистр.
+// HLL_TELEMETRY_BATCH объявляет счётчик пакета, HLL_TELEMETRY_BATCH_CAPTURE
+// дописывает его в список захвата лямбды после this.
+#if defined(HLL_TELEMETRY)
+#define HLL_TELEMETRY_ADD(counter) hllTelemetryAdd(counter)
+#define HLL_TELEMETRY_DENSE_ADD(changed, value, b) hllTelemetryDenseAdd(changed, value, b)
+#define HLL_TELEMETRY_BATCH(adds) HllTelemetryBatch hll_telemetry_batch(adds)
+#define HLL_TELEMETRY_BATCH_CAPTURE , &hll_telemetry_batch
+#define HLL_TELEMETRY_BATCH_UPDATE(changed, value, b) \
+    do { \
+        if (changed) hll_telemetry_batch.update(value, b); \
+    } while (false)
+#else
+#define HLL_TELEMETRY_ADD(counter)
+#define HLL_TELEMETRY_DENSE_ADD(changed, value, b)
+#define HLL_TELEMETRY_BATCH(adds)
+#define HLL_TELEMETRY_BATCH_CAPTURE
+#define HLL_TELEMETRY_BATCH_UPDATE(changed, value, b)
+#endif
+
+// Сумма по всем потокам на данный момент. Без HLL_TELEMETRY — нули.
+inline HllTelemetrySnapshot hllTelemetrySnapshot() {
+    if constexpr (HLL_TELEMETRY_ENABLED) return HllTelemetryRegistry::instance().snapshot();
+    return HllTelemetrySnapshot{std::chrono::steady_clock::now(), {}};
+}
+
+// Одна строка текстового отчёта: итоги с начала работы и темпы за интервал
+// от previous до current.
+inline void hllTelemetryPrint(std::ostream& out, const HllTelemetrySnapshot& previous,
+                              const HllTelemetrySnapshot& current) {
+    double seconds = std::chrono::duration<double>(current.taken - previous.taken).count();
+    auto rate = [&](HllCounter counter) {
+        return seconds > 0 ? (current[counter] - previous[counter]) / seconds : 0.0;
+    };
+    out << "hll dense_adds=" << current[HllCounter::DenseAdds]
+        << " updates=" << current[HllCounter::RegisterUpdates]
+        << " noop=" << std::fixed << std::setprecision(2) << current.noOpFraction() * 100 << "%"
+        << " saturated=" << current[HllCounter::SaturatedRegisters]
+        << " sparse_adds=" << current[HllCounter::SparseAdds]
+        << " promotions=" << current[HllCounter::Promotions]
+        << " adds/s=" << std::setprecision(0) << rate(HllCounter::DenseAdds) + rate(HllCounter::SparseAdds)
+        << " updates/s=" << rate(HllCounter::RegisterUpdates) << "\n";
+}
+
+// Фоновый поток, раз в period печатающий строку hllTelemetryPrint (и
+// последнюю — при остановке). Без HLL_TELEMETRY поток не запускается.
+class HllTelemetryReporter {
+private:
+    std::ostream& out;
+    std::chrono::milliseconds period;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void run() {
+        HllTelemetrySnapshot previous = hllTelemetrySnapshot();
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            bool last = wake.wait_for(lock, period, [this] { return stopping; });
+            HllTelemetrySnapshot current = hllTelemetrySnapshot();
+            hllTelemetryPrint(out, previous, current);
+            out.flush();
+            previous = current;
+            if (last) return;
+        }
+    }
+
+public:
+    HllTelemetryReporter(std::ostream& stream, std::chrono::milliseconds every)
+        : out(stream), period(every) {
+        if constexpr (HLL_TELEMETRY_ENABLED) worker = std::thread([this] { run(); });
+    }
+
+    ~HllTelemetryReporter() {
+        stop();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+};
+
+#endif
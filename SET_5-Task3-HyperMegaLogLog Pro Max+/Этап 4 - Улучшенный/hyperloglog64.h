@@ -0,0 +1,166 @@
+#ifndef HYPERLOGLOG64_H
+#define HYPERLOGLOG64_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include "hll_histogram.h"
+#include "hll_packing.h"
+#include "hll_bias_tables.h"
+#include "hll_estimators.h"
+#include "hll_register_sketch.h"
+#include "hll_sparse.h"
+
+// Порог линейного счёта из статьи HyperLogLog++ (Heule, Nunkesser, Hall), b = 4..18.
+constexpr uint32_t HLL_PP_MIN_B = 4;
+constexpr uint32_t HLL_PP_MAX_B = 18;
+constexpr double HLL_PP_THRESHOLD[] = {
+    10, 20, 40, 80, 220, 400, 900, 1800, 3100, 6500, 11500, 20000, 50000, 120000, 350000
+};
+
+// Смещение сырой оценки: среднее по 6 ближайшим точкам эмпирической таблицы.
+inline double hllEstimateBias(double raw_estimate, uint32_t b) {
+    std::span<const HllBiasPoint> table = hllBiasTable(b);
+    if (table.empty()) return 0.0;
+
+    const size_t k = std::min<size_t>(6, table.size());
+    size_t right = std::lower_bound(table.begin(), table.end(), raw_estimate,
+        [](const HllBiasPoint& p, double v) { return p.raw_estimate < v; }) - table.begin();
+    size_t left = right;
+    while (right - left < k) {
+        if (left == 0) {
+            ++right;
+        } else if (right == table.size()) {
+            --left;
+        } else if (raw_estimate - table[left - 1].raw_estimate <
+                   table[right].raw_estimate - raw_estimate) {
+            --left;
+        } else {
+            ++right;
+        }
+    }
+
+    double sum = 0.0;
+    for (size_t i = left; i < right; ++i) sum += table[i].bias;
+    return sum / k;
+}
+
+// С 64-битным хешем коллизии при 2^32 элементах пренебрежимы, поэтому вместо
+// поправки на большие значения применяется эмпирическая поправка смещения HLL++.
+inline double hllPlusPlusEstimate(double raw_estimate, uint32_t zeros, uint32_t b, uint32_t m) {
+    double corrected = raw_estimate;
+    if (raw_estimate <= 5.0 * m) {
+        corrected -= hllEstimateBias(raw_estimate, b);
+    }
+
+    if (zeros != 0) {
+        double linear = m * std::log(static_cast<double>(m) / zeros);
+        double threshold = (b >= HLL_PP_MIN_B && b <= HLL_PP_MAX_B)
+            ? HLL_PP_THRESHOLD[b - HLL_PP_MIN_B]
+            : 2.5 * m;
+        if (linear <= threshold) return linear;
+    }
+    return corrected;
+}
+
+inline bool hllSumsMatch(double a, double b) {
+    return std::abs(a - b) <= 1e-12 * std::max(std::abs(a), std::abs(b));
+}
+
+inline uint8_t hllRho64(uint64_t w, uint32_t b) {
+    uint32_t leading_zeros = static_cast<uint32_t>(std::countl_zero(w));
+    return static_cast<uint8_t>(std::min(leading_zeros, 64 - b) + 1);
+}
+
+inline void hllAddSparse64(HllSparseRegisters& sparse, uint64_t hash) {
+    uint32_t index = static_cast<uint32_t>(hash >> (64 - HLL_SPARSE_PRECISION));
+    sparse.add(index, hllRho64(hash << HLL_SPARSE_PRECISION, HLL_SPARSE_PRECISION));
+}
+
+// Регистры и разреженный режим — общие (hll_register_sketch.h); свои здесь
+// только вставка 64-битного хеша и оценка HLL++.
+class HyperLogLog64 : public HllRegisterSketch<HyperLogLog64, HllByteRegisters> {
+public:
+    static constexpr uint32_t HASH_BITS = 64;
+
+    HyperLogLog64(uint32_t b_bits, bool start_sparse = false)
+        : HllRegisterSketch(b_bits, start_sparse) {}
+
+    void add(uint64_t hash) {
+        if (sparse_mode) {
+            hllAddSparse64(sparse, hash);
+            promoteIfFull();
+            return;
+        }
+        uint32_t j = static_cast<uint32_t>(hash >> (64 - b));
+        uint64_t w = hash << b;
+        updateRegister(j, hllRho64(w, b));
+    }
+
+    void addBatch(std::span<const uint64_t> hashes) {
+        for (uint64_t hash : hashes) add(hash);
+    }
+
+    double rawEstimate() const {
+        return hllAlphaM(m) * m * m / histogram.harmonicSum();
+    }
+
+    static double estimateFromHistogram(const HllHistogram& hist, uint32_t b) {
+        uint32_t m = 1u << b;
+        return hllPlusPlusEstimate(hllAlphaM(m) * m * m / hist.harmonicSum(), hist.zeros(), b, m);
+    }
+
+    // Регистры 64-битной версии доходят до 65 - b, и сумма перестаёт быть точной
+    // в double, поэтому она сверяется с относительным допуском.
+    bool validateHistogram() const {
+        if (sparse_mode) return true;
+        std::vector<uint8_t> regs(m);
+        registers.unpack(regs.data(), m);
+        return hllHistogramOf(regs.data(), m) == histogram &&
+               hllSumsMatch(hllHarmonicSumOf(regs.data(), m), histogram.harmonicSum());
+    }
+};
+
+class HyperLogLogCompact64 : public HllRegisterSketch<HyperLogLogCompact64, HllBitstream6Registers> {
+public:
+    static constexpr uint32_t HASH_BITS = 64;
+
+    HyperLogLogCompact64(uint32_t b_bits, bool start_sparse = false)
+        : HllRegisterSketch(b_bits, start_sparse) {}
+
+    void add(uint64_t hash) {
+        if (sparse_mode) {
+            hllAddSparse64(sparse, hash);
+            promoteIfFull();
+            return;
+        }
+        uint32_t j = static_cast<uint32_t>(hash >> (64 - b));
+        uint64_t w = hash << b;
+        updateRegister(j, hllRho64(w, b));
+    }
+
+    void addBatch(std::span<const uint64_t> hashes) {
+        for (uint64_t hash : hashes) add(hash);
+    }
+
+    double rawEstimate() const {
+        return hllAlphaM(m) * m * m / histogram.harmonicSum();
+    }
+
+    static double estimateFromHistogram(const HllHistogram& hist, uint32_t b) {
+        return HyperLogLog64::estimateFromHistogram(hist, b);
+    }
+
+    bool validateHistogram() const {
+        if (sparse_mode) return true;
+        std::vector<uint8_t> regs(m);
+        registers.unpack(regs.data(), m);
+        return hllHistogramOf(regs.data(), m) == histogram &&
+               hllSumsMatch(hllHarmonicSumOf(regs.data(), m), histogram.harmonicSum());
+    }
+};
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef HYPERLOGLOG_ADAPTIVE_H
+#define HYPERLOGLOG_ADAPTIVE_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include "hll_batch.h"
+#include "hll_estimators.h"
+#include "hll_fold.h"
+#include "hll_histogram.h"
+#include "hll_merge.h"
+#include "hyperloglog.h"
+
+// HyperLogLog, точность которого растёт по мере заполнения: начинает с 2^b_min
+// регистров и удваивает их, как только занято больше HLL_ADAPTIVE_GROW_FILL
+// регистров, пока b не дойдёт до b_max. Редкий ключ так и остаётся с 2^b_min
+// байтами, частый получает точность b_max.
+//
+// Удвоение, в отличие от свёртки, точным быть не может: регистр хранит только
+// максимум rho. Если r >= 2, следующий бит хеша-максимума — 0, и регистр 2j
+// получает r - 1 точно. Если r = 1, этот бит — 1, и регистр 2j + 1 получает
+// нижнюю границу 1. Теряются хеши, уступившие максимуму и ушедшие в другую
+// половину. Пока занята малая доля регистров, почти в каждом занятом регистре
+// один хеш, и пустые регистры (по ним считает линейный счёт) переносятся без
+// потерь; элементы после удвоения учитываются точно. Потери копятся с каждым
+// удвоением, поэтому порог мал: при 1/32 смещение на малых потоках около 1 %
+// (при 1/4 было до 10 %), а скетч на 10 элементов всё ещё занимает ~500 байт
+// вместо 16 КБ у HyperLogLog(14) (main_fold.cpp).
+constexpr double HLL_ADAPTIVE_GROW_FILL = 1.0 / 32;
+
+class HyperLogLogAdaptive {
+private:
+    uint32_t b;
+    uint32_t b_min;
+    uint32_t b_max;
+    uint32_t m;
+    uint32_t grow_at;
+    std::vector<uint8_t> M;
+    HllHistogram histogram;
+
+    void setPrecision(uint32_t b_bits) {
+        b = b_bits;
+        m = 1u << b_bits;
+        grow_at = b < b_max ? static_cast<uint32_t>(m * HLL_ADAPTIVE_GROW_FILL) : m;
+    }
+
+    void updateRegister(uint32_t j, uint8_t r) {
+        if (r > M[j]) {
+            histogram.update(M[j], r);
+            M[j] = r;
+        }
+    }
+
+    void grow() {
+        std::vector<uint8_t> next(2 * static_cast<size_t>(m), 0);
+        for (uint32_t j = 0; j < m; ++j) {
+            if (M[j] >= 2) {
+                next[2 * j] = M[j] - 1;
+            } else if (M[j] == 1) {
+                next[2 * j + 1] = 1;
+            }
+        }
+        M.swap(next);
+        setPrecision(b + 1);
+        histogram = hllHistogramOf(M.data(), m);
+    }
+
+public:
+    // b_min поднимается до HLL_FOLD_MIN_B: скетч меньшей точности нельзя
+    // было бы получить свёрткой, и слияние с ним не работало бы.
+    HyperLogLogAdaptive(uint32_t b_min_bits, uint32_t b_max_bits)
+        : b_min(std::max(b_min_bits, HLL_FOLD_MIN_B)), b_max(std::max(b_min, b_max_bits)) {
+        reset();
+    }
+
+    void add(uint32_t hash) {
+        updateRegister(hash >> (32 - b), hllRho(hash << b, b));
+        if (m - histogram.zeros() > grow_at) grow();
+    }
+
+    // Точность может вырасти посреди пакета, поэтому хеши идут по одному.
+    void addBatch(std::span<const uint32_t> hashes) {
+        for (uint32_t hash : hashes) add(hash);
+    }
+
+    double estimate() const {
+        return HyperLogLog::estimateFromHistogram(histogram, b);
+    }
+
+    double estimate(HllEstimator method) const {
+        if (method == HllEstimator::Classic) return estimate();
+        return hllEstimateFromHistogram(method, histogram, b);
+    }
+
+    // Объединение при любых точностях: результат получает меньшую из двух,
+    // более точный скетч сворачивается. false, если свернуть не удалось.
+    bool merge(const HyperLogLogAdaptive& other) {
+        if (other.b < b) {
+            std::optional<HyperLogLogAdaptive> folded = fold(other.b);
+            if (!folded) return false;
+            *this = std::move(*folded);
+        }
+        if (other.b > b) {
+            std::optional<HyperLogLogAdaptive> folded = other.fold(b);
+            return folded && merge(*folded);
+        }
+        hllMergeMax(M.data(), other.M.data(), m, histogram);
+        return true;
+    }
+
+    // Тот же скетч с точностью target_b из [HLL_FOLD_MIN_B, b] (hll_fold.h);
+    // расти он продолжит с target_b.
+    std::optional<HyperLogLogAdaptive> fold(uint32_t target_b) const {
+        if (target_b > b || target_b < HLL_FOLD_MIN_B) return std::nullopt;
+        HyperLogLogAdaptive result(std::min(b_min, target_b), b_max);
+        result.setPrecision(target_b);
+        result.M.assign(result.m, 0);
+        hllFoldRegisters(M.data(), b, target_b, result.M.data());
+        result.histogram = hllHistogramOf(result.M.data(), result.m);
+        return result;
+    }
+
+    void reset() {
+        setPrecision(b_min);
+        M.assign(m, 0);
+        histogram.reset(m);
+    }
+
+    uint32_t getB() const {
+        return b;
+    }
+
+    bool validateHistogram() const {
+        return hllHistogramOf(M.data(), m) == histogram &&
+               hllHarmonicSumOf(M.data(), m) == histogram.harmonicSum();
+    }
+
+    size_t getMemoryUsage() const {
+        return M.size() * sizeof(uint8_t);
+    }
+};
+
+#endif
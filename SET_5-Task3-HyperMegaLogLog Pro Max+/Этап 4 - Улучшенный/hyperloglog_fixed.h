@@ -0,0 +1,141 @@
+#ifndef HYPERLOGLOG_FIXED_H
+#define HYPERLOGLOG_FIXED_H
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include "hll_batch.h"
+#include "hll_estimators.h"
+#include "hll_histogram.h"
+#include "hll_packing.h"
+#include "hll_register_sketch.h"
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+
+// HyperLogLog с точностью, известной при компиляции: b, m и сдвиги —
+// константы, индекс и rho считаются сдвигами на непосредственные значения.
+// Заметно быстрее классов с b, заданным при запуске, это не выходит: в
+// main_policy разница в add() и addBatch() в пределах разброса замеров, в обе
+// стороны. Смысл шаблона — в политиках: хранилище регистров и формула оценки
+// подставляются независимо:
+//   Storage   — HllByteRegisters или HllBitstream6Registers (hll_packing.h);
+//   Estimator — estimate<B>(гистограмма);
+//   Sparse    — начинать ли с разреженного списка, как HyperLogLog(b, true).
+// Регистры, гистограмма, разреженный режим, слияние и запись — общие с
+// классами HyperLogLog, HyperLogLogImproved и HyperLogLogCompact
+// (hll_register_sketch.h); здесь свои только вставка со сдвигами на B и
+// fold<K>(). Псевдонимы в конце файла повторяют эти классы с B в типе.
+
+// Оценщики повторяют формулы соответствующих классов.
+struct HllStandardEstimator {
+    template <uint32_t B>
+    static double estimate(const HllHistogram& hist) {
+        return HyperLogLog::estimateFromHistogram(hist, B);
+    }
+};
+
+struct HllBiasCorrectedEstimator {
+    template <uint32_t B>
+    static double estimate(const HllHistogram& hist) {
+        return HyperLogLogImproved::estimateFromHistogram(hist, B);
+    }
+};
+
+struct HllSaturatingEstimator {
+    template <uint32_t B>
+    static double estimate(const HllHistogram& hist) {
+        return HyperLogLogCompact::estimateFromHistogram(hist, B);
+    }
+};
+
+// Оценки Эртла (hll_estimators.h).
+struct HllImprovedEstimator {
+    template <uint32_t B>
+    static double estimate(const HllHistogram& hist) {
+        return hllImprovedEstimate(hist, B);
+    }
+};
+
+struct HllMaxLikelihoodEstimator {
+    template <uint32_t B>
+    static double estimate(const HllHistogram& hist) {
+        return hllMaxLikelihoodEstimate(hist, B);
+    }
+};
+
+template <unsigned B, class Storage, class Estimator, bool Sparse = false>
+class HllSketch : public HllRegisterSketch<HllSketch<B, Storage, Estimator, Sparse>, Storage> {
+    static_assert(B >= 4 && B <= 18, "точность HyperLogLog вне диапазона 4..18");
+
+    using Base = HllRegisterSketch<HllSketch, Storage>;
+    friend Base;
+
+public:
+    static constexpr uint32_t INDEX_SHIFT = 32 - B;
+    // Запись хранит раскладку регистров, а не формулу оценки: байтовые
+    // регистры читаются как HyperLogLog, шестибитный поток — как
+    // HyperLogLogCompact.
+    static constexpr HllSketchKind KIND = std::is_same_v<Storage, HllBitstream6Registers>
+        ? HllSketchKind::HyperLogLogCompact : HllSketchKind::HyperLogLog;
+
+    HllSketch() : Base(B, Sparse) {}
+
+    static double estimateFromHistogram(const HllHistogram& hist, uint32_t) {
+        return Estimator::template estimate<B>(hist);
+    }
+
+    void add(uint32_t hash) {
+        if constexpr (Sparse) {
+            if (this->sparse_mode) {
+                this->addSparse(hash);
+                return;
+            }
+        }
+        this->updateRegister(hash >> INDEX_SHIFT, hllRho(hash << B, B));
+    }
+
+    void addBatch(std::span<const uint32_t> hashes) {
+        if constexpr (Sparse) {
+            size_t i = 0;
+            while (this->sparse_mode && i < hashes.size()) this->addSparse(hashes[i++]);
+            hashes = hashes.subspan(i);
+        }
+        hllForEachBlock(hashes, B, this->registers.getMemoryUsage() >= HLL_PREFETCH_MIN_BYTES,
+            [this](uint32_t j) { this->registers.prefetch(j); },
+            [this](uint32_t j, uint8_t r) { this->updateRegister(j, r); });
+    }
+
+    using Base::merge;
+
+    // Точность входит в тип, поэтому сливаются только скетчи одного типа.
+    void merge(const HllSketch& other) {
+        this->mergeSameB(other);
+    }
+
+    // Тот же скетч с точностью B - K (hll_fold.h).
+    template <unsigned K>
+    HllSketch<B - K, Storage, Estimator, Sparse> fold() const {
+        HllSketch<B - K, Storage, Estimator, Sparse> result;
+        this->foldInto(result);
+        return result;
+    }
+
+private:
+    // Для HllRegisterSketch::deserialize(): запись другой точности отвергнет
+    // merge().
+    explicit HllSketch(uint32_t, bool = Sparse) : HllSketch() {}
+};
+
+template <unsigned B>
+using HyperLogLogFixed = HllSketch<B, HllByteRegisters, HllStandardEstimator>;
+
+template <unsigned B>
+using HyperLogLogSparseFixed = HllSketch<B, HllByteRegisters, HllStandardEstimator, true>;
+
+template <unsigned B>
+using HyperLogLogImprovedFixed = HllSketch<B, HllByteRegisters, HllBiasCorrectedEstimator>;
+
+template <unsigned B>
+using HyperLogLogCompactFixed = HllSketch<B, HllBitstream6Registers, HllSaturatingEstimator>;
+
+#endif
@@ -1,39 +1,17 @@
 #ifndef HYPERLOGLOG_IMPROVED_H
 #define HYPERLOGLOG_IMPROVED_H
 
-#include <vector>
 #include <cmath>
 #include <algorithm>
 #include <cstdint>
+#include "hll_estimators.h"
+#include "hll_histogram.h"
+#include "hll_packing.h"
+#include "hll_register_sketch.h"
 
-class HyperLogLogImproved {
+class HyperLogLogImproved : public HllRegisterSketch<HyperLogLogImproved, HllByteRegisters> {
 private:
-    uint32_t b;
-    uint32_t m;
-    std::vector<uint8_t> M;
-    double alpha_m;
-
-    double getAlphaM(uint32_t m) const {
-        if (m == 16) return 0.673;
-        if (m == 32) return 0.697;
-        if (m == 64) return 0.709;
-        return 0.7213 / (1.0 + 1.079 / m);
-    }
-
-    uint8_t rho(uint32_t w) const {
-        if (w == 0) return 32 - b + 1;
-        
-        uint8_t leading_zeros = 0;
-        for (int i = 31 - b; i >= 0; --i) {
-            if (w & (1u << i)) {
-                break;
-            }
-            leading_zeros++;
-        }
-        return leading_zeros + 1;
-    }
-
-    double applyBiasCorrection(double raw_estimate, uint32_t zeros) const {
+    static double applyBiasCorrection(double raw_estimate, uint32_t zeros, uint32_t m) {
         double ratio = raw_estimate / m;
         double correction = 1.0;
         double zero_ratio = static_cast<double>(zeros) / m;
@@ -67,28 +45,18 @@ private:
     }
 
 public:
-    HyperLogLogImproved(uint32_t b_bits) : b(b_bits), m(1u << b_bits) {
-        M.resize(m, 0);
-        alpha_m = getAlphaM(m);
-    }
+    static constexpr HllSketchKind KIND = HllSketchKind::HyperLogLogImproved;
 
-    void add(uint32_t hash) {
-        uint32_t j = hash >> (32 - b);
-        uint32_t w = hash << b;
-        M[j] = std::max(M[j], rho(w));
-    }
+    HyperLogLogImproved(uint32_t b_bits, bool start_sparse = false)
+        : HllRegisterSketch(b_bits, start_sparse) {}
 
-    double estimate() const {
-        double sum = 0.0;
-        uint32_t zeros = 0;
+    static double estimateFromHistogram(const HllHistogram& hist, uint32_t b) {
+        uint32_t m = 1u << b;
+        double sum = hist.harmonicSum();
+        uint32_t zeros = hist.zeros();
         
-        for (uint32_t i = 0; i < m; ++i) {
-            sum += 1.0 / (1ull << M[i]);
-            if (M[i] == 0) zeros++;
-        }
-        
-        double raw_estimate = alpha_m * m * m / sum;
-        double corrected = applyBiasCorrection(raw_estimate, zeros);
+        double raw_estimate = hllAlphaM(m) * m * m / sum;
+        double corrected = applyBiasCorrection(raw_estimate, zeros, m);
         if (corrected > (1.0 / 30.0) * (1ull << 32)) {
             return -(1ull << 32) * std::log(1.0 - corrected / (1ull << 32));
         }
@@ -96,106 +64,45 @@ public:
         return corrected;
     }
 
-    void reset() {
-        std::fill(M.begin(), M.end(), 0);
-    }
-
     double estimateError() const {
         return 1.04 / std::sqrt(m);
     }
 
     uint32_t getUsedRegisters() const {
-        uint32_t used = 0;
-        for (uint32_t i = 0; i < m; ++i) {
-            if (M[i] > 0) used++;
+        if (sparse_mode) {
+            sparse.flush();
+            uint32_t used = 0;
+            uint32_t last = m;
+            sparse.forEachDense(b, [&](uint32_t j, uint8_t) {
+                if (j != last) used++;
+                last = j;
+            });
+            return used;
         }
-        return used;
-    }
-
-    size_t getMemoryUsage() const {
-        return M.size() * sizeof(uint8_t);
+        return m - histogram.zeros();
     }
 };
 
-class HyperLogLogCompact {
+// Регистры подряд по 6 бит (HllBitstream6Registers): 4 регистра на 3 байта.
+class HyperLogLogCompact : public HllRegisterSketch<HyperLogLogCompact, HllBitstream6Registers> {
 private:
-    uint32_t b;
-    uint32_t m;
-    std::vector<uint32_t> M_packed;
-    static constexpr uint8_t BITS_PER_REGISTER = 6;
-    static constexpr uint8_t MAX_REGISTER_VALUE = (1 << BITS_PER_REGISTER) - 1;
-    double alpha_m;
-
-    double getAlphaM(uint32_t m) const {
-        if (m == 16) return 0.673;
-        if (m == 32) return 0.697;
-        if (m == 64) return 0.709;
-        return 0.7213 / (1.0 + 1.079 / m);
-    }
-
-    uint8_t rho(uint32_t w) const {
-        if (w == 0) return std::min<uint8_t>(32 - b + 1, MAX_REGISTER_VALUE);
-        
-        uint8_t leading_zeros = 0;
-        for (int i = 31 - b; i >= 0; --i) {
-            if (w & (1u << i)) {
-                break;
-            }
-            leading_zeros++;
-        }
-        uint8_t result = leading_zeros + 1;
-        return std::min(result, MAX_REGISTER_VALUE);
-    }
-
-    void setRegister(uint32_t index, uint8_t value) {
-        uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
-        uint32_t uint32_index = index / bits_per_uint32;
-        uint32_t bit_offset = (index % bits_per_uint32) * BITS_PER_REGISTER;
-        
-        uint32_t mask = ((1u << BITS_PER_REGISTER) - 1) << bit_offset;
-        M_packed[uint32_index] = (M_packed[uint32_index] & ~mask) | 
-                                 (static_cast<uint32_t>(value) << bit_offset);
-    }
-
-    uint8_t getRegister(uint32_t index) const {
-        uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
-        uint32_t uint32_index = index / bits_per_uint32;
-        uint32_t bit_offset = (index % bits_per_uint32) * BITS_PER_REGISTER;
-        
-        return (M_packed[uint32_index] >> bit_offset) & ((1u << BITS_PER_REGISTER) - 1);
-    }
+    static constexpr uint8_t MAX_REGISTER_VALUE = HllBitstream6Registers::MAX_VALUE;
 
 public:
-    HyperLogLogCompact(uint32_t b_bits) : b(b_bits), m(1u << b_bits) {
-        uint32_t bits_per_uint32 = 32 / BITS_PER_REGISTER;
-        uint32_t num_uint32s = (m + bits_per_uint32 - 1) / bits_per_uint32;
-        M_packed.resize(num_uint32s, 0);
-        alpha_m = getAlphaM(m);
-    }
+    static constexpr HllSketchKind KIND = HllSketchKind::HyperLogLogCompact;
 
-    void add(uint32_t hash) {
-        uint32_t j = hash >> (32 - b);
-        uint32_t w = hash << b;
-        uint8_t new_val = rho(w);
-        uint8_t old_val = getRegister(j);
-        if (new_val > old_val) {
-            setRegister(j, new_val);
-        }
+    HyperLogLogCompact(uint32_t b_bits, bool start_sparse = false)
+        : HllRegisterSketch(b_bits, start_sparse) {}
+
+    static double estimateFromHistogram(const HllHistogram& hist, uint32_t b) {
+        return estimateFromSum(hist.harmonicSum(), hist.zeros(), hist.counts[MAX_REGISTER_VALUE], b);
     }
 
-    double estimate() const {
-        double sum = 0.0;
-        uint32_t zeros = 0;
-        uint32_t saturated = 0;
-        
-        for (uint32_t i = 0; i < m; ++i) {
-            uint8_t reg_val = getRegister(i);
-            sum += 1.0 / (1ull << reg_val);
-            if (reg_val == 0) zeros++;
-            if (reg_val == MAX_REGISTER_VALUE) saturated++;
-        }
-        
-        double raw_estimate = alpha_m * m * m / sum;
+    // Та же оценка по сумме 2^-M[i], числу нулевых и насыщенных регистров —
+    // для тех, кто считает их сам, не строя гистограмму (HllGroupTable).
+    static double estimateFromSum(double sum, uint32_t zeros, uint32_t saturated, uint32_t b) {
+        uint32_t m = 1u << b;
+        double raw_estimate = hllAlphaM(m) * m * m / sum;
         
         if (raw_estimate <= 2.5 * m && zeros != 0) {
             return m * std::log(static_cast<double>(m) / zeros);
@@ -213,14 +120,6 @@ public:
         
         return raw_estimate;
     }
-
-    void reset() {
-        std::fill(M_packed.begin(), M_packed.end(), 0);
-    }
-
-    size_t getMemoryUsage() const {
-        return M_packed.size() * sizeof(uint32_t);
-    }
 };
 
 #endif
@@ -0,0 +1,114 @@
+#ifndef HYPERLOGLOG_TAILCUT_H
+#define HYPERLOGLOG_TAILCUT_H
+
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include "hll_batch.h"
+#include "hll_fold.h"
+#include "hll_histogram.h"
+#include "hll_packing.h"
+#include "hyperloglog.h"
+
+// HyperLogLog на четырёхбитных регистрах (база + смещение, переполнения
+// отдельным списком): половина байта на регистр вместо шести бит. Значения
+// регистров точные, поэтому оценка та же, что у HyperLogLog.
+class HyperLogLogTailCut {
+private:
+    uint32_t b;
+    uint32_t m;
+    HllTailCutRegisters registers;
+    HllHistogram histogram;
+
+    uint8_t rho(uint32_t w) const {
+        return hllRho(w, b);
+    }
+
+public:
+    HyperLogLogTailCut(uint32_t b_bits) : b(b_bits), m(1u << b_bits) {
+        registers.reset(m);
+        histogram.reset(m);
+    }
+
+    void add(uint32_t hash) {
+        uint32_t j = hash >> (32 - b);
+        uint32_t w = hash << b;
+        updateRegister(j, rho(w));
+    }
+
+    void addBatch(std::span<const uint32_t> hashes) {
+        hllForEachBlock(hashes, b, false, [](uint32_t) {},
+            [this](uint32_t j, uint8_t r) { updateRegister(j, r); });
+    }
+
+    double estimate() const {
+        return HyperLogLog::estimateFromHistogram(histogram, b);
+    }
+
+    double estimate(HllEstimator method) const {
+        if (method == HllEstimator::Classic) return estimate();
+        return hllEstimateFromHistogram(method, histogram, b);
+    }
+
+    // Более точный other сначала сворачивается до b; менее точный — false.
+    bool merge(const HyperLogLogTailCut& other) {
+        if (other.b < b) return false;
+        if (other.b > b) {
+            std::optional<HyperLogLogTailCut> folded = other.fold(b);
+            return folded && merge(*folded);
+        }
+        registers.merge(other.registers, m);
+        std::vector<uint8_t> regs(m);
+        registers.unpack(regs.data(), m);
+        histogram = hllHistogramOf(regs.data(), m);
+        return true;
+    }
+
+    // Тот же скетч с точностью target_b из [HLL_FOLD_MIN_B, b] (hll_fold.h).
+    std::optional<HyperLogLogTailCut> fold(uint32_t target_b) const {
+        if (target_b > b || target_b < HLL_FOLD_MIN_B) return std::nullopt;
+        HyperLogLogTailCut result(target_b);
+        std::vector<uint8_t> regs(m);
+        std::vector<uint8_t> folded(result.m);
+        registers.unpack(regs.data(), m);
+        hllFoldRegisters(regs.data(), b, target_b, folded.data());
+        for (uint32_t j = 0; j < result.m; ++j) result.updateRegister(j, folded[j]);
+        return result;
+    }
+
+    void reset() {
+        registers.reset(m);
+        histogram.reset(m);
+    }
+
+    bool validateHistogram() const {
+        std::vector<uint8_t> regs(m);
+        registers.unpack(regs.data(), m);
+        return hllHistogramOf(regs.data(), m) == histogram &&
+               hllHarmonicSumOf(regs.data(), m) == histogram.harmonicSum();
+    }
+
+    uint32_t getB() const {
+        return b;
+    }
+
+    size_t getOverflowCount() const {
+        return registers.getOverflowCount();
+    }
+
+    size_t getMemoryUsage() const {
+        return registers.getMemoryUsage();
+    }
+
+private:
+    void updateRegister(uint32_t j, uint8_t r) {
+        uint8_t old_val = registers.get(j);
+        if (r > old_val) {
+            histogram.update(old_val, r);
+            registers.set(j, r);
+        }
+    }
+};
+
+#endif
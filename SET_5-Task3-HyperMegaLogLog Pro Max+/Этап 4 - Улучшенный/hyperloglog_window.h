@@ -0,0 +1,159 @@
+#ifndef HYPERLOGLOG_WINDOW_H
+#define HYPERLOGLOG_WINDOW_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include "hll_batch.h"
+#include "hll_histogram.h"
+#include "hyperloglog.h"
+
+// HyperLogLog со скользящим окном (Sliding HyperLogLog, Chabchoub и Hébrail).
+// Для каждого регистра хранится список возможных будущих максимумов (LPFM):
+// пары (время, rho), в которых время растёт, а rho строго убывает. Пара,
+// у которой rho не больше, чем у более поздней, уже никогда не станет
+// максимумом ни одного окна и выбрасывается. Поэтому длина списка не больше
+// числа различных значений rho (33 - b) при любой скорости потока, а в
+// среднем порядка ln(n / m).
+//
+// Время — любое неубывающее целое (секунды, миллисекунды, номер события),
+// не больше 2^58. Запрос estimate(window) охватывает события с меткой
+// больше now - window, где now — последняя метка, а окно не короче now
+// охватывает всю историю, включая метку 0; окна длиннее horizon отвечают как
+// окно horizon.
+constexpr uint32_t HLL_WINDOW_RHO_BITS = 6;
+
+class HyperLogLogWindow {
+private:
+    uint32_t b;
+    uint32_t m;
+    uint64_t horizon;
+    uint64_t now = 0;
+    // Элемент списка: (время << HLL_WINDOW_RHO_BITS) | rho.
+    std::vector<std::vector<uint64_t>> lpfm;
+    // Курсор фоновой очистки: каждая вставка просматривает ещё один регистр,
+    // так что устаревшие пары исчезают не позже чем через m вставок.
+    uint32_t sweep = 0;
+
+    uint8_t rho(uint32_t w) const {
+        return hllRho(w, b);
+    }
+
+    static uint64_t timeOf(uint64_t entry) {
+        return entry >> HLL_WINDOW_RHO_BITS;
+    }
+
+    static uint8_t rhoOf(uint64_t entry) {
+        return static_cast<uint8_t>(entry & ((1u << HLL_WINDOW_RHO_BITS) - 1));
+    }
+
+    // Самая ранняя метка, которая ещё входит в окно: now - window + 1, или 0,
+    // пока окно не короче now. Граница включительная, иначе при now < window
+    // события с меткой 0 выпадали бы из окна, покрывающего всю историю.
+    uint64_t firstTick(uint64_t window) const {
+        window = std::min(window, horizon);
+        return now >= window ? now - window + 1 : 0;
+    }
+
+    void expire(std::vector<uint64_t>& list) {
+        uint64_t first = firstTick(horizon);
+        auto keep = std::find_if(list.begin(), list.end(),
+                                 [first](uint64_t e) { return timeOf(e) >= first; });
+        list.erase(list.begin(), keep);
+    }
+
+    void insert(uint32_t j, uint8_t r) {
+        std::vector<uint64_t>& list = lpfm[j];
+        while (!list.empty() && rhoOf(list.back()) <= r) list.pop_back();
+        list.push_back((now << HLL_WINDOW_RHO_BITS) | r);
+        expire(list);
+
+        expire(lpfm[sweep]);
+        sweep = (sweep + 1) & (m - 1);
+    }
+
+    // Максимум регистра в окне: первая пара не старше границы, так как rho
+    // убывает вдоль списка.
+    uint8_t registerIn(const std::vector<uint64_t>& list, uint64_t first) const {
+        for (uint64_t e : list) {
+            if (timeOf(e) >= first) return rhoOf(e);
+        }
+        return 0;
+    }
+
+public:
+    HyperLogLogWindow(uint32_t b_bits, uint64_t horizon_ticks)
+        : b(b_bits), m(1u << b_bits), horizon(horizon_ticks), lpfm(1u << b_bits) {}
+
+    void add(uint32_t hash, uint64_t timestamp) {
+        now = std::max(now, timestamp);
+        uint32_t j = hash >> (32 - b);
+        uint32_t w = hash << b;
+        insert(j, rho(w));
+    }
+
+    // Пачка событий с одной меткой времени.
+    void addBatch(std::span<const uint32_t> hashes, uint64_t timestamp) {
+        now = std::max(now, timestamp);
+        hllForEachBlock(hashes, b, false, [](uint32_t) {},
+            [this](uint32_t j, uint8_t r) { insert(j, r); });
+    }
+
+    // Регистры окна собираются в гистограмму, дальше — оценка HyperLogLog
+    // (или оценка Эртла, если выбрана).
+    double estimate(uint64_t window, HllEstimator method = HllEstimator::Classic) const {
+        uint64_t first = firstTick(window);
+        HllHistogram hist;
+        for (const auto& list : lpfm) {
+            ++hist.counts[registerIn(list, first)];
+        }
+        if (method == HllEstimator::Classic) return HyperLogLog::estimateFromHistogram(hist, b);
+        return hllEstimateFromHistogram(method, hist, b);
+    }
+
+    double estimate() const {
+        return estimate(horizon);
+    }
+
+    double estimate(HllEstimator method) const {
+        return estimate(horizon, method);
+    }
+
+    uint64_t getNow() const {
+        return now;
+    }
+
+    uint64_t getHorizon() const {
+        return horizon;
+    }
+
+    size_t getMaxListLength() const {
+        size_t longest = 0;
+        for (const auto& list : lpfm) longest = std::max(longest, list.size());
+        return longest;
+    }
+
+    size_t getEntryCount() const {
+        size_t total = 0;
+        for (const auto& list : lpfm) total += list.size();
+        return total;
+    }
+
+    size_t getMemoryUsage() const {
+        size_t bytes = lpfm.capacity() * sizeof(std::vector<uint64_t>);
+        for (const auto& list : lpfm) bytes += list.capacity() * sizeof(uint64_t);
+        return bytes;
+    }
+
+    void reset() {
+        for (auto& list : lpfm) {
+            list.clear();
+            list.shrink_to_fit();
+        }
+        now = 0;
+        sweep = 0;
+    }
+};
+
+#endif
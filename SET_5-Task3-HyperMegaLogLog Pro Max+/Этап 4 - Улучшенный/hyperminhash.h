@@ -0,0 +1,273 @@
+#ifndef HYPERMINHASH_H
+#define HYPERMINHASH_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include "hll_estimators.h"
+#include "hll_histogram.h"
+#include "hyperloglog64.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// HyperMinHash (Yu, Weber): к регистру HyperLogLog добавлены r бит мантиссы —
+// биты хеша сразу после первой единицы. Регистр хранит (rho << r) | ~мантисса,
+// поэтому больший регистр соответствует меньшему хешу корзины: объединение
+// по-прежнему поэлементный максимум, а совпадение регистров двух скетчей
+// означает, что минимум корзины у множеств, скорее всего, общий. Доля совпавших
+// регистров за вычетом ожидаемых случайных совпадений оценивает коэффициент
+// Жаккара, а через него пересечение — без разности больших оценок, как в
+// формуле включений-исключений.
+//
+// Хеш 64-битный: при b >= 4 rho не больше 61 и помещается в 6 бит, вместе с
+// 10 битами мантиссы регистр занимает ровно uint16_t. Нулевой регистр — пустой.
+constexpr uint32_t HMH_MANTISSA_BITS = 10;
+constexpr uint16_t HMH_MANTISSA_MASK = (1u << HMH_MANTISSA_BITS) - 1;
+constexpr uint32_t HMH_MIN_B = 4;
+
+inline uint16_t hmhRegister(uint64_t w, uint32_t b) {
+    uint32_t leading_zeros = static_cast<uint32_t>(std::countl_zero(w));
+    uint32_t rho = std::min(leading_zeros, 64 - b) + 1;
+    uint32_t shift = leading_zeros + 1;
+    uint32_t mantissa = shift < 64 ? static_cast<uint32_t>((w << shift) >> (64 - HMH_MANTISSA_BITS)) : 0;
+    return static_cast<uint16_t>((rho << HMH_MANTISSA_BITS) | (HMH_MANTISSA_MASK - mantissa));
+}
+
+inline uint8_t hmhRho(uint16_t reg) {
+    return static_cast<uint8_t>(reg >> HMH_MANTISSA_BITS);
+}
+
+// Всё, что нужно для оценок по паре скетчей, за один проход: совпавшие
+// непустые регистры, непустые регистры объединения и сумма 2^-rho объединения.
+struct HmhPairStats {
+    uint32_t matches = 0;
+    uint32_t occupied = 0;
+    uint32_t union_zeros = 0;
+    double union_harmonic = 0.0;
+};
+
+inline HmhPairStats hmhCompare(const uint16_t* a, const uint16_t* b, size_t m) {
+    HmhPairStats stats;
+    size_t i = 0;
+#if defined(__AVX2__)
+    // 2^-rho собирается прямо в битах float: показатель 127 - rho, мантисса 0.
+    // Частичные суммы float сбрасываются в double каждые 4096 регистров.
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i bias = _mm256_set1_epi32(127);
+    const size_t FLUSH = 4096;
+    while (i + 16 <= m) {
+        size_t block_end = std::min(m - (m - i) % 16, i + FLUSH);
+        __m256 sum_lo = _mm256_setzero_ps();
+        __m256 sum_hi = _mm256_setzero_ps();
+        for (; i < block_end; i += 16) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            __m256i mx = _mm256_max_epu16(va, vb);
+            __m256i empty = _mm256_cmpeq_epi16(mx, zero);
+            __m256i equal = _mm256_andnot_si256(_mm256_cmpeq_epi16(va, zero), _mm256_cmpeq_epi16(va, vb));
+            stats.matches += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(equal))) / 2;
+            stats.union_zeros += std::popcount(static_cast<uint32_t>(_mm256_movemask_epi8(empty))) / 2;
+
+            __m256i rho = _mm256_srli_epi16(mx, HMH_MANTISSA_BITS);
+            __m256i rho_lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(rho));
+            __m256i rho_hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(rho, 1));
+            sum_lo = _mm256_add_ps(sum_lo, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_sub_epi32(bias, rho_lo), 23)));
+            sum_hi = _mm256_add_ps(sum_hi, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_sub_epi32(bias, rho_hi), 23)));
+        }
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, _mm256_add_ps(sum_lo, sum_hi));
+        for (float v : lanes) stats.union_harmonic += v;
+    }
+#endif
+    for (; i < m; ++i) {
+        uint16_t mx = std::max(a[i], b[i]);
+        stats.matches += (a[i] != 0 && a[i] == b[i]);
+        stats.union_zeros += (mx == 0);
+        stats.union_harmonic += HLL_INV_POW2[hmhRho(mx)];
+    }
+    stats.occupied = static_cast<uint32_t>(m) - stats.union_zeros;
+    return stats;
+}
+
+inline void hmhMergeMax(uint16_t* dst, const uint16_t* src, size_t m) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 16 <= m; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_max_epu16(a, b));
+    }
+#endif
+    for (; i < m; ++i) dst[i] = std::max(dst[i], src[i]);
+}
+
+// Ожидаемое число случайных совпадений регистров для независимых множеств
+// мощностей n и k (алгоритм из статьи HyperMinHash): сумма по всем значениям
+// регистра (rho, мантисса) вероятностей того, что оба минимума корзины
+// получили это значение. Доля хешей корзины со значением регистра (i, j) —
+// отрезок [(R + j) s, (R + j + 1) s), s = 2^-(b + r + i), R = 2^r; при
+// (1 - x)^n ~ exp(-n x) (ошибка порядка n s^2) слагаемые по j образуют
+// геометрическую прогрессию, и сумма по мантиссам берётся в замкнутом виде:
+// несколько экспонент на уровень rho вместо 2^r. Уровни, где минимум почти
+// наверняка меньше, дают ноль и пропускаются, а после пика вклад уровня
+// падает вчетверо на шаг, так что на пару уходит около десятка уровней.
+// Асимптотика из статьи для n > 2^(b+5) не нужна: формула точна и там.
+inline double hmhExpectedCollisions(double n, double k, uint32_t b) {
+    if (n < k) std::swap(n, k);
+    if (k < 1.0) return 0.0;
+    double m = static_cast<double>(1u << b);
+    const double r_pow = static_cast<double>(1u << HMH_MANTISSA_BITS);
+
+    double x = 0.0;
+    uint32_t max_rho = 64 - b + 1;
+    for (uint32_t i = 1; i <= max_rho; ++i) {
+        double s = std::ldexp(1.0, -static_cast<int>(b + HMH_MANTISSA_BITS + i));
+        double both = (n + k) * s;
+        if (both * r_pow > 700.0) continue;
+        // sum_{j=1..R} G^j = G (1 - G^R) / (1 - G), G = exp(-(n + k) s).
+        double series = std::exp(-both) * std::expm1(-both * r_pow) / std::expm1(-both);
+        double level = std::exp(-both * r_pow) * std::expm1(-n * s) * std::expm1(-k * s) * series;
+        x += level;
+        if (both * r_pow < 1.0 && level < x * 1e-12) break;
+    }
+    return x * m;
+}
+
+class HyperMinHash {
+private:
+    uint32_t b;
+    uint32_t m;
+    std::vector<uint16_t> M;
+    HllHistogram histogram;
+
+    static double estimateFrom(double harmonic, uint32_t zeros, uint32_t b) {
+        uint32_t m = 1u << b;
+        return hllPlusPlusEstimate(hllAlphaM(m) * m * m / harmonic, zeros, b, m);
+    }
+
+public:
+    HyperMinHash(uint32_t b_bits) : b(std::max(b_bits, HMH_MIN_B)), m(1u << b), M(m, 0) {
+        histogram.reset(m);
+    }
+
+    void add(uint64_t hash) {
+        uint32_t j = static_cast<uint32_t>(hash >> (64 - b));
+        updateRegister(j, hmhRegister(hash << b, b));
+    }
+
+    void addBatch(std::span<const uint64_t> hashes) {
+        for (uint64_t h : hashes) add(h);
+    }
+
+    double estimate() const {
+        return estimateFrom(histogram.harmonicSum(), histogram.zeros(), b);
+    }
+
+    // Гистограмма ведётся по rho, так что годятся и оценки Эртла.
+    double estimate(HllEstimator method) const {
+        if (method == HllEstimator::Classic) return estimate();
+        return hllEstimateFromHistogram(method, histogram, b, 64);
+    }
+
+    // Объединяет с other той же точности; false, если точности различаются.
+    bool merge(const HyperMinHash& other) {
+        if (other.b != b) return false;
+        hmhMergeMax(M.data(), other.M.data(), m);
+        histogram.reset(m);
+        histogram.counts[0] = 0;
+        for (uint16_t reg : M) ++histogram.counts[hmhRho(reg)];
+        return true;
+    }
+
+    // Оценки для пары скетчей одной точности; при разных точностях — 0.
+    static double unionEstimate(const HyperMinHash& x, const HyperMinHash& y) {
+        if (x.b != y.b) return 0.0;
+        HmhPairStats stats = hmhCompare(x.M.data(), y.M.data(), x.m);
+        return estimateFrom(stats.union_harmonic, stats.union_zeros, x.b);
+    }
+
+    static double jaccard(const HyperMinHash& x, const HyperMinHash& y) {
+        if (x.b != y.b) return 0.0;
+        return jaccardFrom(hmhCompare(x.M.data(), y.M.data(), x.m), x.estimate(), y.estimate(), x.b);
+    }
+
+    static double intersectionEstimate(const HyperMinHash& x, const HyperMinHash& y) {
+        if (x.b != y.b) return 0.0;
+        HmhPairStats stats = hmhCompare(x.M.data(), y.M.data(), x.m);
+        return jaccardFrom(stats, x.estimate(), y.estimate(), x.b) *
+               estimateFrom(stats.union_harmonic, stats.union_zeros, x.b);
+    }
+
+    // |X \ Y| = |X| - |X ∩ Y|.
+    static double differenceEstimate(const HyperMinHash& x, const HyperMinHash& y) {
+        return std::max(0.0, x.estimate() - intersectionEstimate(x, y));
+    }
+
+    static double jaccardFrom(const HmhPairStats& stats, double card_x, double card_y, uint32_t b) {
+        if (stats.occupied == 0 || stats.matches == 0) return 0.0;
+        double collisions = hmhExpectedCollisions(card_x, card_y, b);
+        return std::clamp((stats.matches - collisions) / stats.occupied, 0.0, 1.0);
+    }
+
+    uint32_t getB() const {
+        return b;
+    }
+
+    const uint16_t* data() const {
+        return M.data();
+    }
+
+    void reset() {
+        std::fill(M.begin(), M.end(), 0);
+        histogram.reset(m);
+    }
+
+    bool validateHistogram() const {
+        HllHistogram expected;
+        for (uint16_t reg : M) ++expected.counts[hmhRho(reg)];
+        return expected == histogram;
+    }
+
+    size_t getMemoryUsage() const {
+        return M.size() * sizeof(uint16_t);
+    }
+
+private:
+    void updateRegister(uint32_t j, uint16_t reg) {
+        if (reg > M[j]) {
+            histogram.update(hmhRho(M[j]), hmhRho(reg));
+            M[j] = reg;
+        }
+    }
+};
+
+// Матрица коэффициентов Жаккара для всех пар: оценки мощностей считаются один
+// раз на скетч, на пару остаётся один SIMD-проход по регистрам.
+// out[i * n + j] — оценка для пары (i, j); диагональ равна 1.
+inline void hmhJaccardMatrix(std::span<const HyperMinHash> sketches, std::vector<double>& out) {
+    size_t n = sketches.size();
+    out.assign(n * n, 0.0);
+    if (n == 0) return;
+    uint32_t b = sketches[0].getB();
+    size_t m = size_t(1) << b;
+    std::vector<double> cards(n);
+    for (size_t i = 0; i < n; ++i) cards[i] = sketches[i].estimate();
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i * n + i] = 1.0;
+        for (size_t j = i + 1; j < n; ++j) {
+            if (sketches[i].getB() != b || sketches[j].getB() != b) continue;
+            HmhPairStats stats = hmhCompare(sketches[i].data(), sketches[j].data(), m);
+            double jac = HyperMinHash::jaccardFrom(stats, cards[i], cards[j], b);
+            out[i * n + j] = jac;
+            out[j * n + i] = jac;
+        }
+    }
+}
+
+#endif
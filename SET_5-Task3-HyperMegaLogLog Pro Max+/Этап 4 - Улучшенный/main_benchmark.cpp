@@ -0,0 +1,317 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "hll_batch.h"
+#include "hll_histogram.h"
+#include "hll_packing.h"
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hash_function.h"
+
+// Замеры производительности для сравнения ревизий: нс на add() и addBatch(),
+// на estimate() и merge(), память скетча при B = 4..18, addBatch() без
+// prefetch и с ним при B = 14..24, скорость хеширования ключей разной длины. Каждый замер повторяется, в отчёт идёт медиана.
+//   warm — скетч (или ключи) уже в кэше: операции идут подряд по одному скетчу;
+//   cold — перед каждым замером кэш вытесняется записью буфера в 32 МБ,
+//          замеряется короткая серия операций (для ключей — поток из памяти).
+// Результаты пишутся в CSV и JSON с одинаковыми полями.
+//
+//   main_benchmark [--quick] [--csv файл] [--json файл]
+
+struct BenchResult {
+    std::string operation;
+    std::string subject;
+    uint32_t b;
+    uint32_t key_bytes;
+    const char* cache;
+    double ns_per_op;
+    size_t bytes;
+};
+
+struct BenchConfig {
+    size_t adds = size_t(1) << 20;
+    size_t warm_repeats = 5;
+    size_t cold_repeats = 9;
+    size_t cold_adds = 256;
+    size_t estimate_calls = 20000;
+};
+
+template <class F>
+double measureNs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double median(std::vector<double> values) {
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+// Запись буфера больше кэша последнего уровня вытесняет из кэша всё остальное.
+class CacheEvictor {
+private:
+    std::vector<uint64_t> buffer;
+
+public:
+    explicit CacheEvictor(size_t bytes) : buffer(bytes / sizeof(uint64_t), 0) {}
+
+    void evict() {
+        for (uint64_t& word : buffer) ++word;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+};
+
+volatile double benchmark_sink = 0.0;
+
+template <class Sketch>
+void benchSketch(const char* name, uint32_t b, const std::vector<uint32_t>& hashes,
+                 const BenchConfig& config, CacheEvictor& evictor, std::vector<BenchResult>& out) {
+    const uint32_t m = 1u << b;
+    auto record = [&](const char* operation, const char* cache, double ns, size_t bytes) {
+        out.push_back({operation, name, b, 0, cache, ns, bytes});
+    };
+
+    std::vector<double> add_ns, batch_ns;
+    for (size_t r = 0; r < config.warm_repeats; ++r) {
+        Sketch single(b);
+        add_ns.push_back(measureNs([&] {
+            for (uint32_t h : hashes) single.add(h);
+        }) / hashes.size());
+        Sketch batch(b);
+        batch_ns.push_back(measureNs([&] { batch.addBatch(hashes); }) / hashes.size());
+    }
+
+    Sketch filled(b);
+    filled.addBatch(hashes);
+    Sketch other(b);
+    for (uint32_t h : hashes) other.add(h * 0x9E3779B1u);
+    const size_t bytes = filled.getMemoryUsage();
+    record("add", "warm", median(add_ns), bytes);
+    record("add_batch", "warm", median(batch_ns), bytes);
+
+    std::vector<double> estimate_ns, merge_ns;
+    const size_t merges = std::max<size_t>(16, (size_t(1) << 22) / m);
+    for (size_t r = 0; r < config.warm_repeats; ++r) {
+        estimate_ns.push_back(measureNs([&] {
+            double sum = 0.0;
+            for (size_t i = 0; i < config.estimate_calls; ++i) sum += filled.estimate();
+            benchmark_sink = sum;
+        }) / config.estimate_calls);
+        Sketch target = filled;
+        merge_ns.push_back(measureNs([&] {
+            for (size_t i = 0; i < merges; ++i) target.merge(other);
+        }) / merges);
+    }
+    record("estimate", "warm", median(estimate_ns), bytes);
+    record("merge", "warm", median(merge_ns), bytes);
+
+    std::vector<double> cold_add, cold_estimate, cold_merge;
+    for (size_t r = 0; r < config.cold_repeats; ++r) {
+        Sketch target = filled;
+        size_t offset = (r * config.cold_adds) % (hashes.size() - config.cold_adds);
+        evictor.evict();
+        cold_add.push_back(measureNs([&] {
+            for (size_t i = 0; i < config.cold_adds; ++i) target.add(hashes[offset + i] * 0x85EBCA6Bu);
+        }) / config.cold_adds);
+        evictor.evict();
+        cold_estimate.push_back(measureNs([&] { benchmark_sink = target.estimate(); }));
+        evictor.evict();
+        cold_merge.push_back(measureNs([&] { target.merge(other); }));
+    }
+    record("add", "cold", median(cold_add), bytes);
+    record("estimate", "cold", median(cold_estimate), bytes);
+    record("merge", "cold", median(cold_merge), bytes);
+}
+
+// addBatch() скетча с prefetch, принудительно выключенным и включённым: тот же
+// проход hllForEachBlock и то же обновление регистра и гистограммы, что в
+// HllRegisterSketch. Показывает, с какого размера массива регистров prefetch
+// окупается (HLL_PREFETCH_MIN_BYTES).
+template <class Storage>
+void benchPrefetch(const char* name, uint32_t b, const std::vector<uint32_t>& hashes,
+                   const BenchConfig& config, std::vector<BenchResult>& out) {
+    const uint32_t m = 1u << b;
+    std::vector<double> plain_ns, prefetch_ns;
+    size_t bytes = 0;
+    for (size_t r = 0; r < config.warm_repeats; ++r) {
+        for (bool prefetch : {false, true}) {
+            Storage registers;
+            registers.reset(m);
+            HllHistogram histogram;
+            histogram.reset(m);
+            bytes = registers.getMemoryUsage();
+            double ns = measureNs([&] {
+                hllForEachBlock(hashes, b, prefetch,
+                    [&registers](uint32_t j) { registers.prefetch(j); },
+                    [&registers, &histogram](uint32_t j, uint8_t rank) {
+                        rank = std::min(rank, Storage::MAX_VALUE);
+                        uint8_t old_val = registers.get(j);
+                        if (rank > old_val) {
+                            histogram.update(old_val, rank);
+                            registers.set(j, rank);
+                        }
+                    });
+            }) / hashes.size();
+            benchmark_sink = histogram.zeros();
+            (prefetch ? prefetch_ns : plain_ns).push_back(ns);
+        }
+    }
+    out.push_back({"add_batch_plain", name, b, 0, "warm", median(plain_ns), bytes});
+    out.push_back({"add_batch_prefetch", name, b, 0, "warm", median(prefetch_ns), bytes});
+}
+
+void benchHash(const char* name, HashMode mode, uint32_t key_bytes, size_t arena_bytes, const char* cache,
+               size_t repeats, std::vector<BenchResult>& out) {
+    const HashFuncGen hash_func(0x9e3779b97f4a7c15ULL, 0x517cc1b727220a95ULL, mode);
+    const size_t keys = std::max<size_t>(1024, arena_bytes / key_bytes);
+    std::vector<char> arena(keys * key_bytes);
+    for (size_t i = 0; i < arena.size(); i += sizeof(uint64_t)) {
+        uint64_t word = splitmix64(i);
+        std::memcpy(arena.data() + i, &word, std::min(sizeof(word), arena.size() - i));
+    }
+    std::vector<uint32_t> offsets(keys + 1);
+    for (size_t i = 0; i <= keys; ++i) offsets[i] = static_cast<uint32_t>(i * key_bytes);
+    std::vector<uint32_t> hashes(keys);
+
+    std::vector<double> single_ns, batch_ns;
+    for (size_t r = 0; r < repeats; ++r) {
+        single_ns.push_back(measureNs([&] {
+            uint32_t acc = 0;
+            for (size_t i = 0; i < keys; ++i) acc ^= hash_func.hash(arena.data() + offsets[i], key_bytes);
+            benchmark_sink = acc;
+        }) / keys);
+        batch_ns.push_back(measureNs([&] { hash_func.hashBatch(arena, offsets, hashes); }) / keys);
+    }
+    out.push_back({"hash", name, 0, key_bytes, cache, median(single_ns), 0});
+    out.push_back({"hash_batch", name, 0, key_bytes, cache, median(batch_ns), 0});
+}
+
+void writeCsv(const std::string& filename, const std::vector<BenchResult>& results) {
+    std::ofstream file(filename);
+    file << "operation,subject,b,key_bytes,cache,ns_per_op,bytes\n";
+    for (const BenchResult& r : results) {
+        file << r.operation << "," << r.subject << "," << r.b << "," << r.key_bytes << ","
+             << r.cache << "," << std::setprecision(4) << r.ns_per_op << "," << r.bytes << "\n";
+    }
+}
+
+void writeJson(const std::string& filename, const std::vector<BenchResult>& results) {
+    std::ofstream file(filename);
+#if defined(__AVX2__)
+    const bool avx2 = true;
+#else
+    const bool avx2 = false;
+#endif
+    file << "{\n  \"avx2\": " << (avx2 ? "true" : "false") << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        file << "    {\"operation\": \"" << r.operation << "\", \"subject\": \"" << r.subject
+             << "\", \"b\": " << r.b << ", \"key_bytes\": " << r.key_bytes
+             << ", \"cache\": \"" << r.cache << "\", \"ns_per_op\": " << std::setprecision(4) << r.ns_per_op
+             << ", \"bytes\": " << r.bytes << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    std::string csv_name = "benchmark_results.csv";
+    std::string json_name = "benchmark_results.json";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quick") {
+            config.adds = size_t(1) << 18;
+            config.warm_repeats = 3;
+            config.cold_repeats = 3;
+            config.estimate_calls = 2000;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csv_name = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_name = argv[++i];
+        } else {
+            std::cerr << "Использование: main_benchmark [--quick] [--csv файл] [--json файл]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Производительность HyperLogLog" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    const size_t evict_bytes = size_t(32) << 20;
+    CacheEvictor evictor(evict_bytes);
+    std::vector<BenchResult> results;
+
+    std::vector<uint32_t> hashes(config.adds);
+    for (size_t i = 0; i < hashes.size(); ++i) hashes[i] = static_cast<uint32_t>(splitmix64(i));
+
+    std::cout << "\nнс на операцию (warm / cold), add по " << config.adds << " хешам" << std::endl;
+    std::cout << "   B  скетч                       add   addBatch        estimate             merge     байт" << std::endl;
+    for (uint32_t b = 4; b <= 18; ++b) {
+        size_t first = results.size();
+        benchSketch<HyperLogLog>("HyperLogLog", b, hashes, config, evictor, results);
+        benchSketch<HyperLogLogImproved>("HyperLogLogImproved", b, hashes, config, evictor, results);
+        benchSketch<HyperLogLogCompact>("HyperLogLogCompact", b, hashes, config, evictor, results);
+        // По 7 записей на скетч: add, add_batch, estimate, merge тёплые, затем холодные.
+        for (size_t i = first; i < results.size(); i += 7) {
+            const BenchResult* r = &results[i];
+            std::cout << std::setw(4) << b << "  " << std::setw(20) << std::left << r[0].subject << std::right
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(6) << r[0].ns_per_op << "/" << std::setw(5) << r[4].ns_per_op
+                      << std::setw(8) << r[1].ns_per_op
+                      << std::setw(9) << r[2].ns_per_op << "/" << std::setw(6) << r[5].ns_per_op
+                      << std::setw(10) << r[3].ns_per_op << "/" << std::setw(7) << r[6].ns_per_op
+                      << std::setw(9) << r[0].bytes << std::endl;
+        }
+    }
+
+    std::cout << "\naddBatch без prefetch и с ним, нс на хеш; сейчас prefetch включается от "
+              << (HLL_PREFETCH_MIN_BYTES >> 10) << " КБ" << std::endl;
+    std::cout << "   B  регистры          байт   без prefetch   с prefetch" << std::endl;
+    for (uint32_t b = 14; b <= 24; ++b) {
+        size_t first = results.size();
+        benchPrefetch<HllByteRegisters>("HllByteRegisters", b, hashes, config, results);
+        benchPrefetch<HllBitstream6Registers>("HllBitstream6Registers", b, hashes, config, results);
+        for (size_t i = first; i < results.size(); i += 2) {
+            const BenchResult* r = &results[i];
+            std::cout << std::setw(4) << b << "  " << std::setw(16) << std::left
+                      << (r[0].subject == "HllByteRegisters" ? "байт" : "6 бит") << std::right
+                      << std::setw(10) << r[0].bytes << std::setprecision(2)
+                      << std::setw(15) << r[0].ns_per_op << std::setw(13) << r[1].ns_per_op
+                      << (r[0].bytes >= HLL_PREFETCH_MIN_BYTES ? "   *" : "") << std::endl;
+        }
+    }
+
+    std::cout << "\nХеширование, нс на ключ (warm: 1 МБ ключей, cold: " << (evict_bytes >> 20)
+              << " МБ из памяти)" << std::endl;
+    std::cout << "  режим      байт   hash warm  hash cold  batch warm  batch cold    ГБ/с" << std::endl;
+    const std::pair<const char*, HashMode> modes[] = {{"Bytewise", HashMode::Bytewise}, {"Wide", HashMode::Wide}};
+    for (const auto& [mode_name, mode] : modes) {
+        for (uint32_t key_bytes : {4u, 8u, 16u, 32u, 64u, 256u, 1024u}) {
+            size_t first = results.size();
+            benchHash(mode_name, mode, key_bytes, size_t(1) << 20, "warm", config.warm_repeats, results);
+            benchHash(mode_name, mode, key_bytes, evict_bytes, "cold", config.cold_repeats / 3 + 1, results);
+            const BenchResult* r = &results[first];
+            std::cout << "  " << std::setw(9) << std::left << mode_name << std::right
+                      << std::setw(6) << key_bytes << std::setprecision(2)
+                      << std::setw(11) << r[0].ns_per_op << std::setw(11) << r[2].ns_per_op
+                      << std::setw(12) << r[1].ns_per_op << std::setw(12) << r[3].ns_per_op
+                      << std::setw(8) << key_bytes / r[1].ns_per_op << std::endl;
+        }
+    }
+
+    writeCsv(csv_name, results);
+    writeJson(json_name, results);
+    std::cout << "\nРезультаты сохранены в " << csv_name << " и " << json_name << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include "hyperloglog64.h"
+#include "hash_function.h"
+
+// Строит таблицы смещения для hll_bias_tables.h так же, как в HyperLogLog++:
+// для каждой точности прогоняет много потоков, в контрольных точках до 6m
+// запоминает сырую оценку и её отклонение от истинной мощности и усредняет.
+
+const size_t POINTS = 100;
+const uint64_t ADDS_PER_PRECISION = 1ull << 24;
+
+struct BiasAccumulator {
+    double raw_sum = 0.0;
+    double bias_sum = 0.0;
+};
+
+std::vector<HllBiasPoint> calibrate(uint32_t b, uint64_t seed) {
+    uint32_t m = 1u << b;
+    uint64_t max_n = 6ull * m;
+    uint64_t runs = std::max<uint64_t>(64, ADDS_PER_PRECISION / m);
+
+    std::vector<BiasAccumulator> acc(POINTS);
+    HyperLogLog64 hll(b);
+
+    for (uint64_t run = 0; run < runs; ++run) {
+        hll.reset();
+        uint64_t base = splitmix64(seed ^ (run * 0x2545f4914f6cdd1dULL));
+        size_t point = 0;
+        for (uint64_t n = 1; n <= max_n; ++n) {
+            hll.add(splitmix64(base + n));
+            while (point < POINTS && n * POINTS >= (point + 1) * max_n) {
+                double raw = hll.rawEstimate();
+                acc[point].raw_sum += raw;
+                acc[point].bias_sum += raw - static_cast<double>(n);
+                ++point;
+            }
+        }
+    }
+
+    std::vector<HllBiasPoint> table;
+    for (const auto& a : acc) {
+        table.push_back({a.raw_sum / runs, a.bias_sum / runs});
+    }
+    return table;
+}
+
+int main() {
+    const uint64_t seed = 0x5eed5eed5eed5eedULL;
+
+    std::ofstream out("hll_bias_tables.h");
+    out << "#ifndef HLL_BIAS_TABLES_H\n"
+        << "#define HLL_BIAS_TABLES_H\n\n"
+        << "#include <cstdint>\n"
+        << "#include <span>\n\n"
+        << "// Сгенерировано main_bias_calibration.cpp, вручную не править.\n\n"
+        << "struct HllBiasPoint {\n"
+        << "    double raw_estimate;\n"
+        << "    double bias;\n"
+        << "};\n\n";
+
+    for (uint32_t b = HLL_PP_MIN_B; b <= HLL_PP_MAX_B; ++b) {
+        std::cout << "Калибровка B = " << b << "..." << std::endl;
+        auto table = calibrate(b, seed + b);
+        out << "inline constexpr HllBiasPoint HLL_BIAS_B" << b << "[] = {\n";
+        for (size_t i = 0; i < table.size(); ++i) {
+            out << (i % 3 == 0 ? "    " : " ")
+                << std::fixed << std::setprecision(2)
+                << "{" << table[i].raw_estimate << ", " << table[i].bias << "},"
+                << (i % 3 == 2 || i + 1 == table.size() ? "\n" : "");
+        }
+        out << "};\n\n";
+    }
+
+    out << "inline std::span<const HllBiasPoint> hllBiasTable(uint32_t b) {\n"
+        << "    switch (b) {\n";
+    for (uint32_t b = HLL_PP_MIN_B; b <= HLL_PP_MAX_B; ++b) {
+        out << "        case " << b << ": return HLL_BIAS_B" << b << ";\n";
+    }
+    out << "        default: return {};\n"
+        << "    }\n"
+        << "}\n\n"
+        << "#endif\n";
+
+    std::cout << "Таблицы сохранены в hll_bias_tables.h" << std::endl;
+    return 0;
+}
@@ -0,0 +1,236 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hll_checkpoint.h"
+#include "hash_function.h"
+
+// Контрольные точки для репликации: размер полной точки и дельты против
+// записи serialize(), скорость кодирования и восстановления при B = 4..18.
+// Скетч набирает 10m различных элементов (установившийся режим), затем между
+// снимками добавляется ещё 1 % — столько меняется за один такт репликации.
+// Восстановленная реплика сверяется с исходником по serialize().
+// Для сравнения приводится энтропия значений регистров — нижняя граница
+// статического кодера.
+
+template <class F>
+double measureNs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+// Медиана нс на регистр по нескольким повторам; повторов тем больше, чем
+// меньше скетч, чтобы каждый замер шёл хотя бы ~1 мс.
+template <class F>
+double nsPerRegister(uint32_t m, F&& f) {
+    const size_t inner = std::max<size_t>(1, (size_t(1) << 18) / m);
+    std::vector<double> samples;
+    for (int r = 0; r < 7; ++r) {
+        samples.push_back(measureNs([&] {
+            for (size_t i = 0; i < inner; ++i) f();
+        }) / (static_cast<double>(inner) * m));
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+double registerEntropyBytes(const std::vector<uint8_t>& record) {
+    HllRecordView view = *HllRecordView::parse(record);
+    const uint32_t m = view.registerCount();
+    std::vector<uint8_t> regs(m);
+    if (view.kind == HllSketchKind::HyperLogLogCompact) {
+        hllUnpackBitstream6(view.bitstream(), regs.data(), m);
+    } else {
+        std::copy(view.registers(), view.registers() + m, regs.begin());
+    }
+    HllHistogram hist = hllHistogramOf(regs.data(), m);
+    double bits = 0.0;
+    for (uint32_t count : hist.counts) {
+        if (count != 0) bits -= count * std::log2(static_cast<double>(count) / m);
+    }
+    return bits / 8;
+}
+
+struct CheckpointRow {
+    const char* sketch;
+    uint32_t b;
+    size_t record_bytes;
+    size_t full_bytes;
+    double entropy_bytes;
+    size_t delta_bytes;
+    uint32_t changed;
+    double full_encode_ns;
+    double full_restore_ns;
+    double delta_encode_ns;
+    double delta_restore_ns;
+    bool exact;
+};
+
+volatile size_t checkpoint_sink = 0;
+
+template <class Sketch>
+CheckpointRow benchCheckpoint(const char* name, uint32_t b) {
+    const uint32_t m = 1u << b;
+    const uint64_t items = 10ull * m;
+    const uint64_t step = std::max<uint64_t>(1, items / 100);
+
+    Sketch base(b);
+    for (uint64_t i = 0; i < items; ++i) base.add(static_cast<uint32_t>(splitmix64(i)));
+    Sketch current = base;
+    for (uint64_t i = items; i < items + step; ++i) current.add(static_cast<uint32_t>(splitmix64(i)));
+
+    CheckpointRow row{name, b, current.serialize().size(), 0, registerEntropyBytes(current.serialize()),
+                      0, 0, 0, 0, 0, 0, false};
+    std::vector<uint8_t> base_record = base.serialize();
+    std::vector<uint8_t> current_record = current.serialize();
+    HllRecordView base_view = *HllRecordView::parse(base_record);
+    HllRecordView current_view = *HllRecordView::parse(current_record);
+    std::vector<uint8_t> base_regs(m), current_regs(m);
+    if (base_view.kind == HllSketchKind::HyperLogLogCompact) {
+        hllUnpackBitstream6(base_view.bitstream(), base_regs.data(), m);
+        hllUnpackBitstream6(current_view.bitstream(), current_regs.data(), m);
+    } else {
+        std::copy(base_view.registers(), base_view.registers() + m, base_regs.begin());
+        std::copy(current_view.registers(), current_view.registers() + m, current_regs.begin());
+    }
+    for (uint32_t i = 0; i < m; ++i) row.changed += base_regs[i] != current_regs[i];
+
+    std::vector<uint8_t> full = current.checkpoint();
+    std::vector<uint8_t> delta = current.checkpoint(base);
+    row.full_bytes = full.size();
+    row.delta_bytes = delta.size();
+
+    // Реплика восстанавливает base полной точкой и догоняет current дельтой;
+    // вторая реплика получает current сразу полной точкой. Дельта (если она
+    // не выродилась в полную точку) не должна применяться к пустому скетчу.
+    Sketch replica(b);
+    Sketch fresh(b);
+    Sketch empty(b);
+    bool is_delta = HllCheckpointView::parse(delta)->type == HllCheckpointType::Delta;
+    row.exact = replica.restore(base.checkpoint()) && replica.restore(delta) &&
+                replica.serialize() == current_record && fresh.restore(full) &&
+                fresh.serialize() == current_record && replica.validateHistogram() &&
+                !(is_delta && row.changed > 0 && empty.restore(delta));
+
+    row.full_encode_ns = nsPerRegister(m, [&] { checkpoint_sink = current.checkpoint().size(); });
+    row.delta_encode_ns = nsPerRegister(m, [&] { checkpoint_sink = current.checkpoint(base).size(); });
+    row.full_restore_ns = nsPerRegister(m, [&] { checkpoint_sink = fresh.restore(full); });
+    std::vector<uint8_t> base_checkpoint = base.checkpoint();
+    Sketch at_base(b);
+    at_base.restore(base_checkpoint);
+    row.delta_restore_ns = nsPerRegister(m, [&] {
+        Sketch copy = at_base;
+        checkpoint_sink = copy.restore(delta);
+    });
+    return row;
+}
+
+// Точки с регистром выше hllMaxRegisterValue(b) — полная без сжатия, полная
+// rANS и дельта — restore() должен отвергать, не меняя регистров; запись
+// такого скетча иначе не прошла бы HllRecordView::parse.
+template <class Sketch>
+bool checkCorrupt(const char* name, uint32_t b) {
+    const uint32_t m = 1u << b;
+    Sketch sketch(b);
+    for (uint64_t i = 0; i < 10ull * m; ++i) sketch.add(static_cast<uint32_t>(splitmix64(i)));
+    std::vector<uint8_t> record = sketch.serialize();
+    HllRecordView view = *HllRecordView::parse(record);
+
+    std::vector<uint8_t> regs(m);
+    if (view.kind == HllSketchKind::HyperLogLogCompact) {
+        hllUnpackBitstream6(view.bitstream(), regs.data(), m);
+    } else {
+        std::copy(view.registers(), view.registers() + m, regs.begin());
+    }
+    regs[m / 2] = hllMaxRegisterValue(b) + 1;
+    std::vector<uint8_t> forged_payload(view.payload.begin(), view.payload.end());
+    if (view.kind == HllSketchKind::HyperLogLogCompact) {
+        hllPackBitstream6(regs.data(), forged_payload.data(), m);
+    } else {
+        forged_payload = regs;
+    }
+    HllRecordView forged{view.kind, b, forged_payload};
+
+    const std::vector<std::vector<uint8_t>> corrupt = {
+        hllCheckpointBytes(forged, HllCheckpointType::Full, HllCheckpointCoding::Raw, 0, forged.payload),
+        hllEncodeCheckpoint(forged),
+        hllEncodeCheckpoint(forged, &view),
+    };
+    bool rejected = true;
+    for (const std::vector<uint8_t>& bytes : corrupt) {
+        Sketch target = sketch;
+        rejected &= !target.restore(bytes) && target.serialize() == record && !target.checkpoint().empty();
+    }
+    std::cout << "  " << std::setw(19) << std::left << name << std::right << std::setw(3) << b
+              << "   регистр " << int(hllMaxRegisterValue(b) + 1) << ": "
+              << (rejected ? "отвергается" : "ПРИНЯТ") << std::endl;
+    return rejected;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Контрольные точки HyperLogLog" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::vector<CheckpointRow> rows;
+    for (uint32_t b = 4; b <= 18; b += 2) {
+        rows.push_back(benchCheckpoint<HyperLogLog>("HyperLogLog", b));
+        rows.push_back(benchCheckpoint<HyperLogLogCompact>("HyperLogLogCompact", b));
+    }
+
+    std::cout << "\n  скетч                B   запись   полная  энтропия   бит/рег   дельта  изменено"
+              << "   нс/рег: полная код/восст   дельта код/восст" << std::endl;
+    bool ok = true;
+    for (const CheckpointRow& row : rows) {
+        ok &= row.exact;
+        const uint32_t m = 1u << row.b;
+        std::cout << "  " << std::setw(19) << std::left << row.sketch << std::right << std::setw(3) << row.b
+                  << std::setw(9) << row.record_bytes << std::setw(9) << row.full_bytes
+                  << std::fixed << std::setprecision(0) << std::setw(10) << row.entropy_bytes
+                  << std::setprecision(2) << std::setw(10)
+                  << (row.full_bytes - sizeof(HllCheckpointHeader)) * 8.0 / m
+                  << std::setw(9) << row.delta_bytes << std::setw(10) << row.changed
+                  << std::setw(17) << row.full_encode_ns << " /" << std::setw(5) << row.full_restore_ns
+                  << std::setw(13) << row.delta_encode_ns << " /" << std::setw(5) << row.delta_restore_ns
+                  << (row.exact ? "" : "   РАСХОЖДЕНИЕ") << std::endl;
+    }
+
+    std::cout << "\nТочки с регистром вне диапазона для B:" << std::endl;
+    for (uint32_t b : {4u, 14u}) {
+        ok &= checkCorrupt<HyperLogLog>("HyperLogLog", b);
+        ok &= checkCorrupt<HyperLogLogImproved>("HyperLogLogImproved", b);
+        ok &= checkCorrupt<HyperLogLogCompact>("HyperLogLogCompact", b);
+    }
+    // Запись при b выше HLL_FORMAT_MAX_B не разбирается, точки нет.
+    bool beyond_format = HyperLogLogCompact(HLL_FORMAT_MAX_B + 1).checkpoint().empty();
+    ok &= beyond_format;
+    std::cout << "  HyperLogLogCompact B = " << HLL_FORMAT_MAX_B + 1 << ": "
+              << (beyond_format ? "точки нет" : "ТОЧКА ЕСТЬ") << std::endl;
+
+    std::ofstream file("checkpoint_results.csv");
+    file << "sketch,b,record_bytes,full_bytes,entropy_bytes,delta_bytes,changed_registers,"
+            "full_encode_ns_per_register,full_restore_ns_per_register,"
+            "delta_encode_ns_per_register,delta_restore_ns_per_register,exact\n";
+    for (const CheckpointRow& row : rows) {
+        file << row.sketch << "," << row.b << "," << row.record_bytes << "," << row.full_bytes << ","
+             << row.entropy_bytes << "," << row.delta_bytes << "," << row.changed << ","
+             << row.full_encode_ns << "," << row.full_restore_ns << ","
+             << row.delta_encode_ns << "," << row.delta_restore_ns << "," << row.exact << "\n";
+    }
+    std::cout << "\nРезультаты сохранены в checkpoint_results.csv" << std::endl;
+    if (!ok) {
+        std::cout << "\nРеплика расходится с исходным скетчем или принята повреждённая точка!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -1,13 +1,23 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
-#include <unordered_set>
 #include <cmath>
 #include <chrono>
+#include <array>
+#include <cstdlib>
+#include <thread>
 #include "hyperloglog.h"
 #include "hyperloglog_improved.h"
 #include "stream_generator.h"
+#include "exact_counter.h"
 #include "hash_function.h"
+#include "hll_experiment.h"
+
+// Эксперименты выполняются параллельно через hllRunExperiments: у каждого своё
+// зерно, а статистика копится по Уэлфорду в порядке номеров экспериментов,
+// поэтому результаты не зависят от числа потоков и не хранятся целиком.
+//
+//   main_comparison [экспериментов в прогоне по сетке] [потоков]
 
 struct ExperimentResult {
     size_t step;
@@ -17,6 +27,21 @@ struct ExperimentResult {
     double hll_compact;
 };
 
+// Статистика одного шага по всем экспериментам.
+struct StepStats {
+    HllWelford true_count;
+    HllWelford hll_standard;
+    HllWelford hll_improved;
+    HllWelford hll_compact;
+
+    void add(const ExperimentResult& result) {
+        true_count.add(static_cast<double>(result.true_count));
+        hll_standard.add(result.hll_standard);
+        hll_improved.add(result.hll_improved);
+        hll_compact.add(result.hll_compact);
+    }
+};
+
 std::vector<ExperimentResult> runComparison(
     const std::vector<std::string>& stream,
     HyperLogLog& hll_std,
@@ -26,57 +51,243 @@ std::vector<ExperimentResult> runComparison(
     double step_percentage) {
     
     std::vector<ExperimentResult> results;
-    std::unordered_set<std::string> unique_set;
+    ExactDistinctCounter unique_set;
+    unique_set.reserve(stream.size());
     
     size_t step_size = static_cast<size_t>(stream.size() * step_percentage);
     if (step_size == 0) step_size = 1;
     
-    for (size_t i = 0; i < stream.size(); ++i) {
-        const auto& item = stream[i];
-        uint32_t hash_val = hash_func.hash(item);
-        
-        unique_set.insert(item);
-        hll_std.add(hash_val);
-        hll_imp.add(hash_val);
-        hll_cmp.add(hash_val);
+    std::vector<uint32_t> hashes;
+    hashes.reserve(step_size);
+    
+    for (size_t begin = 0; begin < stream.size(); begin += step_size) {
+        size_t end = std::min(begin + step_size, stream.size());
         
-        if ((i + 1) % step_size == 0 || i == stream.size() - 1) {
-            ExperimentResult result;
-            result.step = i + 1;
-            result.true_count = unique_set.size();
-            result.hll_standard = hll_std.estimate();
-            result.hll_improved = hll_imp.estimate();
-            result.hll_compact = hll_cmp.estimate();
-            results.push_back(result);
+        hashes.clear();
+        for (size_t i = begin; i < end; ++i) {
+            const auto& item = stream[i];
+            hashes.push_back(hash_func.hash(item));
+            unique_set.insert(item);
         }
+        
+        hll_std.addBatch(hashes);
+        hll_imp.addBatch(hashes);
+        hll_cmp.addBatch(hashes);
+        
+        ExperimentResult result;
+        result.step = end;
+        result.true_count = unique_set.size();
+        result.hll_standard = hll_std.estimate();
+        result.hll_improved = hll_imp.estimate();
+        result.hll_compact = hll_cmp.estimate();
+        results.push_back(result);
     }
     
     return results;
 }
 
-void saveComparisonResults(const std::string& filename, 
-                           const std::vector<std::vector<ExperimentResult>>& all_results) {
+void appendComparisonResults(std::ofstream& file, size_t exp,
+                             const std::vector<ExperimentResult>& results) {
+    for (const auto& result : results) {
+        file << exp << ","
+             << result.step << ","
+             << result.true_count << ","
+             << std::fixed << std::setprecision(2)
+             << result.hll_standard << ","
+             << result.hll_improved << ","
+             << result.hll_compact << "\n";
+    }
+}
+
+// Прогон по сетке: для каждого размера потока experiments потоков строк, и
+// каждый поток один раз хешируется и идёт во все скетчи всех точностей.
+// Копятся только относительные ошибки итоговых оценок: смещение и σ по
+// Уэлфорду для каждой пары (B, скетч).
+struct GridResult {
+    double true_count;
+    std::vector<double> errors;
+};
+
+void runGridSweep(const std::string& filename, const std::vector<size_t>& stream_sizes,
+                  const std::vector<uint32_t>& precisions, size_t experiments, unsigned threads,
+                  uint64_t base_seed, const HashFuncGen& hash_func) {
+    constexpr size_t NUM_ESTIMATORS = 4;
+    const char* names[NUM_ESTIMATORS] = {"std", "imp", "cmp", "mle"};
+
     std::ofstream file(filename);
-    file << "experiment,step,true_count,hll_standard,hll_improved,hll_compact\n";
-    
-    for (size_t exp = 0; exp < all_results.size(); ++exp) {
-        for (const auto& result : all_results[exp]) {
-            file << exp << "," 
-                 << result.step << "," 
-                 << result.true_count << ","
-                 << std::fixed << std::setprecision(2) 
-                 << result.hll_standard << ","
-                 << result.hll_improved << ","
-                 << result.hll_compact << "\n";
-        }
+    file << "stream_size,b,experiments,mean_true_count";
+    for (const char* name : names) file << ",bias_" << name << ",sigma_" << name;
+    file << "\n";
+
+    std::cout << "\nПрогон по сетке: " << experiments << " экспериментов на размер потока, потоков "
+              << threads << std::endl;
+    std::cout << "Смещение / σ относительной ошибки, %:" << std::endl;
+    std::cout << "   поток   B     стандартный      улучшенный      компактный              МП" << std::endl;
+
+    std::vector<std::array<HllWelford, NUM_ESTIMATORS>> stats(precisions.size());
+    HllWelford truth;
+    hllRunExperiments(stream_sizes.size() * experiments, threads,
+        [&](size_t index) {
+            size_t stream_size = stream_sizes[index / experiments];
+            RandomStreamGen stream_gen(hllExperimentSeed(base_seed, index));
+            auto stream = stream_gen.generateStream(stream_size);
+            std::vector<uint32_t> hashes;
+            hashes.reserve(stream.size());
+            ExactDistinctCounter unique_set;
+            unique_set.reserve(stream.size());
+            for (const auto& item : stream) {
+                hashes.push_back(hash_func.hash(item));
+                unique_set.insert(item);
+            }
+
+            GridResult result;
+            result.true_count = static_cast<double>(unique_set.size());
+            for (uint32_t b : precisions) {
+                HyperLogLog hll_std(b);
+                HyperLogLogImproved hll_imp(b);
+                HyperLogLogCompact hll_cmp(b);
+                hll_std.addBatch(hashes);
+                hll_imp.addBatch(hashes);
+                hll_cmp.addBatch(hashes);
+                double estimates[NUM_ESTIMATORS] = {
+                    hll_std.estimate(), hll_imp.estimate(), hll_cmp.estimate(),
+                    hll_std.estimate(HllEstimator::MaxLikelihood)};
+                for (double estimate : estimates) {
+                    result.errors.push_back(estimate / result.true_count - 1.0);
+                }
+            }
+            return result;
+        },
+        [&](size_t index, GridResult result) {
+            truth.add(result.true_count);
+            for (size_t i = 0; i < precisions.size(); ++i) {
+                for (size_t k = 0; k < NUM_ESTIMATORS; ++k) {
+                    stats[i][k].add(result.errors[i * NUM_ESTIMATORS + k]);
+                }
+            }
+            if (index % experiments != experiments - 1) return;
+
+            size_t stream_size = stream_sizes[index / experiments];
+            for (size_t i = 0; i < precisions.size(); ++i) {
+                file << stream_size << "," << precisions[i] << "," << experiments << ","
+                     << std::fixed << std::setprecision(2) << truth.mean;
+                std::cout << std::setw(8) << stream_size << std::setw(4) << precisions[i];
+                for (const HllWelford& s : stats[i]) {
+                    file << "," << std::setprecision(4) << s.mean * 100 << "," << s.stddev() * 100;
+                    std::cout << std::setprecision(2) << std::setw(9) << s.mean * 100
+                              << " /" << std::setw(5) << s.stddev() * 100;
+                }
+                file << "\n";
+                std::cout << std::endl;
+            }
+            stats.assign(precisions.size(), {});
+            truth = HllWelford();
+        });
+}
+
+// Оценки на всём диапазоне точностей: для каждого B поток случайных хешей до
+// 2^20 различных, оценки в точках через множитель 2^(1/4). Относительная
+// ошибка (оценка - n) / n усредняется по экспериментам: среднее — смещение,
+// корень из среднего квадрата — RMSE. Оценки Эртла считаются по гистограмме
+// того же стандартного скетча.
+void runEstimatorSweep(const std::string& filename, unsigned threads) {
+    const uint32_t min_b = 4;
+    const uint32_t max_b = 18;
+    const size_t experiments = 16;
+    const uint64_t max_count = uint64_t(1) << 20;
+    constexpr size_t NUM_ESTIMATORS = 5;
+    const char* names[NUM_ESTIMATORS] = {"hll_standard", "hll_improved", "hll_compact", "ertl_improved", "ertl_mle"};
+
+    std::vector<uint64_t> checkpoints;
+    for (int k = 12;; ++k) {
+        uint64_t n = static_cast<uint64_t>(std::llround(std::pow(2.0, k / 4.0)));
+        if (n > max_count) break;
+        if (checkpoints.empty() || n != checkpoints.back()) checkpoints.push_back(n);
     }
+
+    std::ofstream file(filename);
+    file << "b,true_count";
+    for (const char* name : names) file << "," << name << "_bias," << name << "_rmse";
+    file << "\n";
+
+    std::cout << "\nОценки при B = " << min_b << ".." << max_b << ", " << experiments
+              << " экспериментов, n до " << max_count << std::endl;
+    std::cout << "Средняя по точкам RMSE / наибольшее |смещение|, %:" << std::endl;
+    std::cout << "   B  1.04/√m     стандартный      улучшенный      компактный            Эртл              МП" << std::endl;
+
+    std::vector<std::array<HllWelford, NUM_ESTIMATORS>> stats(checkpoints.size());
+    hllRunExperiments((max_b - min_b + 1) * experiments, threads,
+        [&](size_t index) {
+            uint32_t b = min_b + static_cast<uint32_t>(index / experiments);
+            HyperLogLog hll_std(b);
+            HyperLogLogImproved hll_imp(b);
+            HyperLogLogCompact hll_cmp(b);
+            uint64_t seed = static_cast<uint64_t>(index) << 32;
+            std::vector<uint32_t> hashes;
+            std::vector<double> errors;
+            errors.reserve(checkpoints.size() * NUM_ESTIMATORS);
+            uint64_t done = 0;
+            for (uint64_t n : checkpoints) {
+                hashes.resize(n - done);
+                for (size_t i = 0; i < hashes.size(); ++i) {
+                    hashes[i] = static_cast<uint32_t>(splitmix64(seed + done + i));
+                }
+                hll_std.addBatch(hashes);
+                hll_imp.addBatch(hashes);
+                hll_cmp.addBatch(hashes);
+                done = n;
+
+                double estimates[NUM_ESTIMATORS] = {
+                    hll_std.estimate(), hll_imp.estimate(), hll_cmp.estimate(),
+                    hll_std.estimate(HllEstimator::Improved), hll_std.estimate(HllEstimator::MaxLikelihood)};
+                for (double estimate : estimates) {
+                    errors.push_back(estimate / static_cast<double>(n) - 1.0);
+                }
+            }
+            return errors;
+        },
+        [&](size_t index, std::vector<double> errors) {
+            for (size_t c = 0; c < checkpoints.size(); ++c) {
+                for (size_t k = 0; k < NUM_ESTIMATORS; ++k) {
+                    stats[c][k].add(errors[c * NUM_ESTIMATORS + k]);
+                }
+            }
+            if (index % experiments != experiments - 1) return;
+
+            uint32_t b = min_b + static_cast<uint32_t>(index / experiments);
+            double avg_rmse[NUM_ESTIMATORS] = {};
+            double max_bias[NUM_ESTIMATORS] = {};
+            for (size_t c = 0; c < checkpoints.size(); ++c) {
+                file << b << "," << checkpoints[c];
+                for (size_t k = 0; k < NUM_ESTIMATORS; ++k) {
+                    double bias = stats[c][k].mean * 100;
+                    double rmse = stats[c][k].rms() * 100;
+                    avg_rmse[k] += rmse / checkpoints.size();
+                    max_bias[k] = std::max(max_bias[k], std::abs(bias));
+                    file << "," << bias << "," << rmse;
+                }
+                file << "\n";
+            }
+
+            std::cout << std::setw(4) << b << std::fixed << std::setprecision(2)
+                      << std::setw(9) << 104.0 / std::sqrt(static_cast<double>(1u << b));
+            for (size_t k = 0; k < NUM_ESTIMATORS; ++k) {
+                std::cout << std::setw(9) << avg_rmse[k] << " /" << std::setw(5) << max_bias[k];
+            }
+            std::cout << std::endl;
+            stats.assign(checkpoints.size(), {});
+        });
 }
 
-int main() {
+int main(int argc, char** argv) {
     const uint32_t B = 10;
     const size_t num_experiments = 10;
     const size_t stream_size = 100000;
     const double step_percentage = 0.05;
+    const uint64_t base_seed = 42;
+    const size_t grid_experiments = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200;
+    const unsigned threads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+                                      : std::max(1u, std::thread::hardware_concurrency());
     
     std::cout << "========================================" << std::endl;
     std::cout << "  Сравнение версий HyperLogLog" << std::endl;
@@ -84,11 +295,11 @@ int main() {
     std::cout << "Параметр B: " << B << " (регистров: " << (1 << B) << ")" << std::endl;
     std::cout << "Размер потока: " << stream_size << std::endl;
     std::cout << "Количество экспериментов: " << num_experiments << std::endl;
+    std::cout << "Потоков: " << threads << std::endl;
     std::cout << "Теоретическая погрешность: " << (1.04 / std::sqrt(1 << B)) * 100 << "%" << std::endl;
     std::cout << std::endl;
     
-    RandomStreamGen stream_gen;
-    HashFuncGen hash_func = HashFuncGen::random();
+    HashFuncGen hash_func = HashFuncGen::random(base_seed);
     
     HyperLogLog hll_test(B);
     HyperLogLogImproved hll_imp_test(B);
@@ -103,79 +314,51 @@ int main() {
               << (1.0 - static_cast<double>(hll_cmp_test.getMemoryUsage()) / (1 << B)) * 100 
               << "%" << std::endl << std::endl;
     
-    std::vector<std::vector<ExperimentResult>> all_results;
+    std::ofstream results_file("comparison_results.csv");
+    results_file << "experiment,step,true_count,hll_standard,hll_improved,hll_compact\n";
+    std::vector<StepStats> steps;
     
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    for (size_t exp = 0; exp < num_experiments; ++exp) {
-        std::cout << "Эксперимент " << (exp + 1) << "/" << num_experiments << "... ";
-        std::cout.flush();
-        
-        auto stream = stream_gen.generateStream(stream_size);
-        HyperLogLog hll_std(B);
-        HyperLogLogImproved hll_imp(B);
-        HyperLogLogCompact hll_cmp(B);
-        
-        auto results = runComparison(stream, hll_std, hll_imp, hll_cmp, hash_func, step_percentage);
-        all_results.push_back(results);
-        
-        std::cout << "✓" << std::endl;
-    }
+    hllRunExperiments(num_experiments, threads,
+        [&](size_t exp) {
+            RandomStreamGen stream_gen(hllExperimentSeed(base_seed, exp));
+            auto stream = stream_gen.generateStream(stream_size);
+            HyperLogLog hll_std(B);
+            HyperLogLogImproved hll_imp(B);
+            HyperLogLogCompact hll_cmp(B);
+            return runComparison(stream, hll_std, hll_imp, hll_cmp, hash_func, step_percentage);
+        },
+        [&](size_t exp, std::vector<ExperimentResult> results) {
+            appendComparisonResults(results_file, exp, results);
+            if (steps.size() < results.size()) steps.resize(results.size());
+            for (size_t i = 0; i < results.size(); ++i) steps[i].add(results[i]);
+            std::cout << "Эксперимент " << (exp + 1) << "/" << num_experiments << "... ✓" << std::endl;
+        });
+    results_file.close();
     
     auto end_time = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
     
     std::cout << "\nВремя выполнения: " << duration.count() / 1000.0 << " сек" << std::endl;
-    
-    saveComparisonResults("comparison_results.csv", all_results);
     std::cout << "Результаты сохранены в comparison_results.csv" << std::endl;
     
-    size_t num_steps = all_results[0].size();
-    std::vector<double> mean_std(num_steps, 0.0);
-    std::vector<double> mean_imp(num_steps, 0.0);
-    std::vector<double> mean_cmp(num_steps, 0.0);
-    std::vector<double> std_std(num_steps, 0.0);
-    std::vector<double> std_imp(num_steps, 0.0);
-    std::vector<double> std_cmp(num_steps, 0.0);
-    std::vector<size_t> true_counts(num_steps, 0);
-    
-    for (size_t step = 0; step < num_steps; ++step) {
-        for (size_t exp = 0; exp < num_experiments; ++exp) {
-            mean_std[step] += all_results[exp][step].hll_standard;
-            mean_imp[step] += all_results[exp][step].hll_improved;
-            mean_cmp[step] += all_results[exp][step].hll_compact;
-            if (exp == 0) true_counts[step] = all_results[exp][step].true_count;
-        }
-        mean_std[step] /= num_experiments;
-        mean_imp[step] /= num_experiments;
-        mean_cmp[step] /= num_experiments;
-    }
-    
-    for (size_t step = 0; step < num_steps; ++step) {
-        for (size_t exp = 0; exp < num_experiments; ++exp) {
-            std_std[step] += std::pow(all_results[exp][step].hll_standard - mean_std[step], 2);
-            std_imp[step] += std::pow(all_results[exp][step].hll_improved - mean_imp[step], 2);
-            std_cmp[step] += std::pow(all_results[exp][step].hll_compact - mean_cmp[step], 2);
-        }
-        std_std[step] = std::sqrt(std_std[step] / num_experiments);
-        std_imp[step] = std::sqrt(std_imp[step] / num_experiments);
-        std_cmp[step] = std::sqrt(std_cmp[step] / num_experiments);
-    }
+    // Ошибка шага — расхождение средней оценки со средним точным значением.
+    auto error = [](const HllWelford& estimate, const HllWelford& truth) {
+        return std::abs(estimate.mean - truth.mean) / truth.mean * 100;
+    };
     
     std::ofstream stats_file("comparison_statistics.csv");
     stats_file << "step,true_count,mean_std,std_std,error_std,mean_imp,std_imp,error_imp,mean_cmp,std_cmp,error_cmp\n";
     
-    for (size_t i = 0; i < num_steps; ++i) {
-        double err_std = std::abs(mean_std[i] - true_counts[i]) / true_counts[i] * 100;
-        double err_imp = std::abs(mean_imp[i] - true_counts[i]) / true_counts[i] * 100;
-        double err_cmp = std::abs(mean_cmp[i] - true_counts[i]) / true_counts[i] * 100;
-        
+    for (size_t i = 0; i < steps.size(); ++i) {
+        const StepStats& s = steps[i];
         stats_file << (i + 1) << ","
-                   << true_counts[i] << ","
+                   << std::llround(s.true_count.mean) << ","
                    << std::fixed << std::setprecision(2)
-                   << mean_std[i] << "," << std_std[i] << "," << err_std << ","
-                   << mean_imp[i] << "," << std_imp[i] << "," << err_imp << ","
-                   << mean_cmp[i] << "," << std_cmp[i] << "," << err_cmp << "\n";
+                   << s.hll_standard.mean << "," << s.hll_standard.stddev() << "," << error(s.hll_standard, s.true_count) << ","
+                   << s.hll_improved.mean << "," << s.hll_improved.stddev() << "," << error(s.hll_improved, s.true_count) << ","
+                   << s.hll_compact.mean << "," << s.hll_compact.stddev() << "," << error(s.hll_compact, s.true_count) << "\n";
     }
     stats_file.close();
     
@@ -189,10 +372,10 @@ int main() {
     double max_err_std = 0, max_err_imp = 0, max_err_cmp = 0;
     double avg_std_std = 0, avg_std_imp = 0, avg_std_cmp = 0;
     
-    for (size_t i = 0; i < num_steps; ++i) {
-        double err_std = std::abs(mean_std[i] - true_counts[i]) / true_counts[i] * 100;
-        double err_imp = std::abs(mean_imp[i] - true_counts[i]) / true_counts[i] * 100;
-        double err_cmp = std::abs(mean_cmp[i] - true_counts[i]) / true_counts[i] * 100;
+    for (const StepStats& s : steps) {
+        double err_std = error(s.hll_standard, s.true_count);
+        double err_imp = error(s.hll_improved, s.true_count);
+        double err_cmp = error(s.hll_compact, s.true_count);
         
         avg_err_std += err_std;
         avg_err_imp += err_imp;
@@ -202,11 +385,12 @@ int main() {
         max_err_imp = std::max(max_err_imp, err_imp);
         max_err_cmp = std::max(max_err_cmp, err_cmp);
         
-        avg_std_std += std_std[i] / true_counts[i] * 100;
-        avg_std_imp += std_imp[i] / true_counts[i] * 100;
-        avg_std_cmp += std_cmp[i] / true_counts[i] * 100;
+        avg_std_std += s.hll_standard.stddev() / s.true_count.mean * 100;
+        avg_std_imp += s.hll_improved.stddev() / s.true_count.mean * 100;
+        avg_std_cmp += s.hll_compact.stddev() / s.true_count.mean * 100;
     }
     
+    size_t num_steps = steps.size();
     avg_err_std /= num_steps;
     avg_err_imp /= num_steps;
     avg_err_cmp /= num_steps;
@@ -236,6 +420,13 @@ int main() {
     std::cout << "\nТеоретические пределы:" << std::endl;
     std::cout << "  1.04/√(2^B) = " << (1.04 / std::sqrt(1 << B)) * 100 << "%" << std::endl;
     std::cout << "  1.3/√(2^B)  = " << (1.3 / std::sqrt(1 << B)) * 100 << "%" << std::endl;
+
+    runGridSweep("comparison_sweep.csv", {10000, 100000}, {8, 10, 12, 14}, grid_experiments, threads,
+                 base_seed + 1, hash_func);
+    std::cout << "\nРезультаты сохранены в comparison_sweep.csv" << std::endl;
+
+    runEstimatorSweep("estimator_results.csv", threads);
+    std::cout << "\nРезультаты сохранены в estimator_results.csv" << std::endl;
     
     std::cout << "\nЭксперимент завершен успешно!" << std::endl;
     
@@ -0,0 +1,131 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hll_concurrent.h"
+#include "hll_sharded.h"
+#include "hash_function.h"
+
+// Конкуренция за один скетч: N потоков пишут в общий массив регистров через
+// атомарный fetch-max, пока отдельный поток непрерывно вызывает estimate().
+// Для сравнения — раздельные скетчи с последующим слиянием (hll_sharded.h).
+
+struct ContentionResult {
+    double mkeys_per_sec;
+    double estimate;
+    size_t estimates_done;
+};
+
+template <class Sketch>
+ContentionResult runShared(const std::vector<uint32_t>& hashes, uint32_t b, size_t num_threads) {
+    Sketch sketch(b);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> estimates_done{0};
+
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            volatile double e = sketch.estimate();
+            (void)e;
+            estimates_done.fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> writers;
+    for (size_t t = 0; t < num_threads; ++t) {
+        writers.emplace_back([&, t] {
+            size_t begin = hashes.size() * t / num_threads;
+            size_t end = hashes.size() * (t + 1) / num_threads;
+            sketch.addBatch(std::span<const uint32_t>(hashes.data() + begin, end - begin));
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    auto end = std::chrono::high_resolution_clock::now();
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return {hashes.size() / ns * 1000.0, sketch.estimate(), estimates_done.load()};
+}
+
+template <class Sketch>
+ContentionResult runSharded(const std::vector<uint32_t>& hashes, uint32_t b, size_t num_threads) {
+    auto start = std::chrono::high_resolution_clock::now();
+    Sketch sketch = hllShardedIngest<Sketch>(std::span<const uint32_t>(hashes), b, num_threads);
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return {hashes.size() / ns * 1000.0, sketch.estimate(), 0};
+}
+
+int main() {
+    const std::vector<uint32_t> precisions = {10, 14};
+    const std::vector<uint64_t> cardinalities = {1000, 1 << 22};
+    const size_t stream_size = 1 << 22;
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts = {1};
+    for (size_t t = 2; t <= std::max<size_t>(cores, 8); t *= 2) thread_counts.push_back(t);
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Конкурентный HyperLogLog" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Ключей: " << stream_size << ", ядер: " << cores << std::endl;
+
+    std::ofstream file("concurrent_results.csv");
+    file << "sketch,b,distinct,threads,mkeys_per_sec,estimate,estimates_done\n";
+
+    for (uint32_t b : precisions) {
+        for (uint64_t distinct : cardinalities) {
+            // Мало различных ключей — почти все вставки не меняют регистр;
+            // много — регистры растут и CAS чаще сталкиваются.
+            std::vector<uint32_t> hashes(stream_size);
+            for (size_t i = 0; i < stream_size; ++i) {
+                hashes[i] = static_cast<uint32_t>(splitmix64(i % distinct));
+            }
+            HyperLogLog reference(b);
+            reference.addBatch(hashes);
+            HyperLogLogCompact reference_compact(b);
+            reference_compact.addBatch(hashes);
+
+            std::cout << "\nB = " << b << ", различных ключей: " << distinct
+                      << " (однопоточная оценка " << std::fixed << std::setprecision(1)
+                      << reference.estimate() << ")" << std::endl;
+            std::cout << "  потоков   общий байтовый   общий упакованный   раздельные+слияние   оценок во время записи"
+                      << std::endl;
+
+            for (size_t threads : thread_counts) {
+                ContentionResult shared = runShared<HyperLogLogConcurrent>(hashes, b, threads);
+                ContentionResult shared_compact = runShared<HyperLogLogCompactConcurrent>(hashes, b, threads);
+                ContentionResult sharded = runSharded<HyperLogLog>(hashes, b, threads);
+
+                bool exact = shared.estimate == reference.estimate() &&
+                             shared_compact.estimate == reference_compact.estimate() &&
+                             sharded.estimate == reference.estimate();
+                std::cout << std::setw(9) << threads << std::setprecision(1)
+                          << std::setw(17) << shared.mkeys_per_sec
+                          << std::setw(20) << shared_compact.mkeys_per_sec
+                          << std::setw(21) << sharded.mkeys_per_sec
+                          << std::setw(25) << shared.estimates_done
+                          << (exact ? "" : "  (оценка отличается!)") << std::endl;
+
+                file << "HyperLogLogConcurrent," << b << "," << distinct << "," << threads << ","
+                     << shared.mkeys_per_sec << "," << shared.estimate << "," << shared.estimates_done << "\n";
+                file << "HyperLogLogCompactConcurrent," << b << "," << distinct << "," << threads << ","
+                     << shared_compact.mkeys_per_sec << "," << shared_compact.estimate << ","
+                     << shared_compact.estimates_done << "\n";
+                file << "HyperLogLog(sharded)," << b << "," << distinct << "," << threads << ","
+                     << sharded.mkeys_per_sec << "," << sharded.estimate << ",0\n";
+            }
+        }
+    }
+
+    std::cout << "\nРезультаты сохранены в concurrent_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
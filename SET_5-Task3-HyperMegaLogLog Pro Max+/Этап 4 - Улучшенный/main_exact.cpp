@@ -0,0 +1,78 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "exact_counter.h"
+#include "hash_function.h"
+
+// Точный подсчёт для эталона: std::unordered_set<std::string> против
+// ExactDistinctCounter (только отпечатки и с проверкой ключей). Поток из 2n
+// ключей, каждый из n различных встречается дважды. unordered_set меряется
+// только до 10^6 ключей: дальше он упирается в память. Его память оценена
+// снизу: узел (строка и указатель) на ключ, корзины и куча длинных строк.
+// Ключи пишутся в один буфер, так что в замер входит только сам счётчик.
+
+template <class Insert>
+double measureNsPerKey(uint64_t n, Insert&& insert) {
+    char buffer[32] = "user-";
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < 2 * n; ++i) {
+        char* end = std::to_chars(buffer + 5, buffer + sizeof(buffer), splitmix64(i < n ? i : i - n)).ptr;
+        insert(std::string_view(buffer, end - buffer));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (2 * n);
+}
+
+int main() {
+    const std::vector<uint64_t> cardinalities = {100000, 1000000, 10000000};
+    const uint64_t unordered_limit = 1000000;
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Точный подсчёт различных ключей" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    std::ofstream file("exact_results.csv");
+    file << "counter,distinct,ns_per_key,bytes_per_key,count\n";
+
+    std::cout << "       n   нс/ключ   байт/ключ      найдено   счётчик" << std::endl;
+    for (uint64_t n : cardinalities) {
+        auto report = [&](const char* name, const char* csv_name, double ns, size_t bytes, size_t found) {
+            double per_key = static_cast<double>(bytes) / n;
+            std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                      << std::setw(10) << ns << std::setw(12) << per_key << std::setw(13) << found
+                      << "   " << name << (found == n ? "" : "  (расхождение!)") << std::endl;
+            file << csv_name << "," << n << "," << ns << "," << per_key << "," << found << "\n";
+        };
+
+        if (n <= unordered_limit) {
+            std::unordered_set<std::string> set;
+            double ns = measureNsPerKey(n, [&](std::string_view key) { set.emplace(key); });
+            size_t bytes = set.bucket_count() * sizeof(void*) +
+                           set.size() * (sizeof(std::string) + 2 * sizeof(void*));
+            for (const auto& key : set) {
+                if (key.capacity() > 15) bytes += key.capacity() + 1;
+            }
+            report("unordered_set<string>", "unordered_set", ns, bytes, set.size());
+        }
+
+        ExactDistinctCounter fingerprints;
+        double ns = measureNsPerKey(n, [&](std::string_view key) { fingerprints.insert(key); });
+        report("отпечатки", "fingerprints", ns, fingerprints.getMemoryUsage(), fingerprints.size());
+
+        ExactDistinctCounter verified(true);
+        ns = measureNsPerKey(n, [&](std::string_view key) { verified.insert(key); });
+        report("отпечатки + ключи", "fingerprints_verified", ns, verified.getMemoryUsage(), verified.size());
+    }
+
+    std::cout << "\nРезультаты сохранены в exact_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hyperloglog_tailcut.h"
+#include "hyperloglog_fixed.h"
+#include "hyperloglog_adaptive.h"
+#include "hll_experiment.h"
+#include "hll_fold.h"
+#include "hash_function.h"
+
+// Свёртка точности и HyperLogLog с растущей точностью. Сначала проверяется,
+// что свёртка скетча B = 14 до каждого target_b даёт ровно тот скетч, что
+// построен с target_b на тех же хешах, и что объединение скетчей разной
+// точности совпадает с прямым подсчётом. Затем HyperLogLogAdaptive сравнивается
+// с HyperLogLog(14) по ошибке и памяти на потоках разной длины.
+
+uint32_t testHash(uint64_t i, uint64_t seed) {
+    return static_cast<uint32_t>(splitmix64(i + (seed << 40)));
+}
+
+// Скетчи с serialize() сравниваются по регистрам: разреженный скетч мог
+// перейти в плотный режим в другой момент, чем построенный напрямую, и его
+// оценка тогда считается другим способом при тех же регистрах.
+template <class Sketch>
+bool sameSketch(const Sketch& a, const Sketch& b) {
+    if constexpr (requires { a.serialize(); }) {
+        return a.serialize() == b.serialize();
+    } else {
+        return a.estimate() == b.estimate();
+    }
+}
+
+template <class Sketch, class Make>
+bool checkFold(const char* name, Make&& make, uint32_t B, uint64_t items, std::ofstream& file) {
+    Sketch source = make(B);
+    for (uint64_t i = 0; i < items; ++i) source.add(testHash(i, 1));
+    bool all = true;
+    for (uint32_t target = HLL_FOLD_MIN_B; target <= B; ++target) {
+        Sketch direct = make(target);
+        for (uint64_t i = 0; i < items; ++i) direct.add(testHash(i, 1));
+        std::optional<Sketch> folded = source.fold(target);
+        bool same = folded && sameSketch(*folded, direct) && folded->validateHistogram();
+        all = all && same;
+        file << "fold," << name << "," << items << "," << target << "," << same << "\n";
+    }
+    std::cout << "  " << std::setw(28) << std::left << name << std::right << std::setw(9) << items
+              << "   " << (all ? "совпадает" : "РАЗЛИЧАЕТСЯ") << std::endl;
+    return all;
+}
+
+template <class Sketch, class Make>
+bool checkUnion(const char* name, Make&& make, uint32_t b_fine, uint32_t b_coarse, uint64_t items,
+                std::ofstream& file) {
+    Sketch fine = make(b_fine);
+    Sketch coarse = make(b_coarse);
+    Sketch direct = make(b_coarse);
+    for (uint64_t i = 0; i < items; ++i) fine.add(testHash(i, 2));
+    for (uint64_t i = items / 2; i < items + items / 2; ++i) coarse.add(testHash(i, 2));
+    for (uint64_t i = 0; i < items + items / 2; ++i) direct.add(testHash(i, 2));
+    Sketch joined = hllUnion(fine, coarse);
+    Sketch joined_back = hllUnion(coarse, fine);
+    bool same = joined.getB() == b_coarse && sameSketch(joined, direct) && sameSketch(joined_back, direct);
+    std::cout << "  " << std::setw(28) << std::left << name << std::right
+              << "  B " << b_fine << " + B " << b_coarse << ": " << std::fixed << std::setprecision(0)
+              << joined.estimate() << " при точном " << items + items / 2 << "   "
+              << (same ? "совпадает с прямым" : "РАЗЛИЧАЕТСЯ") << std::endl;
+    file << "union," << name << "," << items + items / 2 << "," << b_coarse << "," << same << "\n";
+    return same;
+}
+
+int main() {
+    const uint32_t B = 14;
+    const uint32_t B_MIN = 4;
+    const std::vector<uint64_t> sizes = {10, 100, 1000, 10000, 100000, 1000000};
+    const uint64_t work_per_size = 20000000;
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Свёртка точности HyperLogLog" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::ofstream file("fold_results.csv");
+    file << "section,sketch,items,b,value\n";
+
+    std::cout << "\nСвёртка B = " << B << " до B = " << HLL_FOLD_MIN_B << ".." << B
+              << " против построения с нужной точностью:" << std::endl;
+    bool ok = true;
+    ok &= checkFold<HyperLogLog>("HyperLogLog", [](uint32_t b) { return HyperLogLog(b); }, B, 200000, file);
+    ok &= checkFold<HyperLogLog>("HyperLogLog (разреженный)", [](uint32_t b) { return HyperLogLog(b, true); },
+                                 B, 1000, file);
+    ok &= checkFold<HyperLogLogImproved>("HyperLogLogImproved",
+                                         [](uint32_t b) { return HyperLogLogImproved(b); }, B, 200000, file);
+    ok &= checkFold<HyperLogLogCompact>("HyperLogLogCompact",
+                                        [](uint32_t b) { return HyperLogLogCompact(b); }, B, 200000, file);
+    ok &= checkFold<HyperLogLogCompact>("HyperLogLogCompact (разр.)",
+                                        [](uint32_t b) { return HyperLogLogCompact(b, true); }, B, 1000, file);
+    ok &= checkFold<HyperLogLogTailCut>("HyperLogLogTailCut",
+                                        [](uint32_t b) { return HyperLogLogTailCut(b); }, B, 200000, file);
+
+    HyperLogLogCompactFixed<B> fixed;
+    HyperLogLogCompactFixed<10> fixed_direct;
+    for (uint64_t i = 0; i < 200000; ++i) {
+        fixed.add(testHash(i, 1));
+        fixed_direct.add(testHash(i, 1));
+    }
+    bool fixed_same = fixed.fold<4>().estimate() == fixed_direct.estimate();
+    ok &= fixed_same;
+    std::cout << "  " << std::setw(28) << std::left << "HyperLogLogCompactFixed" << std::right
+              << std::setw(9) << 200000 << "   " << (fixed_same ? "совпадает" : "РАЗЛИЧАЕТСЯ")
+              << " (B 14 -> 10)" << std::endl;
+
+    std::cout << "\nОбъединение скетчей разной точности:" << std::endl;
+    ok &= checkUnion<HyperLogLog>("HyperLogLog", [](uint32_t b) { return HyperLogLog(b); }, 14, 10, 100000, file);
+    ok &= checkUnion<HyperLogLogCompact>("HyperLogLogCompact", [](uint32_t b) { return HyperLogLogCompact(b); },
+                                         14, 10, 100000, file);
+    ok &= checkUnion<HyperLogLogTailCut>("HyperLogLogTailCut", [](uint32_t b) { return HyperLogLogTailCut(b); },
+                                         16, 11, 100000, file);
+
+    // Точность ниже HLL_FOLD_MIN_B: свернуть до неё нельзя, слияние должно
+    // вернуть false, а адаптивный скетч — поднять b_min и слиться.
+    HyperLogLog tiny(HLL_FOLD_MIN_B - 1);
+    HyperLogLog fine(B);
+    HyperLogLogAdaptive adaptive_low(2, B);
+    HyperLogLogAdaptive adaptive_high(B, B);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        tiny.add(testHash(i, 2));
+        fine.add(testHash(i, 2));
+        adaptive_low.add(testHash(i, 2));
+        adaptive_high.add(testHash(i, 3));
+    }
+    bool below_min = !tiny.merge(fine) && adaptive_low.getB() >= HLL_FOLD_MIN_B &&
+                     adaptive_high.merge(adaptive_low) && adaptive_high.validateHistogram() &&
+                     adaptive_low.merge(adaptive_high) && adaptive_low.validateHistogram();
+    ok &= below_min;
+    std::cout << "  " << std::setw(28) << std::left << "Точность ниже минимума" << std::right
+              << "            " << (below_min ? "отвергается" : "ОШИБКА") << " (B " << HLL_FOLD_MIN_B - 1
+              << ", b_min 2)" << std::endl;
+
+    std::cout << "\nHyperLogLogAdaptive(" << B_MIN << ", " << B << ") против HyperLogLog(" << B << ")" << std::endl;
+    std::cout << "  элементов  опытов   смещение, %        RMSE, %         байт   B в конце" << std::endl;
+    std::cout << "                    адапт.   HLL     адапт.   HLL      адапт." << std::endl;
+    for (uint64_t n : sizes) {
+        const uint64_t experiments = std::max<uint64_t>(20, std::min<uint64_t>(1000, work_per_size / n));
+        HllWelford adaptive_error, fixed_error, bytes, final_b;
+        for (uint64_t e = 0; e < experiments; ++e) {
+            HyperLogLogAdaptive adaptive(B_MIN, B);
+            HyperLogLog reference(B);
+            const uint64_t seed = hllExperimentSeed(42, e) >> 24;
+            for (uint64_t i = 0; i < n; ++i) {
+                uint32_t hash = testHash(i, seed);
+                adaptive.add(hash);
+                reference.add(hash);
+            }
+            adaptive_error.add((adaptive.estimate() - n) / n);
+            fixed_error.add((reference.estimate() - n) / n);
+            bytes.add(static_cast<double>(adaptive.getMemoryUsage()));
+            final_b.add(adaptive.getB());
+        }
+        std::cout << std::setw(11) << n << std::setw(8) << experiments << std::fixed << std::setprecision(2)
+                  << std::setw(10) << adaptive_error.mean * 100 << std::setw(8) << fixed_error.mean * 100
+                  << std::setw(10) << adaptive_error.rms() * 100 << std::setw(8) << fixed_error.rms() * 100
+                  << std::setprecision(0) << std::setw(12) << bytes.mean
+                  << std::setprecision(1) << std::setw(9) << final_b.mean << std::endl;
+        file << "adaptive_bias," << "HyperLogLogAdaptive," << n << "," << B << "," << adaptive_error.mean << "\n";
+        file << "adaptive_rmse," << "HyperLogLogAdaptive," << n << "," << B << "," << adaptive_error.rms() << "\n";
+        file << "adaptive_bytes," << "HyperLogLogAdaptive," << n << "," << B << "," << bytes.mean << "\n";
+        file << "adaptive_bias," << "HyperLogLog," << n << "," << B << "," << fixed_error.mean << "\n";
+        file << "adaptive_rmse," << "HyperLogLog," << n << "," << B << "," << fixed_error.rms() << "\n";
+    }
+
+    std::cout << "\nРезультаты сохранены в fold_results.csv" << std::endl;
+    if (!ok) {
+        std::cout << "\nСвёртка расходится с прямым построением!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
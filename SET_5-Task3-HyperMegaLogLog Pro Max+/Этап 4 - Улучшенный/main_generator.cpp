@@ -0,0 +1,115 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "hyperloglog.h"
+#include "stream_generator.h"
+#include "hash_function.h"
+
+// Генератор потоков: сначала скорость RandomStreamGen против ArenaStreamGen,
+// затем длинный поток со скошенными повторами (по умолчанию 10^8 элементов,
+// первый аргумент задаёт другую длину, например 1000000000) идёт блоками
+// через hashBatch в HyperLogLog. Точный ответ на каждом шаге даёт
+// trueCount, так что эталонное множество не нужно.
+//
+//   main_generator [длина потока]
+
+template <class F>
+double measureSeconds(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t small_size = 1000000;
+    const uint64_t stream_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000000;
+    const uint64_t distinct = std::max<uint64_t>(1, stream_size / 10);
+    const double zipf_s = 1.1;
+    const uint64_t block = uint64_t(1) << 22;
+    const size_t checkpoints = 10;
+    const uint32_t B = 14;
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Генерация потоков ключей" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Потоков: " << threads << std::endl;
+    std::cout << std::endl;
+
+    std::ofstream file("generator_results.csv");
+    file << "section,items,true_count,estimate,error_percent,ns_per_item\n";
+
+    RandomStreamGen old_gen(42);
+    double old_s = measureSeconds([&] { old_gen.generateStream(small_size); });
+    StreamConfig small_config;
+    small_config.size = small_size;
+    small_config.seed = 42;
+    ArenaStreamGen arena_gen(small_config);
+    KeyArena arena;
+    double single_s = measureSeconds([&] { arena_gen.generate(0, small_size, arena, 1); });
+    double parallel_s = measureSeconds([&] { arena_gen.generate(0, small_size, arena, threads); });
+
+    std::cout << "Генерация " << small_size << " ключей, нс на ключ:" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "  RandomStreamGen::generateStream: " << old_s * 1e9 / small_size << std::endl
+              << "  ArenaStreamGen, 1 поток: " << single_s * 1e9 / small_size << std::endl
+              << "  ArenaStreamGen, потоков " << threads << ": " << parallel_s * 1e9 / small_size << std::endl;
+    file << "random_stream_gen," << small_size << ",0,0,0," << old_s * 1e9 / small_size << "\n";
+    file << "arena_single," << small_size << ",0,0,0," << single_s * 1e9 / small_size << "\n";
+    file << "arena_parallel," << small_size << ",0,0,0," << parallel_s * 1e9 / small_size << "\n";
+
+    StreamConfig config;
+    config.size = stream_size;
+    config.distinct = distinct;
+    config.zipf_s = zipf_s;
+    config.seed = 7;
+    ArenaStreamGen gen(config);
+    HashFuncGen hash_gen(0x9e3779b97f4a7c15ULL, 0x517cc1b727220a95ULL, HashMode::Wide);
+    HyperLogLog hll(B);
+
+    std::cout << "\nПоток " << stream_size << " элементов, различных " << distinct
+              << ", повторы по Ципфу s = " << zipf_s << ", B = " << B << std::endl;
+    std::cout << "    элементов     точно     оценка   ошибка, %" << std::endl;
+
+    std::vector<uint32_t> hashes;
+    double gen_s = 0.0, hash_s = 0.0, add_s = 0.0;
+    const uint64_t checkpoint_step = std::max<uint64_t>(1, stream_size / checkpoints);
+    uint64_t next_checkpoint = checkpoint_step;
+    for (uint64_t begin = 0; begin < stream_size;) {
+        uint64_t count = std::min(block, std::min(stream_size, next_checkpoint) - begin);
+        gen_s += measureSeconds([&] { gen.generate(begin, count, arena, threads); });
+        hashes.resize(count);
+        hash_s += measureSeconds([&] { hash_gen.hashBatch(arena.chars, arena.offsets, hashes); });
+        add_s += measureSeconds([&] { hll.addBatch(hashes); });
+        begin += count;
+
+        if (begin == next_checkpoint || begin == stream_size) {
+            uint64_t true_count = gen.trueCount(begin);
+            double estimate = hll.estimate();
+            double error = std::abs(estimate - static_cast<double>(true_count)) / true_count * 100;
+            std::cout << std::setw(14) << begin << std::setw(10) << true_count
+                      << std::setw(11) << static_cast<uint64_t>(estimate)
+                      << std::setprecision(2) << std::setw(12) << error << std::endl;
+            file << "stream," << begin << "," << true_count << "," << estimate << "," << error << ",0\n";
+            next_checkpoint = std::min(stream_size, next_checkpoint + checkpoint_step);
+        }
+    }
+
+    std::cout << "\nНа элемент: генерация " << std::setprecision(1) << gen_s * 1e9 / stream_size
+              << " нс, хеширование " << hash_s * 1e9 / stream_size
+              << " нс, добавление " << add_s * 1e9 / stream_size << " нс" << std::endl;
+    file << "stream_generate," << stream_size << ",0,0,0," << gen_s * 1e9 / stream_size << "\n";
+    file << "stream_hash," << stream_size << ",0,0,0," << hash_s * 1e9 / stream_size << "\n";
+    file << "stream_add," << stream_size << ",0,0,0," << add_s * 1e9 / stream_size << "\n";
+
+    std::cout << "\nРезультаты сохранены в generator_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,163 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hyperloglog64.h"
+#include "hash_function.h"
+
+// Сравнение 32- и 64-битных версий HyperLogLog на мощностях до 2^MAX_LOG2_N.
+// Ключ i хешируется как splitmix64(seed + i): это биекция, поэтому истинная
+// мощность известна без unordered_set. 32-битные скетчи получают свёртку
+// 64-битного хеша, как HashFuncGen::hash.
+
+struct AccuracyResult {
+    uint64_t true_count;
+    double err_std32 = 0.0;
+    double err_cmp32 = 0.0;
+    double err_std64 = 0.0;
+    double err_cmp64 = 0.0;
+};
+
+uint32_t fold(uint64_t h) {
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+double relativeError(double estimate, uint64_t true_count) {
+    return std::abs(estimate - static_cast<double>(true_count)) / true_count * 100;
+}
+
+std::string formatError(double err) {
+    if (!(err < 1000.0)) return ">1000";
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << err;
+    return out.str();
+}
+
+template <class Sketch, class Hash>
+double measureAddNs(Sketch& sketch, uint64_t n, uint64_t seed, Hash&& hashOf) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint64_t i = 0; i < n; ++i) {
+        sketch.add(hashOf(splitmix64(seed + i)));
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+template <class Sketch>
+double measureEstimateNs(const Sketch& sketch, size_t calls) {
+    volatile double sink = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < calls; ++i) {
+        sink = sink + sketch.estimate();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+int main() {
+    const uint32_t B = 14;
+    const uint32_t MIN_LOG2_N = 10;
+    const uint32_t MAX_LOG2_N = 32;
+    const size_t num_experiments = 3;
+    const uint64_t throughput_n = 1ull << 24;
+    const size_t estimate_calls = 100000;
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  HyperLogLog: 32-битный и 64-битный хеш" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Параметр B: " << B << " (регистров: " << (1 << B) << ")" << std::endl;
+    std::cout << "Мощности: 2^" << MIN_LOG2_N << " .. 2^" << MAX_LOG2_N << std::endl;
+    std::cout << "Количество экспериментов: " << num_experiments << std::endl;
+    std::cout << std::endl;
+
+    std::vector<AccuracyResult> results;
+    for (uint32_t k = MIN_LOG2_N; k <= MAX_LOG2_N; ++k) {
+        AccuracyResult result;
+        result.true_count = 1ull << k;
+        results.push_back(result);
+    }
+
+    for (size_t exp = 0; exp < num_experiments; ++exp) {
+        std::cout << "Эксперимент " << (exp + 1) << "/" << num_experiments << "... ";
+        std::cout.flush();
+
+        uint64_t seed = splitmix64(0xabcdef ^ exp);
+        HyperLogLog hll_std32(B);
+        HyperLogLogCompact hll_cmp32(B);
+        HyperLogLog64 hll_std64(B);
+        HyperLogLogCompact64 hll_cmp64(B);
+
+        size_t next = 0;
+        for (uint64_t i = 1; next < results.size(); ++i) {
+            uint64_t h = splitmix64(seed + i);
+            hll_std32.add(fold(h));
+            hll_cmp32.add(fold(h));
+            hll_std64.add(h);
+            hll_cmp64.add(h);
+
+            if (i == results[next].true_count) {
+                AccuracyResult& r = results[next];
+                r.err_std32 += relativeError(hll_std32.estimate(), i) / num_experiments;
+                r.err_cmp32 += relativeError(hll_cmp32.estimate(), i) / num_experiments;
+                r.err_std64 += relativeError(hll_std64.estimate(), i) / num_experiments;
+                r.err_cmp64 += relativeError(hll_cmp64.estimate(), i) / num_experiments;
+                ++next;
+            }
+        }
+        std::cout << "✓" << std::endl;
+    }
+
+    std::ofstream file("hash64_results.csv");
+    file << "log2_n,true_count,err_std32,err_cmp32,err_std64,err_cmp64\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        file << (MIN_LOG2_N + i) << ","
+             << r.true_count << ","
+             << std::fixed << std::setprecision(3)
+             << r.err_std32 << "," << r.err_cmp32 << ","
+             << r.err_std64 << "," << r.err_cmp64 << "\n";
+    }
+    std::cout << "Результаты сохранены в hash64_results.csv" << std::endl;
+
+    std::cout << "\nСредняя относительная погрешность, %:" << std::endl;
+    std::cout << "  n            std32    cmp32    std64    cmp64" << std::endl;
+    for (size_t i = 0; i < results.size(); i += 2) {
+        const auto& r = results[i];
+        std::cout << "  2^" << std::setw(2) << std::left << (MIN_LOG2_N + i) << std::right
+                  << std::setw(15) << formatError(r.err_std32)
+                  << std::setw(9) << formatError(r.err_cmp32)
+                  << std::setw(9) << formatError(r.err_std64)
+                  << std::setw(9) << formatError(r.err_cmp64) << std::endl;
+    }
+
+    std::cout << "\nПроизводительность (" << throughput_n << " добавлений):" << std::endl;
+    HyperLogLog hll_std32(B);
+    HyperLogLogCompact hll_cmp32(B);
+    HyperLogLog64 hll_std64(B);
+    HyperLogLogCompact64 hll_cmp64(B);
+    auto identity = [](uint64_t h) { return h; };
+    double add_std32 = measureAddNs(hll_std32, throughput_n, 1, fold);
+    double add_cmp32 = measureAddNs(hll_cmp32, throughput_n, 1, fold);
+    double add_std64 = measureAddNs(hll_std64, throughput_n, 1, identity);
+    double add_cmp64 = measureAddNs(hll_cmp64, throughput_n, 1, identity);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  HyperLogLog:          add " << add_std32 << " нс, estimate "
+              << measureEstimateNs(hll_std32, estimate_calls) << " нс" << std::endl;
+    std::cout << "  HyperLogLogCompact:   add " << add_cmp32 << " нс, estimate "
+              << measureEstimateNs(hll_cmp32, estimate_calls) << " нс" << std::endl;
+    std::cout << "  HyperLogLog64:        add " << add_std64 << " нс, estimate "
+              << measureEstimateNs(hll_std64, estimate_calls) << " нс" << std::endl;
+    std::cout << "  HyperLogLogCompact64: add " << add_cmp64 << " нс, estimate "
+              << measureEstimateNs(hll_cmp64, estimate_calls) << " нс" << std::endl;
+
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
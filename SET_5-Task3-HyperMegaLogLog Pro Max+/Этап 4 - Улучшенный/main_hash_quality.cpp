@@ -0,0 +1,220 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "hyperloglog.h"
+#include "stream_generator.h"
+#include "hash_function.h"
+
+// Качество и скорость режимов HashFuncGen: лавинный эффект, точность
+// HyperLogLog на случайных и последовательных ключах, пропускная способность.
+
+struct AvalancheResult {
+    double mean_flipped_bits;
+    double worst_bias;
+};
+
+const char* modeName(HashMode mode) {
+    return mode == HashMode::Wide ? "Wide" : "Bytewise";
+}
+
+// Для каждого ключа по очереди инвертирует каждый входной бит и считает,
+// как часто меняется каждый из 64 выходных бит. Идеал — 0.5 для всех.
+AvalancheResult measureAvalanche(const HashFuncGen& hash_func, size_t key_len, size_t num_keys) {
+    std::vector<uint64_t> flips(64, 0);
+    uint64_t total_flipped = 0;
+    uint64_t trials = 0;
+    std::string key(key_len, '\0');
+
+    for (size_t k = 0; k < num_keys; ++k) {
+        for (size_t i = 0; i < key_len; ++i) {
+            key[i] = static_cast<char>(splitmix64(k * 131 + i));
+        }
+        uint64_t base = hash_func.hash64(key);
+        for (size_t bit = 0; bit < key_len * 8; ++bit) {
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+            uint64_t diff = base ^ hash_func.hash64(key);
+            key[bit / 8] ^= static_cast<char>(1 << (bit % 8));
+
+            for (int out = 0; out < 64; ++out) {
+                flips[out] += (diff >> out) & 1;
+            }
+            total_flipped += static_cast<uint64_t>(std::popcount(diff));
+            trials++;
+        }
+    }
+
+    AvalancheResult result;
+    result.mean_flipped_bits = static_cast<double>(total_flipped) / trials;
+    result.worst_bias = 0.0;
+    for (int out = 0; out < 64; ++out) {
+        double p = static_cast<double>(flips[out]) / trials;
+        result.worst_bias = std::max(result.worst_bias, std::abs(p - 0.5));
+    }
+    return result;
+}
+
+double hllError(const HashFuncGen& hash_func, const std::vector<std::string>& stream, uint32_t b) {
+    HyperLogLog hll(b);
+    std::unordered_set<std::string> unique_set;
+    for (const auto& item : stream) {
+        hll.add(hash_func.hash(item));
+        unique_set.insert(item);
+    }
+    return std::abs(hll.estimate() - unique_set.size()) / unique_set.size() * 100;
+}
+
+struct Arena {
+    std::vector<char> bytes;
+    std::vector<uint32_t> offsets{0};
+
+    void push(const std::string& key) {
+        bytes.insert(bytes.end(), key.begin(), key.end());
+        offsets.push_back(static_cast<uint32_t>(bytes.size()));
+    }
+
+    size_t size() const {
+        return offsets.size() - 1;
+    }
+};
+
+double measureLoopNs(const HashFuncGen& hash_func, const Arena& arena, std::vector<uint32_t>& out) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < arena.size(); ++i) {
+        out[i] = hash_func.hash(arena.bytes.data() + arena.offsets[i],
+                                arena.offsets[i + 1] - arena.offsets[i]);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / arena.size();
+}
+
+double measureBatchNs(const HashFuncGen& hash_func, const Arena& arena, std::vector<uint32_t>& out) {
+    auto start = std::chrono::high_resolution_clock::now();
+    hash_func.hashBatch(arena.bytes, arena.offsets, out);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / arena.size();
+}
+
+int main() {
+    const uint32_t B = 10;
+    const size_t num_experiments = 10;
+    const size_t stream_size = 100000;
+    const size_t avalanche_keys = 2000;
+    const std::vector<size_t> key_lengths = {3, 8, 16, 31, 64, 256};
+    const std::vector<HashMode> modes = {HashMode::Bytewise, HashMode::Wide};
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Качество и скорость хеш-функций" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::ofstream file("hash_quality_results.csv");
+    file << "mode,test,key_len,value\n";
+
+    std::cout << "\nЛавинный эффект (среднее число изменённых бит из 64, худшее |p - 0.5|):" << std::endl;
+    for (HashMode mode : modes) {
+        HashFuncGen hash_func = HashFuncGen::random(42, mode);
+        for (size_t len : key_lengths) {
+            AvalancheResult r = measureAvalanche(hash_func, len, avalanche_keys);
+            std::cout << "  " << std::setw(8) << std::left << modeName(mode) << std::right
+                      << " длина " << std::setw(3) << len << ": "
+                      << std::fixed << std::setprecision(2) << r.mean_flipped_bits << " бит, "
+                      << std::setprecision(4) << r.worst_bias << std::endl;
+            file << modeName(mode) << ",avalanche_bits," << len << "," << r.mean_flipped_bits << "\n";
+            file << modeName(mode) << ",avalanche_worst_bias," << len << "," << r.worst_bias << "\n";
+        }
+    }
+
+    std::cout << "\nТочность HyperLogLog (B = " << B << ", средняя погрешность по "
+              << num_experiments << " экспериментам):" << std::endl;
+    RandomStreamGen stream_gen(7);
+    std::vector<std::vector<std::string>> random_streams;
+    std::vector<std::vector<std::string>> sequential_streams;
+    for (size_t exp = 0; exp < num_experiments; ++exp) {
+        random_streams.push_back(stream_gen.generateStream(stream_size));
+        std::vector<std::string> sequential;
+        sequential.reserve(stream_size);
+        for (size_t i = 0; i < stream_size; ++i) {
+            sequential.push_back("user-" + std::to_string(exp * stream_size + i));
+        }
+        sequential_streams.push_back(std::move(sequential));
+    }
+    for (HashMode mode : modes) {
+        double err_random = 0.0, err_sequential = 0.0;
+        for (size_t exp = 0; exp < num_experiments; ++exp) {
+            HashFuncGen hash_func = HashFuncGen::random(1000 + exp, mode);
+            err_random += hllError(hash_func, random_streams[exp], B) / num_experiments;
+            err_sequential += hllError(hash_func, sequential_streams[exp], B) / num_experiments;
+        }
+        std::cout << "  " << std::setw(8) << std::left << modeName(mode) << std::right
+                  << " случайные: " << std::fixed << std::setprecision(2) << err_random << "%"
+                  << ", последовательные: " << err_sequential << "%" << std::endl;
+        file << modeName(mode) << ",hll_error_random,0," << err_random << "\n";
+        file << modeName(mode) << ",hll_error_sequential,0," << err_sequential << "\n";
+    }
+
+    std::cout << "\nПропускная способность (нс/ключ, ГБ/с):" << std::endl;
+    for (size_t len : key_lengths) {
+        Arena arena;
+        size_t num_keys = std::max<size_t>(1 << 12, (size_t(64) << 20) / len / 4);
+        for (size_t k = 0; k < num_keys; ++k) {
+            std::string key(len, '\0');
+            for (size_t i = 0; i < len; ++i) key[i] = static_cast<char>('a' + (k * 31 + i * 7) % 26);
+            arena.push(key);
+        }
+        std::vector<uint32_t> out(arena.size());
+        std::cout << "  длина " << std::setw(4) << len << ":";
+        for (HashMode mode : modes) {
+            HashFuncGen hash_func = HashFuncGen::random(42, mode);
+            double ns = measureLoopNs(hash_func, arena, out);
+            double batch_ns = measureBatchNs(hash_func, arena, out);
+            std::cout << "  " << modeName(mode) << " " << std::fixed << std::setprecision(2)
+                      << ns << " нс, " << len / ns << " ГБ/с, пакетом " << batch_ns << " нс;";
+            file << modeName(mode) << ",ns_per_key," << len << "," << ns << "\n";
+            file << modeName(mode) << ",batch_ns_per_key," << len << "," << batch_ns << "\n";
+        }
+        std::cout << std::endl;
+    }
+
+    Arena stream_arena;
+    for (const auto& item : stream_gen.generateStream(1 << 20)) stream_arena.push(item);
+    std::vector<uint32_t> out(stream_arena.size());
+    std::vector<uint32_t> batch_out(stream_arena.size());
+    std::cout << "\nПоток RandomStreamGen (" << stream_arena.size() << " ключей, длина 1..30):" << std::endl;
+    bool exact = true;
+    for (HashMode mode : modes) {
+        HashFuncGen hash_func = HashFuncGen::random(42, mode);
+        double loop_ns = measureLoopNs(hash_func, stream_arena, out);
+        double batch_ns = measureBatchNs(hash_func, stream_arena, batch_out);
+        exact &= out == batch_out;
+        std::cout << "  " << std::setw(8) << std::left << modeName(mode) << std::right
+                  << " по одному: " << std::fixed << std::setprecision(2) << loop_ns
+                  << " нс, hashBatch: " << batch_ns << " нс" << std::endl;
+        file << modeName(mode) << ",stream_loop_ns,0," << loop_ns << "\n";
+        file << modeName(mode) << ",stream_batch_ns,0," << batch_ns << "\n";
+    }
+
+    // Пустые ключи и короткий ключ в самом конце арены — края пакетного пути.
+    Arena edge_arena;
+    for (size_t k = 0; k < 37; ++k) edge_arena.push(std::string(k % 5 == 0 ? 0 : k % 11, 'a' + k % 26));
+    std::vector<uint32_t> edge_out(edge_arena.size());
+    std::vector<uint32_t> edge_batch(edge_arena.size());
+    for (HashMode mode : modes) {
+        HashFuncGen hash_func = HashFuncGen::random(42, mode);
+        measureLoopNs(hash_func, edge_arena, edge_out);
+        measureBatchNs(hash_func, edge_arena, edge_batch);
+        exact &= edge_out == edge_batch;
+    }
+
+    std::cout << "\nРезультаты сохранены в hash_quality_results.csv" << std::endl;
+    if (!exact) {
+        std::cout << "\nhashBatch расходится с hash()!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "hyperloglog.h"
+#include "stream_sketches.h"
+#include "stream_generator.h"
+#include "hash_function.h"
+
+// Число различных ключей и самые частые ключи: два отдельных прохода (хеш для
+// HyperLogLog, затем заново хеш для Count-Min и SpaceSaving) против одного
+// прохода StreamSketches с одним хешем на ключ. Поток не помещается в кэш,
+// так что второй проход заново читает его из памяти. Оценки обоих вариантов
+// должны совпасть в точности; частоты сверяются с точным подсчётом.
+//
+//   main_heavy_hitters [длина потока]
+
+template <class F>
+double measureSeconds(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    const uint64_t stream_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8000000;
+    const uint64_t block = uint64_t(1) << 20;
+    const size_t repeats = 3;
+    const size_t shown = 10;
+
+    StreamSketchesConfig config;
+    StreamConfig stream_config;
+    stream_config.size = stream_size;
+    stream_config.distinct = std::max<uint64_t>(1, stream_size / 10);
+    stream_config.zipf_s = 1.1;
+    stream_config.seed = 11;
+    const HashFuncGen hash_func(0x9e3779b97f4a7c15ULL, 0x517cc1b727220a95ULL, HashMode::Wide);
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Различные ключи и частые ключи за проход" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Поток " << stream_size << " элементов, различных " << stream_config.distinct
+              << ", повторы по Ципфу s = " << stream_config.zipf_s << std::endl;
+    std::cout << "HyperLogLog B = " << config.hll_b << ", Count-Min " << config.cms_depth << " x 2^"
+              << config.cms_width_bits << ", SpaceSaving на " << config.top_k_capacity
+              << " счётчиков, в ответе " << config.top_k << " ключей" << std::endl;
+
+    ArenaStreamGen gen(stream_config);
+    std::vector<KeyArena> blocks;
+    for (uint64_t begin = 0; begin < stream_size; begin += block) {
+        blocks.emplace_back();
+        gen.generate(begin, std::min(block, stream_size - begin), blocks.back());
+    }
+
+    HyperLogLog hll(config.hll_b);
+    CountMinSketch cms(config.cms_width_bits, config.cms_depth);
+    SpaceSavingTopK top_k(config.top_k_capacity);
+    StreamSketches single(hash_func, config);
+    std::vector<uint32_t> hashes;
+    std::vector<double> separate_s, single_s;
+    for (size_t r = 0; r < repeats; ++r) {
+        hll.reset();
+        cms.reset();
+        top_k.reset();
+        separate_s.push_back(measureSeconds([&] {
+            for (const KeyArena& arena : blocks) {
+                hashes.resize(arena.size());
+                hash_func.hashBatch(arena.chars, arena.offsets, hashes);
+                hll.addBatch(hashes);
+            }
+            for (const KeyArena& arena : blocks) {
+                for (size_t i = 0; i < arena.size(); ++i) {
+                    std::string_view key = arena.key(i);
+                    uint64_t hash = hash_func.hash64(key.data(), key.size());
+                    cms.add(hash);
+                    top_k.add(hash, key);
+                }
+            }
+        }));
+        single.reset();
+        single_s.push_back(measureSeconds([&] {
+            for (const KeyArena& arena : blocks) single.addBatch(arena.chars, arena.offsets);
+        }));
+    }
+    double separate_best = *std::min_element(separate_s.begin(), separate_s.end());
+    double single_best = *std::min_element(single_s.begin(), single_s.end());
+
+    std::vector<TopKEntry> top = single.top();
+    std::vector<TopKEntry> separate_top = top_k.top();
+    separate_top.resize(std::min(separate_top.size(), config.top_k));
+    bool same = hll.estimate() == single.estimateDistinct() && cms == single.getCountMin() &&
+                separate_top.size() == top.size() &&
+                std::equal(top.begin(), top.end(), separate_top.begin(), [](const TopKEntry& a, const TopKEntry& b) {
+                    return a.hash == b.hash && a.count == b.count && a.error == b.error;
+                });
+
+    std::cout << "\nнс на элемент (лучшее из " << repeats << "):" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "  два прохода:  " << separate_best * 1e9 / stream_size << std::endl
+              << "  один проход:  " << single_best * 1e9 / stream_size
+              << "  (быстрее в " << std::setprecision(2) << separate_best / single_best << " раза)" << std::endl;
+    std::cout << "Результаты проходов " << (same ? "совпадают" : "РАЗЛИЧАЮТСЯ") << std::endl;
+
+    std::unordered_map<std::string_view, uint64_t> exact;
+    exact.reserve(stream_config.distinct * 2);
+    for (const KeyArena& arena : blocks) {
+        for (size_t i = 0; i < arena.size(); ++i) ++exact[arena.key(i)];
+    }
+    std::vector<std::pair<uint64_t, std::string_view>> exact_top;
+    exact_top.reserve(exact.size());
+    for (const auto& [key, count] : exact) exact_top.emplace_back(count, key);
+    std::partial_sort(exact_top.begin(), exact_top.begin() + std::min(top.size(), exact_top.size()),
+                      exact_top.end(), std::greater<>());
+    exact_top.resize(std::min(top.size(), exact_top.size()));
+
+    std::unordered_map<std::string_view, uint64_t> found;
+    for (const TopKEntry& e : top) found.emplace(e.key, e.count);
+    size_t recall = 0;
+    for (const auto& [count, key] : exact_top) recall += found.count(key);
+
+    double distinct_error = std::abs(single.estimateDistinct() - static_cast<double>(exact.size())) /
+                            exact.size() * 100;
+    std::cout << "\nРазличных: точно " << exact.size() << ", оценка "
+              << static_cast<uint64_t>(single.estimateDistinct()) << " (ошибка "
+              << std::setprecision(2) << distinct_error << "%)" << std::endl;
+    std::cout << "Из " << exact_top.size() << " самых частых ключей найдено " << recall << std::endl;
+    std::cout << "\n  ключ                              точно  SpaceSaving   Count-Min" << std::endl;
+    for (size_t i = 0; i < std::min(shown, exact_top.size()); ++i) {
+        auto it = found.find(exact_top[i].second);
+        std::cout << "  " << std::setw(30) << std::left << exact_top[i].second << std::right
+                  << std::setw(10) << exact_top[i].first
+                  << std::setw(13) << (it != found.end() ? it->second : 0)
+                  << std::setw(12) << single.estimateFrequency(exact_top[i].second) << std::endl;
+    }
+
+    std::ofstream file("heavy_hitters_results.csv");
+    file << "section,items,value\n";
+    file << "separate_ns_per_item," << stream_size << "," << separate_best * 1e9 / stream_size << "\n";
+    file << "single_ns_per_item," << stream_size << "," << single_best * 1e9 / stream_size << "\n";
+    file << "distinct_true," << stream_size << "," << exact.size() << "\n";
+    file << "distinct_estimate," << stream_size << "," << single.estimateDistinct() << "\n";
+    file << "top_k_recall," << stream_size << "," << recall << "\n";
+    std::cout << "\nРезультаты сохранены в heavy_hitters_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
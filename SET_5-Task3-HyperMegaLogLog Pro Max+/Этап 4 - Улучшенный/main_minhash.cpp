@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperminhash.h"
+#include "hash_function.h"
+
+// Пересечение двух множеств мощности n с общей частью overlap: HyperMinHash
+// (коэффициент Жаккара по совпавшим регистрам) против формулы включений-
+// исключений |A| + |B| - |A ∪ B| на HyperLogLog той же памяти (b + 1 при
+// однобайтовых регистрах). Затем — время матрицы Жаккара для всех пар.
+
+uint32_t fold(uint64_t h) {
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+double relativeError(double estimate, double true_value) {
+    return std::abs(estimate - true_value) / true_value * 100;
+}
+
+int main() {
+    const uint32_t B = 12;
+    const uint64_t n = 200000;
+    const size_t num_experiments = 20;
+    const std::vector<double> overlaps = {0.001, 0.01, 0.05, 0.2, 0.5, 1.0};
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Операции над множествами: HyperMinHash" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Параметр B: " << B << " (HyperMinHash " << HyperMinHash(B).getMemoryUsage()
+              << " байт, HyperLogLog B+1 " << (1 << (B + 1)) << " байт)" << std::endl;
+    std::cout << "Мощность множеств: " << n << ", экспериментов: " << num_experiments << std::endl;
+    std::cout << std::endl;
+
+    std::ofstream file("minhash_results.csv");
+    file << "overlap,true_intersection,true_jaccard,hmh_intersection_error,ie_intersection_error,"
+            "hmh_jaccard_abs_error,hmh_union_error\n";
+
+    std::cout << "  доля общих   |A∩B|   Жаккар   ошибка ∩ HMH, %   ошибка ∩ вкл.-искл., %   ошибка Жаккара" << std::endl;
+    for (double overlap : overlaps) {
+        uint64_t common = static_cast<uint64_t>(n * overlap);
+        double true_union = static_cast<double>(2 * n - common);
+        double true_jaccard = common / true_union;
+        double err_hmh = 0.0, err_ie = 0.0, err_jaccard = 0.0, err_union = 0.0;
+
+        for (size_t exp = 0; exp < num_experiments; ++exp) {
+            uint64_t seed = splitmix64(exp * 7919 + common);
+            HyperMinHash a(B), b(B);
+            HyperLogLog ha(B + 1), hb(B + 1);
+            for (uint64_t i = 0; i < n; ++i) {
+                uint64_t h = splitmix64(seed + i);
+                a.add(h);
+                ha.add(fold(h));
+            }
+            for (uint64_t i = n - common; i < 2 * n - common; ++i) {
+                uint64_t h = splitmix64(seed + i);
+                b.add(h);
+                hb.add(fold(h));
+            }
+
+            HyperLogLog hu = ha;
+            hu.merge(hb);
+            double ie = std::max(0.0, ha.estimate() + hb.estimate() - hu.estimate());
+            err_hmh += relativeError(HyperMinHash::intersectionEstimate(a, b), common) / num_experiments;
+            err_ie += relativeError(ie, common) / num_experiments;
+            err_jaccard += std::abs(HyperMinHash::jaccard(a, b) - true_jaccard) / num_experiments;
+            err_union += relativeError(HyperMinHash::unionEstimate(a, b), true_union) / num_experiments;
+        }
+
+        std::cout << std::fixed << std::setprecision(3) << std::setw(12) << overlap
+                  << std::setw(9) << common << std::setw(9) << true_jaccard
+                  << std::setprecision(2) << std::setw(18) << err_hmh
+                  << std::setw(25) << err_ie
+                  << std::setprecision(4) << std::setw(17) << err_jaccard << std::endl;
+        file << overlap << "," << common << "," << true_jaccard << "," << err_hmh << "," << err_ie << ","
+             << err_jaccard << "," << err_union << "\n";
+    }
+
+    // Матрица всех пар: скетч i покрывает ключи [i * step, i * step + size),
+    // так что соседние скетчи сильно пересекаются, а далёкие — нет.
+    const uint32_t MATRIX_B = 10;
+    const size_t sketches_count = 2000;
+    const uint64_t size = 50000, step = 5000;
+    std::vector<HyperMinHash> sketches(sketches_count, HyperMinHash(MATRIX_B));
+    for (size_t s = 0; s < sketches_count; ++s) {
+        for (uint64_t i = 0; i < size; ++i) sketches[s].add(splitmix64(s * step + i));
+    }
+
+    std::vector<double> matrix;
+    auto start = std::chrono::high_resolution_clock::now();
+    hmhJaccardMatrix(sketches, matrix);
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    size_t pairs = sketches_count * (sketches_count - 1) / 2;
+
+    double neighbour_true = static_cast<double>(size - step) / (size + step);
+    double neighbour_est = 0.0;
+    for (size_t s = 0; s + 1 < sketches_count; ++s) {
+        neighbour_est += matrix[s * sketches_count + s + 1] / (sketches_count - 1);
+    }
+
+    std::cout << "\nМатрица Жаккара: " << sketches_count << " скетчей (B = " << MATRIX_B << "), "
+              << pairs << " пар за " << std::setprecision(1) << total_ms << " мс ("
+              << std::setprecision(1) << total_ms * 1e6 / pairs << " нс на пару)" << std::endl;
+    std::cout << "Соседние скетчи: точный Жаккар " << std::setprecision(4) << neighbour_true
+              << ", средняя оценка " << neighbour_est << std::endl;
+    std::ofstream matrix_file("minhash_matrix.csv");
+    matrix_file << "sketches,b,pairs,total_ms,ns_per_pair,neighbour_true_jaccard,neighbour_mean_estimate\n";
+    matrix_file << sketches_count << "," << MATRIX_B << "," << pairs << "," << total_ms << ","
+                << total_ms * 1e6 / pairs << "," << neighbour_true << "," << neighbour_est << "\n";
+
+    std::cout << "\nРезультаты сохранены в minhash_results.csv и minhash_matrix.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
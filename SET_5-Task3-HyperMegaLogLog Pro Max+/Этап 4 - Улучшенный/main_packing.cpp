@@ -0,0 +1,124 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "hyperloglog_improved.h"
+#include "hyperloglog_tailcut.h"
+#include "hll_packing.h"
+#include "hash_function.h"
+
+// Упаковки регистров: прежние 5 регистров в uint32_t, плотный шестибитный
+// поток (4 регистра на 3 байта) и четырёхбитные смещения от базы (TailCut).
+// Сравниваются память, обновление регистра, распаковка всего массива и слияние.
+
+template <class F>
+double measureNs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+struct PackingResult {
+    size_t bytes;
+    double update_ns;
+    double unpack_ns;
+    double merge_ns;
+};
+
+template <class Registers>
+PackingResult measurePacking(const std::vector<uint32_t>& hashes, uint32_t b,
+                             std::vector<uint8_t>& unpacked, size_t repeats) {
+    uint32_t m = 1u << b;
+    Registers regs, other;
+    regs.reset(m);
+    other.reset(m);
+
+    PackingResult result;
+    result.update_ns = measureNs([&] {
+        for (uint32_t h : hashes) {
+            uint32_t j = h >> (32 - b);
+            uint8_t r = hllRho(h << b, b);
+            if (r > regs.get(j)) regs.set(j, r);
+        }
+    }) / hashes.size();
+    for (size_t i = 0; i < hashes.size(); i += 2) {
+        uint32_t h = hashes[i] * 0x9E3779B1u;
+        uint32_t j = h >> (32 - b);
+        uint8_t r = hllRho(h << b, b);
+        if (r > other.get(j)) other.set(j, r);
+    }
+    result.bytes = regs.getMemoryUsage();
+
+    unpacked.assign(m, 0);
+    result.unpack_ns = measureNs([&] {
+        for (size_t r = 0; r < repeats; ++r) regs.unpack(unpacked.data(), m);
+    }) / repeats / m;
+    result.merge_ns = measureNs([&] {
+        for (size_t r = 0; r < repeats; ++r) regs.merge(other, m);
+    }) / repeats / m;
+    return result;
+}
+
+int main() {
+    const std::vector<uint32_t> precisions = {10, 14, 18};
+    const size_t items_per_register = 8;
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Упаковка регистров HyperLogLogCompact" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::ofstream file("packing_results.csv");
+    file << "layout,b,bytes,update_ns,unpack_ns_per_register,merge_ns_per_register\n";
+
+    const char* names[] = {"5 в слове", "поток 6 бит", "TailCut 4 бита"};
+    const char* csv_names[] = {"packed5", "bitstream6", "tailcut4"};
+
+    for (uint32_t b : precisions) {
+        uint32_t m = 1u << b;
+        std::vector<uint32_t> hashes(static_cast<size_t>(m) * items_per_register);
+        for (size_t i = 0; i < hashes.size(); ++i) {
+            hashes[i] = static_cast<uint32_t>(splitmix64(i + (static_cast<uint64_t>(b) << 40)));
+        }
+        size_t repeats = std::max<size_t>(4, (size_t(1) << 24) / m);
+
+        std::vector<uint8_t> u5, u6, u4;
+        PackingResult results[3] = {
+            measurePacking<HllPacked5Registers>(hashes, b, u5, repeats),
+            measurePacking<HllBitstream6Registers>(hashes, b, u6, repeats),
+            measurePacking<HllTailCutRegisters>(hashes, b, u4, repeats),
+        };
+        bool same = u5 == u6 && u6 == u4;
+
+        std::cout << "\nB = " << b << " (" << m << " регистров, " << hashes.size() << " вставок)"
+                  << (same ? "" : "  (регистры различаются!)") << std::endl;
+        std::cout << "  упаковка            байт   обновление, нс   распаковка, нс/рег   слияние, нс/рег" << std::endl;
+        for (int k = 0; k < 3; ++k) {
+            const PackingResult& r = results[k];
+            std::cout << "  " << std::setw(16) << std::left << names[k] << std::right
+                      << std::setw(8) << r.bytes
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(17) << r.update_ns
+                      << std::setw(21) << std::setprecision(3) << r.unpack_ns
+                      << std::setw(18) << r.merge_ns << std::endl;
+            file << csv_names[k] << "," << b << "," << r.bytes << "," << r.update_ns << ","
+                 << r.unpack_ns << "," << r.merge_ns << "\n";
+        }
+
+        HyperLogLogCompact compact(b);
+        HyperLogLogTailCut tailcut(b);
+        double compact_ns = measureNs([&] { compact.addBatch(hashes); }) / hashes.size();
+        double tailcut_ns = measureNs([&] { tailcut.addBatch(hashes); }) / hashes.size();
+        std::cout << "  addBatch: HyperLogLogCompact " << std::setprecision(2) << compact_ns
+                  << " нс, HyperLogLogTailCut " << tailcut_ns << " нс (переполнений: "
+                  << tailcut.getOverflowCount() << ")" << std::endl;
+        file << "HyperLogLogCompact_add," << b << "," << compact.getMemoryUsage() << "," << compact_ns << ",0,0\n";
+        file << "HyperLogLogTailCut_add," << b << "," << tailcut.getMemoryUsage() << "," << tailcut_ns << ",0,0\n";
+    }
+
+    std::cout << "\nРезультаты сохранены в packing_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
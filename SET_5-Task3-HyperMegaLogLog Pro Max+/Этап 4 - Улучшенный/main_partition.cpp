@@ -0,0 +1,192 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hash_function.h"
+
+// Опыт: вставка с разбиением по окнам регистров против прямой вставки при
+// B = 10..18 и дальше, до массивов больше L2. Пакет хешей раскладывается по
+// старшим битам индекса регистра (проход подсчёта и проход разброса, как в
+// поразрядной сортировке) на окна размером с кэш и уходит в addBatch() уже
+// окно за окном: случайные обращения остаются внутри окна, а окна проходятся
+// по массиву подряд. Каждый регистр хранит максимум rho, поэтому порядок
+// вставок на результат не влияет.
+//
+// Для каждого B скетч с нуля набирает один и тот же поток хешей:
+//   add       — по одному хешу;
+//   addBatch  — пакетами по PARTITION_BATCH;
+//   окно L1   — те же пакеты, разбитые на окна по 16 КБ;
+//   окно L2   — то же с окнами по 256 КБ.
+// Все скетчи должны совпасть по serialize(). В отчёт идёт медиана нс на хеш
+// по нескольким повторам.
+//
+// Проходы подсчёта и разброса стоят ~3-4 нс на хеш, а прямая вставка в
+// массив до 2 МБ попадает в L2, и промахи скрывает внеочередное исполнение;
+// для больших массивов addBatch() уже делает предвыборку. На машине с 48 КБ
+// L1d и 2 МБ L2 разбиение проиграло при всех B до 24, поэтому в скетчи оно
+// не вошло и живёт только здесь.
+
+const size_t PARTITION_BATCH = size_t(1) << 20;
+
+class WindowPartitioner {
+private:
+    static constexpr size_t COUNT_LANES = 4;
+
+    size_t window_bytes;
+    std::vector<uint32_t> scattered;
+    std::vector<uint32_t> counts;
+
+public:
+    explicit WindowPartitioner(size_t window) : window_bytes(window) {}
+
+    // Хеши пакета, переставленные по окнам регистров в порядке индекса.
+    // Пока массив регистров не больше окна, пакет возвращается как есть.
+    std::span<const uint32_t> partition(std::span<const uint32_t> hashes, uint32_t b, size_t register_bytes) {
+        uint32_t window_shift = 0;
+        while (window_shift < b && (register_bytes >> window_shift) > window_bytes) ++window_shift;
+        if (window_shift == 0) return hashes;
+        const uint32_t shift = 32 - window_shift;
+        const size_t windows = size_t(1) << window_shift;
+        const size_t n = hashes.size();
+        const uint32_t* data = hashes.data();
+
+        // Несколько таблиц счётчиков, чтобы соседние хеши одного окна не
+        // ждали друг друга на одной ячейке.
+        counts.assign(COUNT_LANES * windows, 0);
+        size_t i = 0;
+        for (; i + COUNT_LANES <= n; i += COUNT_LANES) {
+            for (size_t lane = 0; lane < COUNT_LANES; ++lane) {
+                ++counts[lane * windows + (data[i + lane] >> shift)];
+            }
+        }
+        for (; i < n; ++i) ++counts[data[i] >> shift];
+        uint32_t offset = 0;
+        for (size_t w = 0; w < windows; ++w) {
+            uint32_t total = 0;
+            for (size_t lane = 0; lane < COUNT_LANES; ++lane) total += counts[lane * windows + w];
+            counts[w] = offset;
+            offset += total;
+        }
+
+        scattered.resize(n);
+        for (i = 0; i < n; ++i) scattered[counts[data[i] >> shift]++] = data[i];
+        return scattered;
+    }
+};
+
+template <class F>
+double measureNs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+double median(std::vector<double> values) {
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+struct PartitionRow {
+    const char* sketch;
+    uint32_t b;
+    size_t register_bytes;
+    double add_ns;
+    double batch_ns;
+    double l1_ns;
+    double l2_ns;
+    bool exact;
+};
+
+template <class Sketch>
+PartitionRow benchPartition(const char* name, uint32_t b, const std::vector<uint32_t>& hashes) {
+    const size_t repeats = 3;
+    auto forEachChunk = [&](auto&& f) {
+        for (size_t i = 0; i < hashes.size(); i += PARTITION_BATCH) {
+            f(std::span<const uint32_t>(hashes.data() + i, std::min(PARTITION_BATCH, hashes.size() - i)));
+        }
+    };
+
+    const size_t register_bytes = Sketch(b).getMemoryUsage();
+    std::vector<double> add_ns, batch_ns, l1_ns, l2_ns;
+    std::vector<uint8_t> records[4];
+    WindowPartitioner l1_windows(16 * 1024);
+    WindowPartitioner l2_windows(256 * 1024);
+    for (size_t r = 0; r < repeats; ++r) {
+        Sketch single(b), batch(b), by_l1(b), by_l2(b);
+        add_ns.push_back(measureNs([&] {
+            for (uint32_t h : hashes) single.add(h);
+        }) / hashes.size());
+        batch_ns.push_back(measureNs([&] {
+            forEachChunk([&](std::span<const uint32_t> part) { batch.addBatch(part); });
+        }) / hashes.size());
+        l1_ns.push_back(measureNs([&] {
+            forEachChunk([&](std::span<const uint32_t> part) {
+                by_l1.addBatch(l1_windows.partition(part, b, register_bytes));
+            });
+        }) / hashes.size());
+        l2_ns.push_back(measureNs([&] {
+            forEachChunk([&](std::span<const uint32_t> part) {
+                by_l2.addBatch(l2_windows.partition(part, b, register_bytes));
+            });
+        }) / hashes.size());
+        records[0] = single.serialize();
+        records[1] = batch.serialize();
+        records[2] = by_l1.serialize();
+        records[3] = by_l2.serialize();
+    }
+
+    bool exact = std::all_of(std::begin(records), std::end(records),
+                             [&](const std::vector<uint8_t>& record) { return record == records[0]; });
+    return {name, b, register_bytes, median(add_ns), median(batch_ns), median(l1_ns), median(l2_ns), exact};
+}
+
+int main() {
+    const size_t count = size_t(1) << 23;
+    const std::vector<uint32_t> precisions = {10, 11, 12, 13, 14, 15, 16, 17, 18, 20, 22, 24};
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Вставка с разбиением по регистрам" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Хешей " << count << ", пакет " << PARTITION_BATCH << ", окна 16 и 256 КБ" << std::endl;
+
+    std::vector<uint32_t> hashes(count);
+    for (size_t i = 0; i < count; ++i) hashes[i] = static_cast<uint32_t>(splitmix64(i));
+
+    std::vector<PartitionRow> rows;
+    for (uint32_t b : precisions) {
+        rows.push_back(benchPartition<HyperLogLog>("HyperLogLog", b, hashes));
+        rows.push_back(benchPartition<HyperLogLogCompact>("HyperLogLogCompact", b, hashes));
+    }
+
+    std::cout << "\n  скетч                B      байт   нс/хеш: add   addBatch   окно L1   окно L2" << std::endl;
+    bool ok = true;
+    for (const PartitionRow& row : rows) {
+        ok &= row.exact;
+        std::cout << "  " << std::setw(19) << std::left << row.sketch << std::right << std::setw(3) << row.b
+                  << std::setw(10) << row.register_bytes << std::fixed << std::setprecision(2)
+                  << std::setw(14) << row.add_ns << std::setw(11) << row.batch_ns
+                  << std::setw(10) << row.l1_ns << std::setw(10) << row.l2_ns
+                  << (row.exact ? "" : "   РАСХОЖДЕНИЕ") << std::endl;
+    }
+
+    std::ofstream file("partition_results.csv");
+    file << "sketch,b,register_bytes,add_ns,add_batch_ns,partitioned_l1_ns,partitioned_l2_ns,exact\n";
+    for (const PartitionRow& row : rows) {
+        file << row.sketch << "," << row.b << "," << row.register_bytes << "," << row.add_ns << ","
+             << row.batch_ns << "," << row.l1_ns << "," << row.l2_ns << "," << row.exact << "\n";
+    }
+    std::cout << "\nРезультаты сохранены в partition_results.csv" << std::endl;
+    if (!ok) {
+        std::cout << "\nВставка с разбиением расходится с прямой!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hyperloglog_fixed.h"
+#include "hash_function.h"
+
+// Классы с точностью, заданной при запуске, против HllSketch с точностью в
+// типе (hyperloglog_fixed.h). У каждой пары одинаковые регистры и формула
+// оценки, поэтому оценки должны совпадать до бита; сравнивается скорость
+// add() по одному хешу и addBatch(). Малое n проверяет разреженный режим.
+
+template <class F>
+double measureNs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+struct PolicyResult {
+    double add_ns;
+    double batch_ns;
+    double estimate;
+    size_t bytes;
+    bool consistent;
+};
+
+template <class Make>
+PolicyResult measureSketch(Make&& make, const std::vector<uint32_t>& hashes) {
+    auto single = make();
+    auto batch = make();
+    PolicyResult result;
+    result.add_ns = measureNs([&] {
+        for (uint32_t h : hashes) single.add(h);
+    }) / hashes.size();
+    result.batch_ns = measureNs([&] { batch.addBatch(hashes); }) / hashes.size();
+    result.estimate = batch.estimate();
+    result.bytes = batch.getMemoryUsage();
+    result.consistent = single.estimate() == result.estimate && batch.validateHistogram();
+    return result;
+}
+
+template <unsigned B>
+bool runPrecision(std::ofstream& file, const std::vector<size_t>& cardinalities) {
+    bool all_same = true;
+    for (size_t n : cardinalities) {
+        std::vector<uint32_t> hashes(n);
+        for (size_t i = 0; i < n; ++i) {
+            hashes[i] = static_cast<uint32_t>(splitmix64(i + (static_cast<uint64_t>(B) << 40)));
+        }
+
+        struct Pair {
+            const char* name;
+            PolicyResult runtime;
+            PolicyResult fixed;
+        };
+        Pair pairs[] = {
+            {"HyperLogLog",
+             measureSketch([] { return HyperLogLog(B); }, hashes),
+             measureSketch([] { return HyperLogLogFixed<B>(); }, hashes)},
+            {"HyperLogLog_sparse",
+             measureSketch([] { return HyperLogLog(B, true); }, hashes),
+             measureSketch([] { return HyperLogLogSparseFixed<B>(); }, hashes)},
+            {"HyperLogLogImproved",
+             measureSketch([] { return HyperLogLogImproved(B); }, hashes),
+             measureSketch([] { return HyperLogLogImprovedFixed<B>(); }, hashes)},
+            {"HyperLogLogCompact",
+             measureSketch([] { return HyperLogLogCompact(B); }, hashes),
+             measureSketch([] { return HyperLogLogCompactFixed<B>(); }, hashes)},
+        };
+
+        std::cout << "\nB = " << B << ", n = " << n << std::endl;
+        std::cout << "  скетч                  add, нс (b / B)   addBatch, нс (b / B)     байт   оценки" << std::endl;
+        for (const Pair& p : pairs) {
+            bool same = p.runtime.estimate == p.fixed.estimate && p.runtime.bytes == p.fixed.bytes &&
+                        p.runtime.consistent && p.fixed.consistent;
+            all_same = all_same && same;
+            std::cout << "  " << std::setw(20) << std::left << p.name << std::right
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(9) << p.runtime.add_ns << " /" << std::setw(6) << p.fixed.add_ns
+                      << std::setw(14) << p.runtime.batch_ns << " /" << std::setw(6) << p.fixed.batch_ns
+                      << std::setw(9) << p.fixed.bytes
+                      << (same ? "   совпадают" : "   РАЗЛИЧАЮТСЯ") << std::endl;
+            file << p.name << "," << B << "," << n << ","
+                 << p.runtime.add_ns << "," << p.fixed.add_ns << ","
+                 << p.runtime.batch_ns << "," << p.fixed.batch_ns << ","
+                 << p.runtime.estimate << "," << p.fixed.estimate << "," << p.fixed.bytes << "\n";
+        }
+    }
+    return all_same;
+}
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Точность при запуске против точности в типе" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    std::ofstream file("policy_results.csv");
+    file << "sketch,b,n,runtime_add_ns,fixed_add_ns,runtime_batch_ns,fixed_batch_ns,"
+            "runtime_estimate,fixed_estimate,bytes\n";
+
+    const size_t large = size_t(1) << 22;
+    bool same = runPrecision<10>(file, {256, large});
+    same = runPrecision<14>(file, {4096, large}) && same;
+
+    std::cout << "\nОценки " << (same ? "совпадают во всех случаях" : "различаются!") << std::endl;
+    std::cout << "\nРезультаты сохранены в policy_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
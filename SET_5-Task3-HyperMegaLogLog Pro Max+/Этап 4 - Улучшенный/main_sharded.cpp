@@ -0,0 +1,173 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hll_merge.h"
+#include "hll_sharded.h"
+#include "stream_generator.h"
+#include "hash_function.h"
+
+// Объединение скетчей и многопоточная вставка: поток делится между потоками,
+// каждый заполняет свой скетч, затем скетчи сливаются. Оценка должна
+// совпадать с однопоточной в точности, а скорость расти с числом ядер.
+
+template <class F>
+double measureNs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+template <class Sketch>
+void runIngest(const char* name, const std::vector<std::string>& stream, const HashFuncGen& hash_func,
+               uint32_t b, const std::vector<size_t>& thread_counts, std::ofstream& file) {
+    double base_ns = 0.0;
+    double base_estimate = 0.0;
+    for (size_t threads : thread_counts) {
+        double estimate = 0.0;
+        double ns = measureNs([&] {
+            Sketch sketch = hllShardedIngest<Sketch>(std::span<const std::string>(stream), hash_func, b, threads);
+            estimate = sketch.estimate();
+        });
+        if (threads == thread_counts.front()) {
+            base_ns = ns;
+            base_estimate = estimate;
+        }
+        double mkeys = stream.size() / ns * 1000.0;
+        std::cout << "  " << std::setw(20) << std::left << name << std::right
+                  << " потоков " << std::setw(2) << threads << ": "
+                  << std::fixed << std::setprecision(1) << std::setw(7) << mkeys << " млн ключей/с, ускорение "
+                  << std::setprecision(2) << base_ns / ns
+                  << (estimate == base_estimate ? "" : "  (оценка отличается!)") << std::endl;
+        file << name << ",ingest," << threads << "," << mkeys << "," << estimate << "\n";
+    }
+}
+
+int main() {
+    const uint32_t B = 14;
+    const size_t stream_size = 1 << 21;
+    const size_t merge_repeats = 2000;
+    const std::vector<uint32_t> merge_precisions = {10, 14, 18};
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<size_t> thread_counts = {1};
+    for (size_t t = 2; t <= std::max<size_t>(cores, 4); t *= 2) thread_counts.push_back(t);
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Объединение и многопоточная вставка" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Параметр B: " << B << ", ключей: " << stream_size
+              << ", ядер: " << cores << std::endl;
+
+    RandomStreamGen stream_gen(42);
+    std::vector<std::string> stream = stream_gen.generateStream(stream_size);
+    HashFuncGen hash_func = HashFuncGen::random(42);
+
+    std::ofstream file("sharded_results.csv");
+    file << "sketch,test,param,value,estimate\n";
+
+    std::cout << "\nВставка с разбиением потока:" << std::endl;
+    runIngest<HyperLogLog>("HyperLogLog", stream, hash_func, B, thread_counts, file);
+    runIngest<HyperLogLogImproved>("HyperLogLogImproved", stream, hash_func, B, thread_counts, file);
+    runIngest<HyperLogLogCompact>("HyperLogLogCompact", stream, hash_func, B, thread_counts, file);
+
+    std::cout << "\nСлияние двух заполненных скетчей (нс на слияние, первое слияние / добавка"
+              << " m/128 ключей / повторное):" << std::endl;
+    bool histograms_ok = true;
+    for (uint32_t b : merge_precisions) {
+        std::vector<uint32_t> hashes(stream.size());
+        for (size_t i = 0; i < stream.size(); ++i) hashes[i] = hash_func.hash(stream[i]);
+        size_t half = hashes.size() / 2;
+        std::span<const uint32_t> all(hashes);
+
+        HyperLogLog dense_a(b), dense_b(b);
+        dense_a.addBatch(all.first(half));
+        dense_b.addBatch(all.subspan(half));
+        HyperLogLogCompact compact_a(b), compact_b(b);
+        compact_a.addBatch(all.first(half));
+        compact_b.addBatch(all.subspan(half));
+
+        // Добавка из m / 128 новых ключей поднимает мало регистров.
+        std::span<const uint32_t> delta = all.subspan(half, size_t(1) << (b - 7));
+        HyperLogLog dense_delta(b);
+        dense_delta.addBatch(delta);
+        HyperLogLogCompact compact_delta(b);
+        compact_delta.addBatch(delta);
+
+        size_t repeats = std::max<size_t>(4, merge_repeats >> (b - 10));
+        // Первое слияние поднимает около половины регистров, и гистограмма
+        // пересчитывается; добавка обновляет её по поднятым регистрам;
+        // повторные слияния уже ничего не меняют.
+        std::vector<HyperLogLog> dense_fresh(repeats, dense_a);
+        std::vector<HyperLogLogCompact> compact_fresh(repeats, compact_a);
+        double dense_delta_ns = measureNs([&] {
+            for (auto& sketch : dense_fresh) sketch.merge(dense_delta);
+        }) / repeats;
+        double compact_delta_ns = measureNs([&] {
+            for (auto& sketch : compact_fresh) sketch.merge(compact_delta);
+        }) / repeats;
+        histograms_ok &= dense_fresh.back().validateHistogram() && compact_fresh.back().validateHistogram();
+        double dense_first_ns = measureNs([&] {
+            for (auto& sketch : dense_fresh) sketch.merge(dense_b);
+        }) / repeats;
+        double compact_first_ns = measureNs([&] {
+            for (auto& sketch : compact_fresh) sketch.merge(compact_b);
+        }) / repeats;
+        histograms_ok &= dense_fresh.back().validateHistogram() && compact_fresh.back().validateHistogram();
+        double dense_ns = measureNs([&] {
+            for (size_t r = 0; r < repeats; ++r) dense_fresh.back().merge(dense_b);
+        }) / repeats;
+        double compact_ns = measureNs([&] {
+            for (size_t r = 0; r < repeats; ++r) compact_fresh.back().merge(compact_b);
+        }) / repeats;
+
+        // Только максимум по регистрам, без гистограммы.
+        std::vector<uint8_t> regs_a(1u << b, 1), regs_b(1u << b, 2);
+        double simd_ns = measureNs([&] {
+            for (size_t r = 0; r < repeats; ++r) hllMergeMax(regs_a.data(), regs_b.data(), regs_a.size());
+        }) / repeats;
+        std::vector<uint32_t> words_a((1u << b) / HLL_PACKED6_PER_WORD + 1, 0x1041041);
+        std::vector<uint32_t> words_b(words_a.size(), 0x2082082);
+        double packed_ns = measureNs([&] {
+            for (size_t r = 0; r < repeats; ++r) hllMergePacked6(words_a.data(), words_b.data(), words_a.size());
+        }) / repeats;
+        double packed_scalar_ns = measureNs([&] {
+            for (size_t r = 0; r < repeats; ++r) {
+                for (size_t i = 0; i < words_a.size(); ++i) {
+                    words_a[i] = hllMergePacked6Word(words_a[i], words_b[i]);
+                }
+            }
+        }) / repeats;
+
+        std::cout << "  b = " << std::setw(2) << b << std::fixed << std::setprecision(0)
+                  << ": HyperLogLog " << dense_first_ns << " / " << dense_delta_ns << " / " << dense_ns
+                  << " нс (максимум " << simd_ns << " нс), HyperLogLogCompact " << compact_first_ns << " / "
+                  << compact_delta_ns << " / " << compact_ns << " нс (упакованный максимум "
+                  << packed_ns << " нс, поштучно " << packed_scalar_ns << " нс)" << std::endl;
+        file << "HyperLogLog,merge_first_ns," << b << "," << dense_first_ns << ",0\n";
+        file << "HyperLogLog,merge_delta_ns," << b << "," << dense_delta_ns << ",0\n";
+        file << "HyperLogLog,merge_ns," << b << "," << dense_ns << ",0\n";
+        file << "HyperLogLog,merge_max_ns," << b << "," << simd_ns << ",0\n";
+        file << "HyperLogLogCompact,merge_first_ns," << b << "," << compact_first_ns << ",0\n";
+        file << "HyperLogLogCompact,merge_delta_ns," << b << "," << compact_delta_ns << ",0\n";
+        file << "HyperLogLogCompact,merge_ns," << b << "," << compact_ns << ",0\n";
+        file << "HyperLogLogCompact,merge_packed_ns," << b << "," << packed_ns << ",0\n";
+        file << "HyperLogLogCompact,merge_packed_scalar_ns," << b << "," << packed_scalar_ns << ",0\n";
+    }
+
+    if (!histograms_ok) {
+        std::cout << "\nГистограмма после слияния расходится с регистрами!" << std::endl;
+        return 1;
+    }
+
+    std::cout << "\nРезультаты сохранены в sharded_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
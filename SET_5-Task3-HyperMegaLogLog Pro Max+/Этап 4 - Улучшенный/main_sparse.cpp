@@ -0,0 +1,99 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hash_function.h"
+
+// Память и точность разреженного режима на малых мощностях: для каждой
+// мощности n строится num_experiments скетчей из n различных ключей.
+
+struct SparseResult {
+    uint64_t true_count;
+    double err_dense = 0.0;
+    double err_sparse = 0.0;
+    double mem_dense = 0.0;
+    double mem_sparse = 0.0;
+    double mem_compact_sparse = 0.0;
+    size_t still_sparse = 0;
+};
+
+uint32_t fold(uint64_t h) {
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+double relativeError(double estimate, uint64_t true_count) {
+    return std::abs(estimate - static_cast<double>(true_count)) / true_count * 100;
+}
+
+int main() {
+    const uint32_t B = 14;
+    const size_t num_experiments = 200;
+    const std::vector<uint64_t> cardinalities = {
+        10, 30, 100, 300, 1000, 3000, 10000, 30000
+    };
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Разреженный режим HyperLogLog" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Параметр B: " << B << " (регистров: " << (1 << B) << ")" << std::endl;
+    std::cout << "Количество экспериментов: " << num_experiments << std::endl;
+    std::cout << std::endl;
+
+    std::vector<SparseResult> results;
+    for (uint64_t n : cardinalities) {
+        SparseResult r;
+        r.true_count = n;
+
+        for (size_t exp = 0; exp < num_experiments; ++exp) {
+            uint64_t seed = splitmix64(n * 1000003 + exp);
+            HyperLogLog dense(B);
+            HyperLogLog sparse(B, true);
+            HyperLogLogCompact compact_sparse(B, true);
+
+            for (uint64_t i = 0; i < n; ++i) {
+                uint32_t h = fold(splitmix64(seed + i));
+                dense.add(h);
+                sparse.add(h);
+                compact_sparse.add(h);
+            }
+
+            r.err_dense += relativeError(dense.estimate(), n) / num_experiments;
+            r.err_sparse += relativeError(sparse.estimate(), n) / num_experiments;
+            r.mem_dense += static_cast<double>(dense.getMemoryUsage()) / num_experiments;
+            r.mem_sparse += static_cast<double>(sparse.getMemoryUsage()) / num_experiments;
+            r.mem_compact_sparse += static_cast<double>(compact_sparse.getMemoryUsage()) / num_experiments;
+            if (sparse.isSparse()) r.still_sparse++;
+        }
+        results.push_back(r);
+    }
+
+    std::ofstream file("sparse_results.csv");
+    file << "true_count,err_dense,err_sparse,mem_dense,mem_sparse,mem_compact_sparse,sparse_share\n";
+    for (const auto& r : results) {
+        file << r.true_count << ","
+             << std::fixed << std::setprecision(3)
+             << r.err_dense << "," << r.err_sparse << ","
+             << r.mem_dense << "," << r.mem_sparse << "," << r.mem_compact_sparse << ","
+             << static_cast<double>(r.still_sparse) / num_experiments << "\n";
+    }
+    std::cout << "Результаты сохранены в sparse_results.csv" << std::endl;
+
+    std::cout << "\n      n   погр. плотн.  погр. разр.   байт плотн.  байт разр.  байт разр.(компакт)" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& r : results) {
+        std::cout << std::setw(7) << r.true_count
+                  << std::setw(13) << r.err_dense << "%"
+                  << std::setw(12) << r.err_sparse << "%"
+                  << std::setw(14) << std::setprecision(0) << r.mem_dense
+                  << std::setw(12) << r.mem_sparse
+                  << std::setw(14) << r.mem_compact_sparse
+                  << std::setprecision(2) << std::endl;
+    }
+
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hll_store.h"
+#include "hash_function.h"
+
+// Хранилище скетчей на диске: сколько стоит пересобрать скетчи из сырых
+// данных, сохранить их, отобразить файл и ответить на запросы прямо из
+// отображения, по сравнению с полной десериализацией в память.
+
+template <class F>
+double measureMs(F&& f) {
+    auto start = std::chrono::high_resolution_clock::now();
+    f();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::string sketchKey(size_t i) {
+    return "sketch-" + std::to_string(i);
+}
+
+int main() {
+    const uint32_t B = 12;
+    const size_t num_sketches = 10000;
+    const size_t max_items = 10000;
+    const size_t num_lookups = 1000;
+    const std::string path = "sketch_store.bin";
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Хранилище скетчей с отображением в память" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Скетчей: " << num_sketches << ", B = " << B
+              << ", до " << max_items << " элементов в скетче" << std::endl;
+
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<size_t> items_dist(1, max_items);
+    std::vector<size_t> sizes(num_sketches);
+    for (auto& n : sizes) n = items_dist(rng);
+
+    std::vector<HyperLogLog> dense;
+    std::vector<HyperLogLogCompact> compact;
+    dense.reserve(num_sketches / 2);
+    compact.reserve(num_sketches / 2);
+    size_t total_items = 0;
+    double rebuild_ms = measureMs([&] {
+        for (size_t i = 0; i < num_sketches; ++i) {
+            std::vector<uint32_t> hashes(sizes[i]);
+            for (size_t k = 0; k < sizes[i]; ++k) {
+                hashes[k] = static_cast<uint32_t>(splitmix64((static_cast<uint64_t>(i) << 32) | k));
+            }
+            if (i % 2 == 0) {
+                dense.emplace_back(B);
+                dense.back().addBatch(hashes);
+            } else {
+                compact.emplace_back(B);
+                compact.back().addBatch(hashes);
+            }
+            total_items += sizes[i];
+        }
+    });
+
+    HllStoreWriter writer;
+    double write_ms = measureMs([&] {
+        for (size_t i = 0; i < num_sketches; ++i) {
+            writer.add(sketchKey(i), i % 2 == 0 ? dense[i / 2].serialize() : compact[i / 2].serialize());
+        }
+        if (!writer.write(path)) {
+            std::cerr << "Не удалось записать " << path << std::endl;
+            std::exit(1);
+        }
+    });
+
+    HllStore store;
+    double open_ms = measureMs([&] {
+        if (!store.open(path)) {
+            std::cerr << "Не удалось открыть " << path << std::endl;
+            std::exit(1);
+        }
+    });
+
+    size_t mismatches = 0;
+    double estimate_all_ms = measureMs([&] {
+        for (size_t i = 0; i < num_sketches; ++i) {
+            std::optional<HllRecordView> record = store.find(sketchKey(i));
+            double expected = i % 2 == 0 ? dense[i / 2].estimate() : compact[i / 2].estimate();
+            if (!record || hllEstimateRecord(*record) != expected) mismatches++;
+        }
+    });
+
+    std::uniform_int_distribution<size_t> key_dist(0, num_sketches - 1);
+    double checksum = 0.0;
+    double lookup_ms = measureMs([&] {
+        for (size_t q = 0; q < num_lookups; ++q) {
+            std::optional<HllRecordView> record = store.find(sketchKey(key_dist(rng)));
+            if (record) checksum += hllEstimateRecord(*record);
+        }
+    });
+
+    HyperLogLog merged(B);
+    double merge_ms = measureMs([&] {
+        for (size_t i = 0; i < num_sketches; i += 2) {
+            merged.merge(*store.find(sketchKey(i)));
+        }
+    });
+    HyperLogLog merged_in_memory(B);
+    for (const auto& sketch : dense) merged_in_memory.merge(sketch);
+    if (merged.estimate() != merged_in_memory.estimate()) mismatches++;
+
+    size_t loaded = 0;
+    double deserialize_ms = measureMs([&] {
+        std::vector<HyperLogLog> dense_loaded;
+        std::vector<HyperLogLogCompact> compact_loaded;
+        for (uint32_t i = 0; i < store.size(); ++i) {
+            std::span<const uint8_t> bytes = store.recordBytes(i);
+            if (store.recordAt(i)->kind == HllSketchKind::HyperLogLogCompact) {
+                compact_loaded.push_back(*HyperLogLogCompact::deserialize(bytes));
+            } else {
+                dense_loaded.push_back(*HyperLogLog::deserialize(bytes));
+            }
+        }
+        loaded = dense_loaded.size() + compact_loaded.size();
+    });
+
+    // Испорченный регистр: значение больше 33 - B, в том числе за пределами
+    // гистограммы (64 и больше), должно отвергаться при разборе записи.
+    size_t corrupt_accepted = 0;
+    for (uint8_t bad : {static_cast<uint8_t>(hllMaxRegisterValue(B) + 1), uint8_t{64}, uint8_t{255}}) {
+        std::vector<uint8_t> record = dense.front().serialize();
+        record[sizeof(HllRecordHeader) + record.size() / 3] = bad;
+        if (HllRecordView::parse(record) || HyperLogLog::deserialize(record)) corrupt_accepted++;
+    }
+    {
+        std::vector<uint8_t> record = compact.front().serialize();
+        uint8_t regs[4];
+        uint8_t* group = record.data() + sizeof(HllRecordHeader) + 3 * 100;
+        hllUnpackBitstream6(group, regs, 4);
+        regs[1] = HLL_BITSTREAM_MASK;
+        hllPackBitstream6(regs, group, 4);
+        if (HllRecordView::parse(record) || HyperLogLogCompact::deserialize(record)) corrupt_accepted++;
+    }
+    if (!HllRecordView::parse(dense.front().serialize()) || !HllRecordView::parse(compact.front().serialize())) {
+        corrupt_accepted++;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "\nПересборка из сырых данных (" << total_items << " элементов): " << rebuild_ms << " мс" << std::endl;
+    std::cout << "Сериализация и запись: " << write_ms << " мс" << std::endl;
+    std::cout << "Открытие (mmap и проверка индекса): " << open_ms << " мс" << std::endl;
+    std::cout << "Оценка всех скетчей из отображения: " << estimate_all_ms << " мс" << std::endl;
+    std::cout << "Поиск и оценка " << num_lookups << " случайных ключей: " << lookup_ms << " мс" << std::endl;
+    std::cout << "Слияние " << num_sketches / 2 << " скетчей из отображения: " << merge_ms << " мс" << std::endl;
+    std::cout << "Полная десериализация " << loaded << " скетчей: " << deserialize_ms << " мс" << std::endl;
+    std::cout << "Расхождений с оценками в памяти: " << mismatches << std::endl;
+    std::cout << "Ошибок проверки регистров при разборе: " << corrupt_accepted << std::endl;
+
+    std::remove(path.c_str());
+
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return mismatches == 0 && corrupt_accepted == 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "hyperloglog.h"
+#include "hll_mapped_file.h"
+#include "hll_pipeline.h"
+#include "hash_function.h"
+#include "stream_generator.h"
+
+// Подсчёт различных строк в файлах с построчными ключами без загрузки в память:
+//
+//   main_stream [-b B] [-t потоков хеширования] [--chunk-mb N] [файл | -]...
+//   main_stream --generate N файл
+//
+// Файлы отображаются в память, "-" или отсутствие файлов — чтение stdin
+// большими блоками. Для каждого входа печатаются оценка, строк/с и ГБ/с;
+// строки добавляются в stream_results.csv. --generate пишет N случайных
+// строк RandomStreamGen и печатает точное число различных для проверки.
+
+void printUsage() {
+    std::cerr << "Использование: main_stream [-b B] [-t потоков] [--chunk-mb N] [файл | -]...\n"
+              << "               main_stream --generate N файл" << std::endl;
+}
+
+int generateFile(size_t count, const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Не удалось создать " << path << std::endl;
+        return 1;
+    }
+    RandomStreamGen gen(42);
+    std::unordered_set<std::string> distinct;
+    for (size_t i = 0; i < count; ++i) {
+        std::string s = gen.generateString();
+        out << s << '\n';
+        distinct.insert(std::move(s));
+    }
+    std::cout << "Записано строк: " << count << ", различных: " << distinct.size() << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t B = 14;
+    HllPipelineOptions options;
+    options.hasher_threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--generate" && i + 2 < argc) {
+            return generateFile(std::strtoull(argv[i + 1], nullptr, 10), argv[i + 2]);
+        } else if (arg == "-b" && has_value) {
+            B = static_cast<uint32_t>(std::atoi(argv[++i]));
+        } else if (arg == "-t" && has_value) {
+            options.hasher_threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--chunk-mb" && has_value) {
+            options.chunk_bytes = static_cast<size_t>(std::max(1, std::atoi(argv[++i]))) << 20;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            printUsage();
+            return 1;
+        } else {
+            inputs.emplace_back(arg);
+        }
+    }
+    if (B < 4 || B > 18) {
+        printUsage();
+        return 1;
+    }
+    if (inputs.empty()) inputs.emplace_back("-");
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Потоковый подсчёт различных строк" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Параметр B: " << B << ", потоков хеширования: " << options.hasher_threads
+              << ", кусок: " << (options.chunk_bytes >> 20) << " МБ" << std::endl;
+    std::cout << std::endl;
+
+    std::ofstream file("stream_results.csv");
+    file << "input,lines,bytes,estimate,seconds,lines_per_second,gb_per_second\n";
+
+    HashFuncGen hash_gen(0x9e3779b97f4a7c15ULL, 0x517cc1b727220a95ULL, HashMode::Wide);
+    for (const std::string& input : inputs) {
+        HyperLogLog sketch(B);
+        HllPipelineStats stats;
+        if (input == "-") {
+            stats = hllRunLinePipeline([&](auto&& emit) { hllSplitStream(stdin, options.chunk_bytes, emit); },
+                                       hash_gen, sketch, options);
+        } else {
+            HllMappedFile mapped;
+            if (!mapped.open(input, true)) {
+                std::cerr << "Не удалось открыть " << input << " (или файл пуст)" << std::endl;
+                continue;
+            }
+            stats = hllRunLinePipeline([&](auto&& emit) { hllSplitMapped(mapped.bytes(), options.chunk_bytes, emit); },
+                                       hash_gen, sketch, options);
+        }
+
+        double estimate = sketch.estimate();
+        std::cout << (input == "-" ? "stdin" : input) << ":" << std::endl;
+        std::cout << "  строк: " << stats.lines << ", байт: " << stats.bytes << std::endl;
+        std::cout << "  оценка различных: " << std::fixed << std::setprecision(0) << estimate << std::endl;
+        std::cout << "  время: " << std::setprecision(3) << stats.seconds << " с, "
+                  << std::setprecision(2) << stats.linesPerSecond() / 1e6 << " млн строк/с, "
+                  << stats.gigabytesPerSecond() << " ГБ/с" << std::endl;
+        file << input << "," << stats.lines << "," << stats.bytes << "," << estimate << ","
+             << stats.seconds << "," << stats.linesPerSecond() << "," << stats.gigabytesPerSecond() << "\n";
+    }
+
+    std::cout << "\nРезультаты сохранены в stream_results.csv" << std::endl;
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <thread>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_improved.h"
+#include "hll_telemetry.h"
+#include "hash_function.h"
+
+// Телеметрия скетчей под нагрузкой: несколько потоков заполняют каждый свой
+// HyperLogLog(14) через add() и addBatch() и создают поток маленьких
+// разреженных HyperLogLogCompact, часть из которых переходит в плотный режим.
+// Раз в 100 мс фоновый HllTelemetryReporter печатает строку отчёта; в конце
+// итоги сверяются с числом вставок. Собранная без HLL_TELEMETRY программа
+// делает ту же работу, и разница в нс на вставку — цена телеметрии.
+//
+//   g++ -std=c++20 -O2 -DHLL_TELEMETRY main_telemetry.cpp
+
+int main() {
+    const uint32_t threads = std::max(2u, std::thread::hardware_concurrency());
+    const uint64_t adds_per_thread = 20000000;
+    const uint32_t small_sketches = 2000;
+    const uint64_t small_items = 600;
+    const uint32_t B = 14;
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  Телеметрия HyperLogLog" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Потоков " << threads << ", вставок на поток " << adds_per_thread
+              << ", телеметрия " << (HLL_TELEMETRY_ENABLED ? "включена" : "выключена (-DHLL_TELEMETRY)")
+              << "\n" << std::endl;
+
+    std::vector<double> estimates(threads);
+    auto start = std::chrono::steady_clock::now();
+    {
+        HllTelemetryReporter reporter(std::cout, std::chrono::milliseconds(100));
+        std::vector<std::thread> workers;
+        for (uint32_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                HyperLogLog sketch(B);
+                const uint64_t base = static_cast<uint64_t>(t) << 40;
+                const uint64_t half = adds_per_thread / 2;
+                for (uint64_t i = 0; i < half; ++i) sketch.add(static_cast<uint32_t>(splitmix64(base + i)));
+                std::vector<uint32_t> batch(4096);
+                for (uint64_t i = half; i < adds_per_thread; i += batch.size()) {
+                    const size_t n = std::min<uint64_t>(batch.size(), adds_per_thread - i);
+                    for (size_t k = 0; k < n; ++k) {
+                        batch[k] = static_cast<uint32_t>(splitmix64(base + i + k));
+                    }
+                    sketch.addBatch(std::span<const uint32_t>(batch.data(), n));
+                }
+                // Маленькие скетчи: чётные остаются разреженными, нечётные
+                // получают вдвое больше элементов и переходят в плотный режим.
+                for (uint32_t s = 0; s < small_sketches; ++s) {
+                    HyperLogLogCompact small(10, true);
+                    uint64_t items = s % 2 == 0 ? small_items / 20 : small_items * 2;
+                    for (uint64_t i = 0; i < items; ++i) {
+                        small.add(static_cast<uint32_t>(splitmix64(base + (uint64_t(s) << 20) + i + 1)));
+                    }
+                }
+                estimates[t] = sketch.estimate();
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    HllTelemetrySnapshot total = hllTelemetrySnapshot();
+    const uint64_t big_adds = threads * adds_per_thread;
+    const uint64_t small_adds = static_cast<uint64_t>(threads) * (small_sketches / 2) *
+                                (small_items / 20 + small_items * 2);
+    const double ns_per_add = seconds * 1e9 * threads / (big_adds + small_adds);
+    std::cout << "\nВремя " << std::fixed << std::setprecision(3) << seconds << " с, "
+              << std::setprecision(2) << ns_per_add << " нс на вставку (на поток)" << std::endl;
+    std::cout << "Оценка первого потока " << std::setprecision(0) << estimates[0]
+              << " при точном " << adds_per_thread << std::endl;
+
+    bool ok = true;
+    if constexpr (HLL_TELEMETRY_ENABLED) {
+        uint64_t counted = total[HllCounter::DenseAdds] + total[HllCounter::SparseAdds];
+        ok = counted == big_adds + small_adds &&
+             total[HllCounter::Promotions] == static_cast<uint64_t>(threads) * (small_sketches / 2);
+        std::cout << "Учтено вставок " << counted << " из " << big_adds + small_adds
+                  << ", переходов в плотный режим " << total[HllCounter::Promotions] << std::endl;
+    }
+
+    std::ofstream file("telemetry_results.csv");
+    file << "telemetry,threads,ns_per_add,dense_adds,register_updates,noop_fraction,"
+            "saturated_registers,sparse_adds,promotions\n";
+    file << HLL_TELEMETRY_ENABLED << "," << threads << "," << ns_per_add << ","
+         << total[HllCounter::DenseAdds] << "," << total[HllCounter::RegisterUpdates] << ","
+         << total.noOpFraction() << "," << total[HllCounter::SaturatedRegisters] << ","
+         << total[HllCounter::SparseAdds] << "," << total[HllCounter::Promotions] << "\n";
+    std::cout << "\nРезультаты сохранены в telemetry_results.csv" << std::endl;
+    if (!ok) {
+        std::cout << "\nСчётчики телеметрии не сходятся с числом вставок!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
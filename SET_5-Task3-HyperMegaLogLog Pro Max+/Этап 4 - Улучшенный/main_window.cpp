@@ -0,0 +1,157 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "hyperloglog.h"
+#include "hyperloglog_window.h"
+#include "hash_function.h"
+
+// Скользящее окно: поток событий по секундам, ключи берутся из «дрейфующей»
+// популяции, так что старые ключи постепенно уходят. В контрольные моменты
+// оценка каждого окна сравнивается с точным числом различных ключей и с
+// обычным HyperLogLog, заново построенным только на событиях окна (регистры
+// должны совпасть в точности).
+
+struct Event {
+    uint64_t time;
+    uint32_t hash;
+    uint64_t key;
+};
+
+uint32_t fold(uint64_t h) {
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+double relativeError(double estimate, uint64_t true_count) {
+    return std::abs(estimate - static_cast<double>(true_count)) / true_count * 100;
+}
+
+int main() {
+    const uint32_t B = 12;
+    const uint64_t duration = 1200;
+    const uint64_t horizon = 900;
+    const size_t events_per_second = 2000;
+    const uint64_t population = 50000;
+    const uint64_t drift_per_second = 100;
+    const uint64_t checkpoint_every = 150;
+    const std::vector<uint64_t> windows = {10, 60, 300, 900};
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  HyperLogLog со скользящим окном" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "Параметр B: " << B << " (регистров: " << (1 << B) << ")" << std::endl;
+    std::cout << "Горизонт: " << horizon << " с, событий в секунду: " << events_per_second << std::endl;
+    std::cout << std::endl;
+
+    std::vector<Event> events;
+    events.reserve(duration * events_per_second);
+    for (uint64_t t = 1; t <= duration; ++t) {
+        for (size_t i = 0; i < events_per_second; ++i) {
+            uint64_t key = t * drift_per_second + splitmix64(t * events_per_second + i) % population;
+            events.push_back({t, fold(splitmix64(key ^ 0xA5A5A5A5ull)), key});
+        }
+    }
+
+    std::ofstream file("window_results.csv");
+    file << "time,window,true_count,estimate,rebuilt_estimate,error_percent,entries,max_list,memory_bytes\n";
+
+    HyperLogLogWindow sketch(B, horizon);
+    std::unordered_map<uint64_t, uint64_t> last_seen;
+    double add_ns = 0.0;
+    size_t mismatches = 0;
+    size_t pos = 0;
+
+    std::cout << "   время   окно   точно   оценка   ошибка, %   пар   макс. список   память, байт" << std::endl;
+    for (uint64_t t = 1; t <= duration; ++t) {
+        size_t begin = pos;
+        while (pos < events.size() && events[pos].time == t) ++pos;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = begin; i < pos; ++i) sketch.add(events[i].hash, events[i].time);
+        auto end = std::chrono::high_resolution_clock::now();
+        add_ns += std::chrono::duration<double, std::nano>(end - start).count();
+        for (size_t i = begin; i < pos; ++i) last_seen[events[i].key] = t;
+
+        if (t % checkpoint_every != 0) continue;
+        for (uint64_t w : windows) {
+            uint64_t oldest = t > w ? t - w : 0;
+            uint64_t true_count = 0;
+            for (const auto& [key, seen] : last_seen) {
+                if (seen > oldest) ++true_count;
+            }
+
+            HyperLogLog rebuilt(B);
+            for (size_t i = 0; i < pos; ++i) {
+                if (events[i].time > oldest) rebuilt.add(events[i].hash);
+            }
+
+            double est = sketch.estimate(w);
+            double ref = rebuilt.estimate();
+            if (est != ref) ++mismatches;
+            double err = relativeError(est, true_count);
+
+            std::cout << std::setw(8) << t << std::setw(7) << w << std::setw(8) << true_count
+                      << std::setw(9) << static_cast<uint64_t>(est)
+                      << std::fixed << std::setprecision(2) << std::setw(12) << err
+                      << std::setw(6) << sketch.getEntryCount()
+                      << std::setw(15) << sketch.getMaxListLength()
+                      << std::setw(15) << sketch.getMemoryUsage() << std::endl;
+            file << t << "," << w << "," << true_count << "," << est << "," << ref << ","
+                 << err << "," << sketch.getEntryCount() << "," << sketch.getMaxListLength() << ","
+                 << sketch.getMemoryUsage() << "\n";
+        }
+    }
+
+    std::cout << "\nСреднее время add: " << std::setprecision(2) << add_ns / events.size() << " нс" << std::endl;
+    std::cout << "Расхождений с перестроенным HyperLogLog: " << mismatches << std::endl;
+
+    // Всплеск: в одну секунду приходит в 100 раз больше различных ключей.
+    // Длина списков растёт лишь логарифмически, память остаётся ограниченной.
+    uint64_t burst_time = duration + 1;
+    for (uint64_t i = 0; i < events_per_second * 100; ++i) {
+        sketch.add(fold(splitmix64(i + (burst_time << 32))), burst_time);
+    }
+    std::cout << "После всплеска: пар " << sketch.getEntryCount()
+              << ", макс. список " << sketch.getMaxListLength()
+              << ", память " << sketch.getMemoryUsage() << " байт" << std::endl;
+    uint64_t burst_count = events_per_second * 100;
+    double burst_est = sketch.estimate(1);
+    std::cout << "Окно всплеска: точно " << burst_count << ", оценка " << static_cast<uint64_t>(burst_est) << std::endl;
+    file << burst_time << ",1," << burst_count << "," << burst_est << ",0,"
+         << relativeError(burst_est, burst_count) << "," << sketch.getEntryCount() << ","
+         << sketch.getMaxListLength() << "," << sketch.getMemoryUsage() << "\n";
+
+    // События с меткой 0: окно не короче now охватывает всю историю, и его
+    // регистры должны совпасть с HyperLogLog по всем событиям.
+    const uint64_t early_ticks = 10;
+    HyperLogLogWindow from_zero(B, horizon);
+    HyperLogLog all_events(B);
+    for (uint64_t t = 0; t < early_ticks; ++t) {
+        for (uint64_t i = 0; i < events_per_second; ++i) {
+            uint32_t hash = fold(splitmix64(i + ((t + 1) << 40)));
+            from_zero.add(hash, t);
+            all_events.add(hash);
+        }
+    }
+    bool zero_kept = from_zero.estimate() == all_events.estimate() &&
+                     from_zero.estimate(early_ticks) == all_events.estimate();
+    std::cout << "События с меткой 0 при now = " << early_ticks - 1 << ": "
+              << (zero_kept ? "учтены" : "ПОТЕРЯНЫ") << std::endl;
+    file << early_ticks - 1 << "," << early_ticks << "," << early_ticks * events_per_second << ","
+         << from_zero.estimate(early_ticks) << "," << all_events.estimate() << ","
+         << relativeError(from_zero.estimate(early_ticks), early_ticks * events_per_second) << ","
+         << from_zero.getEntryCount() << "," << from_zero.getMaxListLength() << ","
+         << from_zero.getMemoryUsage() << "\n";
+
+    std::cout << "\nРезультаты сохранены в window_results.csv" << std::endl;
+    if (!zero_kept) {
+        std::cout << "\nОкно потеряло события с меткой 0!" << std::endl;
+        return 1;
+    }
+    std::cout << "\nЭксперимент завершен успешно!" << std::endl;
+
+    return 0;
+}
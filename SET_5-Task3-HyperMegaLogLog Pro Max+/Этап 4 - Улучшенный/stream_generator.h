@@ -2,8 +2,15 @@
 #define STREAM_GENERATOR_H
 
 #include <string>
+#include <string_view>
 #include <random>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include "hash_function.h"
 
 class RandomStreamGen {
 private:
@@ -40,4 +47,190 @@ public:
     }
 };
 
+// Ключи подряд в одном буфере: i-й ключ занимает [offsets[i], offsets[i + 1]).
+// Такой вид принимает HashFuncGen::hashBatch.
+struct KeyArena {
+    std::vector<char> chars;
+    std::vector<uint32_t> offsets;
+
+    size_t size() const {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    std::string_view key(size_t i) const {
+        return std::string_view(chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+};
+
+struct StreamConfig {
+    uint64_t size = 0;
+    // Число различных ключей во всём потоке; 0 — все ключи различны.
+    uint64_t distinct = 0;
+    // Повторы выбираются среди уже встреченных ключей по закону Ципфа с
+    // показателем zipf_s (ранг 0 — самый первый ключ); 0 — равномерно.
+    double zipf_s = 0.0;
+    uint32_t min_length = 12;
+    uint32_t max_length = 30;
+    uint64_t seed = 0;
+};
+
+// Генератор потока без состояния: ключ i-го элемента — чистая функция
+// (seed, i) на основе splitmix64 как счётчикового генератора, поэтому любой
+// диапазон потока строится независимо, параллельно и без хранения потока
+// целиком (поток в 10^9 элементов идёт блоками).
+//
+// Новые ключи распределены по потоку равномерно: среди первых k элементов
+// ровно ceil(k * distinct / size) различных, так что точный ответ на любом
+// префиксе известен без подсчёта (trueCount). Остальные элементы — повторы.
+// Ключ с номером id — 11 символов base64 от биекции splitmix64(id ^ seed) и
+// случайный хвост до длины из [min_length, max_length]: префикс фиксированной
+// ширины, поэтому разные id дают разные строки. Символы берутся по 6 бит
+// сдвигами, без деления. size и distinct не больше 2^32.
+class ArenaStreamGen {
+private:
+    static constexpr char CHARSET[] =
+        "abcdefghijklmnopqrstuvwxyz"
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "0123456789-_";
+    static constexpr uint32_t ID_CHARS = 11;
+    static constexpr uint32_t CHAR_BITS = 6;
+    static constexpr uint32_t CHARS_PER_WORD = 10;
+
+    StreamConfig config;
+    uint64_t distinct;
+
+    // Независимые последовательности stream: выбор повтора, длина, хвост ключа.
+    uint64_t random(uint64_t counter, uint64_t stream) const {
+        return splitmix64(splitmix64(counter ^ config.seed) + stream * 0xd1b54a32d192ed03ULL);
+    }
+
+    double uniform(uint64_t counter, uint64_t stream) const {
+        return (random(counter, stream) >> 11) * 0x1.0p-53;
+    }
+
+    // (seen + 1)^(1 - s) - 1 меняется только с появлением нового ключа,
+    // поэтому при последовательном проходе считается раз на новый ключ.
+    struct ZipfCache {
+        uint64_t seen = 0;
+        double head = 0.0;
+    };
+
+    // Ранг в [0, seen): равномерный или приближённый Ципф (обратная функция
+    // распределения непрерывного степенного закона на [1, seen + 1)).
+    uint64_t repeatRank(uint64_t i, uint64_t seen, ZipfCache& cache) const {
+        double u = uniform(i, 1);
+        double rank;
+        if (config.zipf_s <= 0.0) {
+            rank = u * seen;
+        } else if (std::abs(config.zipf_s - 1.0) < 1e-9) {
+            rank = std::exp(u * std::log(seen + 1.0)) - 1.0;
+        } else {
+            double e = 1.0 - config.zipf_s;
+            if (cache.seen != seen) {
+                cache.seen = seen;
+                cache.head = std::pow(seen + 1.0, e) - 1.0;
+            }
+            rank = std::pow(cache.head * u + 1.0, 1.0 / e) - 1.0;
+        }
+        return std::min(static_cast<uint64_t>(rank), seen - 1);
+    }
+
+    uint32_t keyLength(uint64_t id) const {
+        uint32_t span = config.max_length - config.min_length + 1;
+        return config.min_length + static_cast<uint32_t>(random(id, 2) % span);
+    }
+
+    void writeKey(uint64_t id, char* out, uint32_t length) const {
+        uint64_t scrambled = splitmix64(id ^ config.seed);
+        for (uint32_t d = 0; d < ID_CHARS; ++d) {
+            out[d] = CHARSET[(scrambled >> (d * CHAR_BITS)) & 63];
+        }
+        uint64_t bits = 0;
+        for (uint32_t k = 0; ID_CHARS + k < length; ++k) {
+            if (k % CHARS_PER_WORD == 0) bits = random(id, 3 + k / CHARS_PER_WORD);
+            out[ID_CHARS + k] = CHARSET[bits & 63];
+            bits >>= CHAR_BITS;
+        }
+    }
+
+    // id элементов [lo, hi) подряд: число различных ведётся как в алгоритме
+    // Брезенхэма (остаток i * distinct по модулю size), без деления на элемент.
+    void fillIds(uint64_t lo, uint64_t hi, uint64_t* ids) const {
+        uint64_t product = lo * distinct;
+        uint64_t quotient = product / config.size;
+        uint64_t remainder = product % config.size;
+        ZipfCache cache;
+        for (uint64_t i = lo; i < hi; ++i) {
+            uint64_t seen = quotient + (remainder != 0);
+            remainder += distinct;
+            if (remainder >= config.size) {
+                remainder -= config.size;
+                ++quotient;
+            }
+            uint64_t next = quotient + (remainder != 0);
+            ids[i - lo] = next > seen ? seen : repeatRank(i, seen, cache);
+        }
+    }
+
+    template <class F>
+    static void parallelFor(uint64_t begin, uint64_t count, unsigned threads, F&& f) {
+        threads = static_cast<unsigned>(std::clamp<uint64_t>(threads, 1, std::max<uint64_t>(1, count / 4096)));
+        std::vector<std::thread> workers;
+        uint64_t per = (count + threads - 1) / threads;
+        for (unsigned t = 1; t < threads; ++t) {
+            uint64_t lo = std::min(count, t * per), hi = std::min(count, lo + per);
+            workers.emplace_back([&f, begin, lo, hi] { f(begin + lo, begin + hi); });
+        }
+        f(begin, begin + std::min(count, per));
+        for (auto& w : workers) w.join();
+    }
+
+public:
+    explicit ArenaStreamGen(const StreamConfig& cfg)
+        : config(cfg), distinct(cfg.distinct == 0 ? cfg.size : std::min(cfg.distinct, cfg.size)) {
+        config.min_length = std::max(config.min_length, ID_CHARS);
+        config.max_length = std::max(config.max_length, config.min_length);
+    }
+
+    // Число различных ключей среди первых prefix элементов.
+    uint64_t trueCount(uint64_t prefix) const {
+        if (config.size == 0) return 0;
+        return (prefix * distinct + config.size - 1) / config.size;
+    }
+
+    uint64_t keyId(uint64_t i) const {
+        uint64_t id;
+        fillIds(i, i + 1, &id);
+        return id;
+    }
+
+    // Элементы [begin, begin + count) в arena (смещения 32-битные, так что
+    // длинный поток генерируется блоками); threads > 1 — параллельно:
+    // длины ключей зависят только от id, поэтому смещения считаются первым
+    // проходом, а символы пишутся вторым прямо на свои места.
+    void generate(uint64_t begin, uint64_t count, KeyArena& out, unsigned threads = 1) const {
+        std::vector<uint64_t> ids(count);
+        out.offsets.resize(count + 1);
+        out.offsets[0] = 0;
+        parallelFor(begin, count, threads, [&](uint64_t lo, uint64_t hi) {
+            fillIds(lo, hi, ids.data() + (lo - begin));
+            for (uint64_t i = lo; i < hi; ++i) {
+                out.offsets[i - begin + 1] = keyLength(ids[i - begin]);
+            }
+        });
+        for (uint64_t k = 0; k < count; ++k) out.offsets[k + 1] += out.offsets[k];
+
+        out.chars.resize(out.offsets[count]);
+        parallelFor(begin, count, threads, [&](uint64_t lo, uint64_t hi) {
+            for (uint64_t k = lo - begin; k < hi - begin; ++k) {
+                writeKey(ids[k], out.chars.data() + out.offsets[k], out.offsets[k + 1] - out.offsets[k]);
+            }
+        });
+    }
+
+    const StreamConfig& getConfig() const {
+        return config;
+    }
+};
+
 #endif
@@ -0,0 +1,363 @@
+#ifndef STREAM_SKETCHES_H
+#define STREAM_SKETCHES_H
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "hash_function.h"
+#include "hll_batch.h"
+#include "hyperloglog.h"
+
+// Частоты и самые частые ключи потока рядом с HyperLogLog. Все структуры
+// принимают один 64-битный хеш ключа (HashFuncGen::hash64): HyperLogLog
+// получает из него те же 32 бита, что дал бы HashFuncGen::hash, Count-Min —
+// столбцы строк, SpaceSaving — идентификатор ключа.
+
+// Count-Min (Cormode, Muthukrishnan): depth строк по 2^width_bits счётчиков.
+// Оценка частоты — минимум по строкам, никогда не меньше истинной и с
+// вероятностью 1 - e^-depth превышает её не больше чем на e / 2^width_bits
+// от длины потока. Столбцы строк — h1 + row * h2 по двум половинам хеша
+// (Kirsch, Mitzenmacher), так что новых хешей на строку не нужно.
+class CountMinSketch {
+private:
+    uint32_t width_bits;
+    uint32_t depth;
+    uint32_t mask;
+    std::vector<uint32_t> counters;
+    uint64_t total = 0;
+
+    uint32_t column(uint64_t hash, uint32_t row) const {
+        uint32_t h1 = static_cast<uint32_t>(hash);
+        uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+        return (h1 + row * h2) & mask;
+    }
+
+public:
+    CountMinSketch(uint32_t width_bits_, uint32_t depth_ = 4)
+        : width_bits(width_bits_), depth(depth_), mask((1u << width_bits_) - 1),
+          counters(static_cast<size_t>(depth_) << width_bits_, 0) {}
+
+    void prefetch(uint64_t hash) const {
+        for (uint32_t row = 0; row < depth; ++row) {
+            hllPrefetch(counters.data() + (static_cast<size_t>(row) << width_bits) + column(hash, row));
+        }
+    }
+
+    void add(uint64_t hash, uint32_t count = 1) {
+        uint32_t* row_counters = counters.data();
+        for (uint32_t row = 0; row < depth; ++row, row_counters += mask + 1) {
+            row_counters[column(hash, row)] += count;
+        }
+        total += count;
+    }
+
+    uint32_t estimate(uint64_t hash) const {
+        uint32_t result = std::numeric_limits<uint32_t>::max();
+        const uint32_t* row_counters = counters.data();
+        for (uint32_t row = 0; row < depth; ++row, row_counters += mask + 1) {
+            result = std::min(result, row_counters[column(hash, row)]);
+        }
+        return result;
+    }
+
+    // Счётчики складываются; false, если размеры различаются.
+    bool merge(const CountMinSketch& other) {
+        if (other.width_bits != width_bits || other.depth != depth) return false;
+        for (size_t i = 0; i < counters.size(); ++i) counters[i] += other.counters[i];
+        total += other.total;
+        return true;
+    }
+
+    bool operator==(const CountMinSketch& other) const {
+        return width_bits == other.width_bits && depth == other.depth && counters == other.counters;
+    }
+
+    void reset() {
+        std::fill(counters.begin(), counters.end(), 0);
+        total = 0;
+    }
+
+    uint64_t getTotal() const {
+        return total;
+    }
+
+    size_t getMemoryUsage() const {
+        return counters.size() * sizeof(uint32_t);
+    }
+};
+
+struct TopKEntry {
+    uint64_t hash;
+    uint64_t count;
+    // Сколько из count могло достаться ключу от вытесненного предшественника:
+    // истинная частота лежит в [count - error, count].
+    uint64_t error;
+    std::string key;
+};
+
+// SpaceSaving (Metwally, Agrawal, El Abbadi): capacity счётчиков; ключ не из
+// набора занимает место счётчика с наименьшим значением и наследует его.
+// Любой ключ с частотой больше n / capacity гарантированно в наборе.
+// Значения счётчиков лежат в двоичной куче по возрастанию (16 байт на узел,
+// ключи при просеивании не двигаются), ключ ищется по хешу в открытой таблице
+// с линейным пробированием, удаление без надгробий — сдвигом назад. Строка
+// ключа копируется только при вытеснении, в буфер вытесненного ключа.
+class SpaceSavingTopK {
+private:
+    static constexpr uint32_t EMPTY = std::numeric_limits<uint32_t>::max();
+
+    struct Counter {
+        uint64_t hash;
+        uint64_t error;
+        uint32_t heap_pos;
+        std::string key;
+    };
+
+    struct HeapItem {
+        uint64_t count;
+        uint32_t counter;
+    };
+
+    size_t capacity;
+    std::vector<Counter> counters;
+    std::vector<HeapItem> heap;
+    // Номер счётчика или EMPTY.
+    std::vector<uint32_t> table;
+    size_t table_mask;
+
+    size_t home(uint64_t hash) const {
+        return static_cast<size_t>(hash >> 32) & table_mask;
+    }
+
+    size_t findSlot(uint64_t hash) const {
+        size_t slot = home(hash);
+        while (table[slot] != EMPTY && counters[table[slot]].hash != hash) slot = (slot + 1) & table_mask;
+        return slot;
+    }
+
+    void eraseSlot(size_t hole) {
+        for (size_t i = (hole + 1) & table_mask; table[i] != EMPTY; i = (i + 1) & table_mask) {
+            size_t h = home(counters[table[i]].hash);
+            if (((i - h) & table_mask) >= ((i - hole) & table_mask)) {
+                table[hole] = table[i];
+                hole = i;
+            }
+        }
+        table[hole] = EMPTY;
+    }
+
+    void place(size_t pos, HeapItem item) {
+        heap[pos] = item;
+        counters[item.counter].heap_pos = static_cast<uint32_t>(pos);
+    }
+
+    void siftUp(size_t pos) {
+        HeapItem item = heap[pos];
+        while (pos > 0 && heap[(pos - 1) / 2].count > item.count) {
+            place(pos, heap[(pos - 1) / 2]);
+            pos = (pos - 1) / 2;
+        }
+        place(pos, item);
+    }
+
+    void siftDown(size_t pos) {
+        HeapItem item = heap[pos];
+        while (true) {
+            size_t child = 2 * pos + 1;
+            if (child >= heap.size()) break;
+            if (child + 1 < heap.size() && heap[child + 1].count < heap[child].count) ++child;
+            if (heap[child].count >= item.count) break;
+            place(pos, heap[child]);
+            pos = child;
+        }
+        place(pos, item);
+    }
+
+public:
+    explicit SpaceSavingTopK(size_t capacity_)
+        : capacity(std::max<size_t>(1, capacity_)),
+          table(std::bit_ceil(capacity * 2), EMPTY), table_mask(table.size() - 1) {
+        counters.reserve(capacity);
+        heap.reserve(capacity);
+    }
+
+    void add(uint64_t hash, std::string_view key, uint64_t count = 1) {
+        size_t slot = findSlot(hash);
+        if (table[slot] != EMPTY) {
+            size_t pos = counters[table[slot]].heap_pos;
+            heap[pos].count += count;
+            siftDown(pos);
+            return;
+        }
+        if (counters.size() < capacity) {
+            uint32_t id = static_cast<uint32_t>(counters.size());
+            counters.push_back({hash, 0, 0, std::string(key)});
+            table[slot] = id;
+            heap.push_back({count, id});
+            siftUp(heap.size() - 1);
+            return;
+        }
+        // Вытесняется минимум — корень кучи.
+        uint32_t id = heap[0].counter;
+        Counter& victim = counters[id];
+        eraseSlot(findSlot(victim.hash));
+        table[findSlot(hash)] = id;
+        victim.hash = hash;
+        victim.error = heap[0].count;
+        victim.key.assign(key);
+        heap[0].count += count;
+        siftDown(0);
+    }
+
+    // Счётчики по убыванию count.
+    std::vector<TopKEntry> top() const {
+        std::vector<TopKEntry> result;
+        result.reserve(heap.size());
+        for (const HeapItem& item : heap) {
+            const Counter& c = counters[item.counter];
+            result.push_back({c.hash, item.count, c.error, c.key});
+        }
+        std::sort(result.begin(), result.end(), [](const TopKEntry& a, const TopKEntry& b) {
+            return a.count != b.count ? a.count > b.count : a.hash < b.hash;
+        });
+        return result;
+    }
+
+    // Наименьший счётчик: частоту выше него не может иметь ни один ключ вне набора.
+    uint64_t minCount() const {
+        return counters.size() < capacity ? 0 : heap[0].count;
+    }
+
+    void reset() {
+        counters.clear();
+        heap.clear();
+        std::fill(table.begin(), table.end(), EMPTY);
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    size_t getMemoryUsage() const {
+        size_t bytes = capacity * (sizeof(Counter) + sizeof(HeapItem)) + table.size() * sizeof(uint32_t);
+        for (const Counter& c : counters) bytes += c.key.capacity();
+        return bytes;
+    }
+};
+
+struct StreamSketchesConfig {
+    uint32_t hll_b = 14;
+    uint32_t cms_width_bits = 16;
+    uint32_t cms_depth = 4;
+    // Ключей в ответе и счётчиков SpaceSaving: с запасом счётчиков ключи из
+    // ответа реже вытесняются хвостом потока.
+    size_t top_k = 100;
+    size_t top_k_capacity = 1000;
+};
+
+// Число различных ключей, частоты и самые частые ключи за один проход: ключ
+// читается и хешируется один раз, и пока он в кэше, обновляются все три
+// структуры. Арена обходится блоками по BLOCK ключей. Ключ хешируется прямо в
+// проходе за PREFETCH_DISTANCE позиций до обновления, так что счётчики
+// Count-Min (если он больше L2) успевают подгрузиться; затем ключ идёт в
+// Count-Min и SpaceSaving, а хеши блока копятся для HyperLogLog::addBatch.
+class StreamSketches {
+private:
+    static constexpr size_t BLOCK = 256;
+    static constexpr size_t PREFETCH_DISTANCE = 8;
+
+    HashFuncGen hash_func;
+    HyperLogLog hll;
+    CountMinSketch cms;
+    SpaceSavingTopK top_k;
+    size_t top_k_size;
+    bool prefetch_cms;
+
+    static uint32_t hllHash(uint64_t hash) {
+        return static_cast<uint32_t>(hash ^ (hash >> 32));
+    }
+
+public:
+    StreamSketches(const HashFuncGen& hash_func_, const StreamSketchesConfig& config = {})
+        : hash_func(hash_func_), hll(config.hll_b), cms(config.cms_width_bits, config.cms_depth),
+          top_k(std::max(config.top_k, config.top_k_capacity)), top_k_size(config.top_k),
+          prefetch_cms(cms.getMemoryUsage() >= HLL_PREFETCH_MIN_BYTES) {}
+
+    void add(std::string_view key) {
+        uint64_t hash = hash_func.hash64(key.data(), key.size());
+        hll.add(hllHash(hash));
+        cms.add(hash);
+        top_k.add(hash, key);
+    }
+
+    // Ключи арены в формате HashFuncGen::hashBatch: i-й ключ занимает
+    // [offsets[i], offsets[i + 1]).
+    void addBatch(std::span<const char> arena, std::span<const uint32_t> offsets) {
+        uint64_t hashes[BLOCK];
+        uint32_t hll_hashes[BLOCK];
+        const size_t count = offsets.empty() ? 0 : offsets.size() - 1;
+        auto key = [&](size_t i) {
+            return std::string_view(arena.data() + offsets[i], offsets[i + 1] - offsets[i]);
+        };
+        auto hashAhead = [&](size_t i, size_t slot) {
+            std::string_view k = key(i);
+            hashes[slot] = hash_func.hash64(k.data(), k.size());
+            if (prefetch_cms) cms.prefetch(hashes[slot]);
+        };
+        for (size_t begin = 0; begin < count; begin += BLOCK) {
+            const size_t n = std::min(BLOCK, count - begin);
+            for (size_t i = 0; i < std::min(n, PREFETCH_DISTANCE); ++i) hashAhead(begin + i, i);
+            for (size_t i = 0; i < n; ++i) {
+                if (i + PREFETCH_DISTANCE < n) hashAhead(begin + i + PREFETCH_DISTANCE, i + PREFETCH_DISTANCE);
+                hll_hashes[i] = hllHash(hashes[i]);
+                cms.add(hashes[i]);
+                top_k.add(hashes[i], key(begin + i));
+            }
+            hll.addBatch(std::span<const uint32_t>(hll_hashes, n));
+        }
+    }
+
+    double estimateDistinct() const {
+        return hll.estimate();
+    }
+
+    uint32_t estimateFrequency(std::string_view key) const {
+        return cms.estimate(hash_func.hash64(key.data(), key.size()));
+    }
+
+    // top_k самых частых по SpaceSaving.
+    std::vector<TopKEntry> top() const {
+        std::vector<TopKEntry> result = top_k.top();
+        if (result.size() > top_k_size) result.resize(top_k_size);
+        return result;
+    }
+
+    const HyperLogLog& getHyperLogLog() const {
+        return hll;
+    }
+
+    const CountMinSketch& getCountMin() const {
+        return cms;
+    }
+
+    const SpaceSavingTopK& getTopK() const {
+        return top_k;
+    }
+
+    void reset() {
+        hll.reset();
+        cms.reset();
+        top_k.reset();
+    }
+
+    size_t getMemoryUsage() const {
+        return hll.getMemoryUsage() + cms.getMemoryUsage() + top_k.getMemoryUsage();
+    }
+};
+
+#endif
@@ -1,10 +1,10 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
-#include <unordered_set>
 #include <cmath>
 #include "hyperloglog.h"
 #include "stream_generator.h"
+#include "exact_counter.h"
 #include "hash_function.h"
 
 struct ExperimentResult {
@@ -20,7 +20,8 @@ std::vector<ExperimentResult> runExperiment(
     double step_percentage) {
     
     std::vector<ExperimentResult> results;
-    std::unordered_set<std::string> unique_set;
+    ExactDistinctCounter unique_set;
+    unique_set.reserve(stream.size());
     
     size_t step_size = static_cast<size_t>(stream.size() * step_percentage);
     if (step_size == 0) step_size = 1;